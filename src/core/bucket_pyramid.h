@@ -0,0 +1,181 @@
+// Tracked seconds per minute, hour, day and week, in local seconds (see
+// civil.h). A view at any zoom reads the one level whose buckets are
+// just narrower than a pixel, so drawing costs O(pixels) whatever the
+// history length. Minutes are kept sparsely, one 1440-cell chunk per day
+// with any tracked time (about 3 KB each); hour, day and week rows are
+// dense between the first and last active bucket. Sessions can be taken
+// out again, so an edit or import updates the pyramid without a rescan.
+// Plain C++17, no wxWidgets.
+#pragma once
+
+#include "civil.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <vector>
+
+class BucketPyramid {
+public:
+    enum Level { kMinute, kHour, kDay, kWeek, kLevels };
+
+    static int64_t Width(int lvl) {
+        static const int64_t w[kLevels] = { 60, 3600, 86400, 7 * 86400 };
+        return w[lvl];
+    }
+
+    // Weeks start on Monday; day 0 (1970-01-01) was a Thursday.
+    static int64_t Offset(int lvl) { return lvl == kWeek ? 3 * 86400 : 0; }
+    static int64_t Bucket(int lvl, int64_t t) { return FloorDiv(t + Offset(lvl), Width(lvl)); }
+    static int64_t BucketStart(int lvl, int64_t b) { return b * Width(lvl) - Offset(lvl); }
+
+    // Coarsest level whose buckets are no wider than span seconds.
+    static int LevelFor(double span) {
+        int lvl = kMinute;
+        while (lvl + 1 < kLevels && Width(lvl + 1) <= span) lvl++;
+        return lvl;
+    }
+
+    void Clear() {
+        m_days.clear();
+        for (auto& r : m_rows) r = Row<uint32_t>();
+    }
+
+    bool Empty() const { return m_days.empty(); }
+
+    // First and last tracked minute, as [First(), Last()).
+    int64_t First() const {
+        if (m_days.empty()) return 0;
+        auto& d = *m_days.begin();
+        int m = 0;
+        while (m < kDayMinutes - 1 && !d.second[m]) m++;
+        return d.first * 86400 + m * 60;
+    }
+    int64_t Last() const {
+        if (m_days.empty()) return 0;
+        auto& d = *m_days.rbegin();
+        int m = kDayMinutes - 1;
+        while (m > 0 && !d.second[m]) m--;
+        return d.first * 86400 + (m + 1) * 60;
+    }
+
+    // localStart in local seconds. Sessions outside 2000-2100 are dropped
+    // so one bad date can't stretch the dense rows over centuries.
+    void Add(int64_t localStart, uint32_t dur) { Apply(localStart, dur, 1); }
+
+    // Takes out a session added earlier with the same arguments.
+    void Remove(int64_t localStart, uint32_t dur) { Apply(localStart, dur, -1); }
+
+    // Tracked seconds per column of a view width columns wide showing
+    // [from, from + span): each bucket of LevelFor(span / width) spread
+    // over the columns it covers. Buckets are never wider than a column
+    // except at minute level when zoomed right in. cols keeps its capacity.
+    void Columns(double from, double span, int width, std::vector<double>& cols) const {
+        cols.assign((size_t)std::max(width, 0), 0.0);
+        if (width <= 0 || span <= 0) return;
+        double spp = span / width;
+        int lvl = LevelFor(spp);
+        double bw = (double)Width(lvl) / spp;
+        ForEach(lvl, (int64_t)std::floor(from), (int64_t)std::ceil(from + span),
+            [&](int64_t start, uint32_t secs) {
+                double x0 = (start - from) / spp, x1 = x0 + bw;
+                int c0 = std::max(0, (int)std::floor(x0)), c1 = std::min(width, (int)std::ceil(x1));
+                for (int c = c0; c < c1; c++)
+                    cols[c] += secs * (std::min<double>(c + 1, x1) - std::max<double>(c, x0)) / bw;
+            });
+    }
+
+    // fn(bucketStart, secs) for the non-empty buckets of lvl that overlap
+    // [from, to).
+    template <class Fn>
+    void ForEach(int lvl, int64_t from, int64_t to, Fn fn) const {
+        if (lvl != kMinute) { m_rows[lvl - 1].ForEach(lvl, from, to, fn); return; }
+        if (to <= from) return;
+        int64_t b0 = Bucket(kMinute, from), b1 = Bucket(kMinute, to - 1);
+        for (auto it = m_days.lower_bound(FloorDiv(b0, kDayMinutes));
+            it != m_days.end() && it->first * kDayMinutes <= b1; ++it) {
+            int64_t base = it->first * kDayMinutes;
+            int m0 = (int)std::max<int64_t>(b0 - base, 0);
+            int m1 = (int)std::min<int64_t>(b1 - base, kDayMinutes - 1);
+            for (int m = m0; m <= m1; m++)
+                if (it->second[m]) fn(BucketStart(kMinute, base + m), (uint32_t)it->second[m]);
+        }
+    }
+
+private:
+    static const int kDayMinutes = 24 * 60;
+    typedef std::array<uint16_t, kDayMinutes> Day;
+
+    template <class T>
+    struct Row {
+        int64_t        base = 0;    // bucket of v[0]
+        std::vector<T> v;
+
+        void Add(int lvl, int64_t from, int64_t to, int sign) {
+            int64_t b0 = Bucket(lvl, from), b1 = Bucket(lvl, to - 1);
+            Cover(b0, b1);
+            for (int64_t b = b0; b <= b1; b++) {
+                int64_t s = BucketStart(lvl, b);
+                int64_t secs = std::min(to, s + Width(lvl)) - std::max(from, s);
+                T& cell = v[(size_t)(b - base)];
+                cell = Clamp<T>((int64_t)cell + sign * secs);
+            }
+        }
+
+        // Sessions mostly arrive in time order, so this is an append;
+        // older imports shift the row once.
+        void Cover(int64_t b0, int64_t b1) {
+            if (v.empty()) base = b0;
+            if (b0 < base) {
+                v.insert(v.begin(), (size_t)(base - b0), 0);
+                base = b0;
+            }
+            if (b1 - base >= (int64_t)v.size()) v.resize((size_t)(b1 - base + 1), 0);
+        }
+
+        template <class Fn>
+        void ForEach(int lvl, int64_t from, int64_t to, Fn& fn) const {
+            if (v.empty() || to <= from) return;
+            int64_t b0 = std::max(Bucket(lvl, from), base);
+            int64_t b1 = std::min(Bucket(lvl, to - 1), base + (int64_t)v.size() - 1);
+            for (int64_t b = b0; b <= b1; b++)
+                if (v[(size_t)(b - base)]) fn(BucketStart(lvl, b), (uint32_t)v[(size_t)(b - base)]);
+        }
+    };
+
+    std::map<int64_t, Day> m_days;      // local day -> minutes, at most 60 per machine
+    Row<uint32_t> m_rows[kLevels - 1];  // hour, day, week
+
+    template <class T>
+    static T Clamp(int64_t v) {
+        return (T)std::min<int64_t>(std::max<int64_t>(v, 0), std::numeric_limits<T>::max());
+    }
+
+    void Apply(int64_t localStart, uint32_t dur, int sign) {
+        static const int64_t lo = DaysFromCivil(2000, 1, 1) * 86400;
+        static const int64_t hi = DaysFromCivil(2100, 1, 1) * 86400;
+        if (!dur || localStart < lo || localStart >= hi) return;
+        int64_t end = localStart + dur;
+        for (int64_t day = FloorDiv(localStart, 86400); day * 86400 < end; day++) {
+            auto it = m_days.find(day);
+            if (it == m_days.end()) {
+                if (sign < 0) continue;
+                it = m_days.emplace(day, Day()).first;
+                it->second.fill(0);
+            }
+            Day& cells = it->second;
+            int64_t from = std::max(localStart, day * 86400), to = std::min(end, (day + 1) * 86400);
+            for (int64_t m = (from - day * 86400) / 60; m * 60 < to - day * 86400; m++) {
+                int64_t s = day * 86400 + m * 60;
+                int64_t secs = std::min(to, s + 60) - std::max(from, s);
+                cells[m] = Clamp<uint16_t>((int64_t)cells[m] + sign * secs);
+            }
+            if (sign < 0 && std::all_of(cells.begin(), cells.end(), [](uint16_t c) { return c == 0; }))
+                m_days.erase(it);
+        }
+        for (int lvl = kHour; lvl < kLevels; lvl++) m_rows[lvl - 1].Add(lvl, localStart, end, sign);
+    }
+};
@@ -0,0 +1,77 @@
+// Binary IO shared by the on-disk formats. Plain C++17, no wxWidgets, so
+// the core tests build it on their own.
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// Little-endian helpers for the on-disk formats (catalog, history).
+class ByteWriter {
+public:
+    std::string buf;
+
+    void U8(uint8_t v) { buf.push_back((char)v); }
+    void U32(uint32_t v) { buf.append((const char*)&v, 4); }
+    void U64(uint64_t v) { buf.append((const char*)&v, 8); }
+    // LEB128: 7 bits per byte, high bit set on all but the last.
+    void Var(uint64_t v) {
+        while (v >= 0x80) { buf.push_back((char)(v | 0x80)); v >>= 7; }
+        buf.push_back((char)v);
+    }
+    void WStr(const std::wstring& s) {
+        U32((uint32_t)s.size());
+        for (wchar_t c : s) { uint16_t u = (uint16_t)c; buf.append((const char*)&u, 2); }
+    }
+};
+
+class ByteReader {
+public:
+    ByteReader(const char* p, size_t n) : m_p(p), m_end(p + n) {}
+
+    bool Ok() const { return m_ok; }
+    bool AtEnd() const { return m_p >= m_end; }
+    const char* Pos() const { return m_p; }
+    size_t Left() const { return (size_t)(m_end - m_p); }
+
+    uint8_t U8() { uint8_t v = 0; Take(&v, 1); return v; }
+    uint32_t U32() { uint32_t v = 0; Take(&v, 4); return v; }
+    uint64_t U64() { uint64_t v = 0; Take(&v, 8); return v; }
+    uint64_t Var() {
+        uint64_t v = 0;
+        for (int shift = 0; shift < 64 && m_p < m_end; shift += 7) {
+            uint8_t b = (uint8_t)*m_p++;
+            v |= (uint64_t)(b & 0x7f) << shift;
+            if (!(b & 0x80)) return v;
+        }
+        m_ok = false;
+        return 0;
+    }
+    void Skip(size_t n) {
+        if (!m_ok || Left() < n) { m_ok = false; return; }
+        m_p += n;
+    }
+    std::wstring WStr() {
+        uint32_t n = U32();
+        std::wstring s;
+        if (!m_ok || (size_t)(m_end - m_p) < (size_t)n * 2) { m_ok = false; return s; }
+        s.resize(n);
+        for (uint32_t i = 0; i < n; i++) {
+            uint16_t u; memcpy(&u, m_p + i * 2, 2);
+            s[i] = (wchar_t)u;
+        }
+        m_p += (size_t)n * 2;
+        return s;
+    }
+
+private:
+    const char* m_p;
+    const char* m_end;
+    bool        m_ok = true;
+
+    void Take(void* dst, size_t n) {
+        if (!m_ok || (size_t)(m_end - m_p) < n) { m_ok = false; return; }
+        memcpy(dst, m_p, n);
+        m_p += n;
+    }
+};
@@ -0,0 +1,26 @@
+// Elapsed-time text for the timer display, tray tip and reports, written
+// into a caller's buffer so the per-second repaint never allocates. Plain
+// C++17, no wxWidgets.
+#pragma once
+
+// Writes "HH:MM:SS" (hours widen past 99) and a NUL; returns the length.
+// out must hold 16 chars.
+constexpr int FormatClock(int secs, char* out) {
+    int h = secs / 3600, m = (secs % 3600) / 60, sec = secs % 60;
+    char hd[12] = {};
+    int hn = 0, n = 0;
+    do { hd[hn++] = char('0' + h % 10); h /= 10; } while (h);
+    if (hn < 2) hd[hn++] = '0';
+    while (hn) out[n++] = hd[--hn];
+    out[n++] = ':'; out[n++] = char('0' + m / 10); out[n++] = char('0' + m % 10);
+    out[n++] = ':'; out[n++] = char('0' + sec / 10); out[n++] = char('0' + sec % 10);
+    out[n] = 0;
+    return n;
+}
+
+constexpr bool FormatClockSelfCheck() {
+    char b[16] = {};
+    return FormatClock(3723, b) == 8 && b[0] == '0' && b[1] == '1' &&
+        b[4] == '2' && b[7] == '3' && FormatClock(360000, b) == 9 && b[0] == '1';
+}
+static_assert(FormatClockSelfCheck(), "FormatClock");
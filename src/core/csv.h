@@ -0,0 +1,86 @@
+// Zero-copy CSV records for the history import: RFC 4180 quoting, records
+// read through one fixed buffer. Plain C++17, no wxWidgets.
+#pragma once
+
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Length up to the first newline outside quotes, or n.
+inline size_t CsvRecordLen(const char* p, size_t n) {
+    bool quoted = false;
+    for (size_t i = 0; i < n; i++) {
+        if (p[i] == '"') quoted = !quoted;
+        else if (p[i] == '\n' && !quoted) return i;
+    }
+    return n;
+}
+
+// Splits one record in place into at most max fields; returns how many.
+// Fields point into the line; a quoted field with doubled quotes is
+// unescaped into scratch[i], which keeps its capacity from row to row.
+inline int CsvSplit(std::string_view line, std::string_view* fields, std::string* scratch, int max) {
+    int n = 0;
+    size_t i = 0;
+    while (n < max) {
+        if (i < line.size() && line[i] == '"') {
+            size_t start = ++i;
+            bool escaped = false;
+            while (i < line.size()) {
+                if (line[i] != '"') { i++; continue; }
+                if (i + 1 < line.size() && line[i + 1] == '"') { escaped = true; i += 2; continue; }
+                break;
+            }
+            std::string_view v = line.substr(start, i - start);
+            if (escaped) {
+                scratch[n].clear();
+                for (size_t k = 0; k < v.size(); k++) {
+                    scratch[n].push_back(v[k]);
+                    if (v[k] == '"') k++;
+                }
+                v = scratch[n];
+            }
+            fields[n++] = v;
+            i = line.find(',', i);
+        } else {
+            size_t c = line.find(',', i);
+            fields[n++] = line.substr(i, c == std::string_view::npos ? c : c - i);
+            i = c;
+        }
+        if (i == std::string_view::npos) break;
+        i++;
+    }
+    return n;
+}
+
+// Calls fn(line) for each record of a stream read through buf, with its
+// newline and a trailing CR removed; a record may span reads. read(dst, n)
+// returns the bytes read, 0 or less at the end. False if a record doesn't
+// fit in buf; the records before it have been passed on.
+template <class Read, class Fn>
+bool CsvReadRecords(std::vector<char>& buf, Read read, Fn fn) {
+    size_t have = 0;
+    bool eof = false;
+    for (;;) {
+        if (!eof) {
+            long long n = (long long)read(buf.data() + have, buf.size() - have);
+            if (n <= 0) eof = true;
+            else have += (size_t)n;
+        }
+        size_t pos = 0;
+        while (pos < have) {
+            size_t len = CsvRecordLen(buf.data() + pos, have - pos);
+            bool complete = len < have - pos;
+            if (!complete && !eof) break;
+            std::string_view line(buf.data() + pos, len);
+            pos += complete ? len + 1 : len;
+            if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+            fn(line);
+        }
+        if (eof) return true;
+        std::memmove(buf.data(), buf.data() + pos, have - pos);
+        have -= pos;
+        if (have == buf.size()) return false;
+    }
+}
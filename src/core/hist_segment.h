@@ -0,0 +1,205 @@
+// History segment codec: one month of sessions, compressed and indexed
+// by block. Plain C++17, no wxWidgets.
+//
+// Segment layout (little-endian):
+//   "WTHS" u32 version
+//   u32 nApps, WStr apps[]
+//   u32 nSources, WStr sources[]                      (version 2+)
+//   u32 nCategories, WStr categories[]                (version 3+)
+//   u32 nRecords, u32 nBlocks
+//   nBlocks x { u64 minStart, u64 maxEnd, u32 count, u32 offset, u32 len }
+//   u32 payloadLen, payload
+// Records are sorted by start. Per record a block stores varint start
+// delta (the first is absolute), varint duration, varint app id, then
+// varint source id (version 2+) and varint category id (version 3+).
+#pragma once
+
+#include "bytes.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+struct HistRecord {
+    int64_t      start = 0;     // local epoch seconds
+    uint32_t     dur = 0;
+    std::wstring app;
+    std::wstring source;
+    std::wstring category;
+
+    int64_t End() const { return start + dur; }
+    bool operator<(const HistRecord& o) const {
+        if (start != o.start) return start < o.start;
+        if (dur != o.dur) return dur < o.dur;
+        if (app != o.app) return app < o.app;
+        if (source != o.source) return source < o.source;
+        return category < o.category;
+    }
+    bool operator==(const HistRecord& o) const {
+        return start == o.start && dur == o.dur && app == o.app &&
+            source == o.source && category == o.category;
+    }
+};
+
+struct HistBlock {
+    int64_t  minStart = 0;
+    int64_t  maxEnd = 0;
+    uint32_t count = 0;
+    uint32_t offset = 0;
+    uint32_t len = 0;
+};
+
+struct HistSegment {
+    static constexpr uint32_t kMagic = 0x53485457;  // "WTHS"
+    static constexpr uint32_t kVersion = 3;
+    static constexpr size_t   kBlock = 128;
+
+    std::vector<std::wstring> apps;
+    std::vector<std::wstring> sources;
+    std::vector<std::wstring> categories;
+    std::vector<HistBlock>    blocks;
+    uint32_t    version = 0;
+    uint32_t    records = 0;
+    const char* payload = nullptr;  // points into the buffer given to Parse
+    size_t      payloadLen = 0;
+
+    bool Parse(const std::string& raw) {
+        ByteReader r(raw.data(), raw.size());
+        if (r.U32() != kMagic) return false;
+        version = r.U32();
+        if (version < 1 || version > kVersion) return false;
+        uint32_t n = r.U32();
+        if (!r.Ok() || n > r.Left()) return false;
+        apps.resize(n);
+        for (auto& a : apps) a = r.WStr();
+        sources.assign(1, std::wstring());
+        if (version >= 2) {
+            n = r.U32();
+            if (!r.Ok() || n > r.Left()) return false;
+            sources.resize(n);
+            for (auto& a : sources) a = r.WStr();
+        }
+        categories.assign(1, std::wstring());
+        if (version >= 3) {
+            n = r.U32();
+            if (!r.Ok() || n > r.Left()) return false;
+            categories.resize(n);
+            for (auto& a : categories) a = r.WStr();
+        }
+        records = r.U32();
+        n = r.U32();
+        if (!r.Ok() || n > r.Left() / 32) return false;
+        blocks.resize(n);
+        for (auto& b : blocks) {
+            b.minStart = (int64_t)r.U64();
+            b.maxEnd = (int64_t)r.U64();
+            b.count = r.U32();
+            b.offset = r.U32();
+            b.len = r.U32();
+        }
+        payloadLen = r.U32();
+        payload = r.Pos();
+        r.Skip(payloadLen);
+        if (!r.Ok()) return false;
+        for (auto& b : blocks)
+            if ((size_t)b.offset + b.len > payloadLen) return false;
+        return true;
+    }
+
+    // Calls fn(start, dur, app, source, category) with table indices for
+    // each record of the block, without building strings, until fn
+    // returns false.
+    template <class Fn>
+    bool Scan(const HistBlock& b, Fn fn) const {
+        ByteReader r(payload + b.offset, b.len);
+        int64_t start = 0;
+        for (uint32_t i = 0; i < b.count; i++) {
+            start += (int64_t)r.Var();
+            uint32_t dur = (uint32_t)r.Var();
+            uint64_t app = r.Var();
+            uint64_t src = version >= 2 ? r.Var() : 0;
+            uint64_t cat = version >= 3 ? r.Var() : 0;
+            if (!r.Ok() || app >= apps.size() || src >= sources.size() ||
+                cat >= categories.size()) return false;
+            if (!fn(start, dur, (uint32_t)app, (uint32_t)src, (uint32_t)cat)) break;
+        }
+        return true;
+    }
+
+    // Appends the block's records that overlap [from, to).
+    bool Decode(const HistBlock& b, std::vector<HistRecord>& out,
+        int64_t from, int64_t to) const {
+        return Scan(b, [&](int64_t start, uint32_t dur, uint32_t app, uint32_t src, uint32_t cat) {
+            if (start >= to) return false;
+            if (start + dur <= from) return true;
+            HistRecord rec;
+            rec.start = start;
+            rec.dur = dur;
+            rec.app = apps[app];
+            rec.source = sources[src];
+            rec.category = categories[cat];
+            out.push_back(std::move(rec));
+            return true;
+            });
+    }
+
+    // Sorts and de-duplicates recs, then encodes them as a segment file.
+    static std::string Encode(std::vector<HistRecord>& recs) {
+        std::sort(recs.begin(), recs.end());
+        recs.erase(std::unique(recs.begin(), recs.end()), recs.end());
+
+        std::map<std::wstring, uint32_t> ids, srcIds, catIds;
+        std::vector<std::wstring> names, srcs, cats;
+        for (auto& r : recs) {
+            if (ids.emplace(r.app, (uint32_t)names.size()).second) names.push_back(r.app);
+            if (srcIds.emplace(r.source, (uint32_t)srcs.size()).second) srcs.push_back(r.source);
+            if (catIds.emplace(r.category, (uint32_t)cats.size()).second) cats.push_back(r.category);
+        }
+
+        ByteWriter body;
+        std::vector<HistBlock> index;
+        for (size_t i = 0; i < recs.size(); i += kBlock) {
+            HistBlock b;
+            b.offset = (uint32_t)body.buf.size();
+            b.count = (uint32_t)std::min(kBlock, recs.size() - i);
+            b.minStart = recs[i].start;
+            b.maxEnd = recs[i].End();
+            int64_t prev = 0;
+            for (size_t j = i; j < i + b.count; j++) {
+                body.Var((uint64_t)(recs[j].start - prev));
+                body.Var(recs[j].dur);
+                body.Var(ids[recs[j].app]);
+                body.Var(srcIds[recs[j].source]);
+                body.Var(catIds[recs[j].category]);
+                prev = recs[j].start;
+                b.maxEnd = std::max(b.maxEnd, recs[j].End());
+            }
+            b.len = (uint32_t)body.buf.size() - b.offset;
+            index.push_back(b);
+        }
+
+        ByteWriter w;
+        w.U32(kMagic);
+        w.U32(kVersion);
+        w.U32((uint32_t)names.size());
+        for (auto& n : names) w.WStr(n);
+        w.U32((uint32_t)srcs.size());
+        for (auto& n : srcs) w.WStr(n);
+        w.U32((uint32_t)cats.size());
+        for (auto& n : cats) w.WStr(n);
+        w.U32((uint32_t)recs.size());
+        w.U32((uint32_t)index.size());
+        for (auto& b : index) {
+            w.U64((uint64_t)b.minStart);
+            w.U64((uint64_t)b.maxEnd);
+            w.U32(b.count);
+            w.U32(b.offset);
+            w.U32(b.len);
+        }
+        w.U32((uint32_t)body.buf.size());
+        w.buf += body.buf;
+        return w.buf;
+    }
+};
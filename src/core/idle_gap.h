@@ -0,0 +1,67 @@
+// Input-gap bookkeeping for idle trimming. A focus change during a gap in
+// input closes a session normally; if the gap later reaches the idle
+// threshold, the time since the last input comes back off every session
+// closed during it. Allocation-free. Plain C++17, no wxWidgets.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+class IdleGap {
+public:
+    // What a long gap takes off the last sessions.
+    struct Cut {
+        size_t first = 0;       // index of the first session the gap reached
+        int    firstCut = 0;    // seconds off it; the ones after it go whole
+        int    total = 0;       // seconds off them all
+        bool   keepFirst = false;   // it started before the gap and keeps the rest
+    };
+
+    // An idle reading of idle seconds at now. The reading jitters by a
+    // second; only a real advance is new input, and it ends the gap.
+    void Input(int64_t now, int idle) {
+        if (idle != 0 && now - idle <= m_lastInput + 1) return;
+        m_lastInput = now - idle;
+        m_closed = 0;
+    }
+
+    // A session of dur seconds closed untrimmed at now.
+    void Closed(int64_t now, int dur) {
+        int64_t tail = now - m_lastInput;
+        if (m_lastInput < 0 || tail <= 0) return;
+        if (!m_closed) m_tail = (int)std::min<int64_t>(dur, tail);
+        m_closed++;
+    }
+
+    // Sessions were closed during the current gap.
+    bool Pending() const { return m_closed > 0; }
+    int64_t LastInput() const { return m_lastInput; }
+
+    // The gap reached the threshold: the cut over the last of count
+    // sessions, durAt(i) giving each one's seconds. Sessions archived
+    // since (a new month) are out of reach. False if there is nothing to
+    // take; either way the gap has been spent.
+    template <class DurAt>
+    bool Take(size_t count, DurAt durAt, Cut& c) {
+        size_t closed = (size_t)m_closed, n = std::min(count, closed);
+        m_closed = 0;
+        if (!n) return false;
+        c.first = count - n;
+        int firstDur = durAt(c.first);
+        // With the earliest out of reach, the first left began in the gap.
+        c.firstCut = n < closed ? firstDur : std::min(m_tail, firstDur);
+        c.total = c.firstCut;
+        for (size_t i = c.first + 1; i < count; i++) c.total += durAt(i);
+        c.keepFirst = firstDur > c.firstCut;
+        return true;
+    }
+
+    // Sessions closed so far are no longer at the back, e.g. archived.
+    void Forget() { m_closed = 0; }
+
+private:
+    int64_t m_lastInput = -1;
+    int     m_closed = 0;   // sessions closed during the gap, at the back
+    int     m_tail = 0;     // seconds of the first of them inside the gap
+};
@@ -0,0 +1,80 @@
+// History journal records: framing and checked parsing. Plain C++17, no
+// wxWidgets. The journal is appended to by any process holding the
+// archive lock shared, each batch in one O_APPEND-style write, and is
+// emptied by the packer holding it exclusively.
+//
+// Record: "WTJ1" (add) or "WTJT" (tombstone), u32 len, u32 FNV-1a(payload),
+// payload = u64 start, varint dur, WStr app, source, category. A
+// tombstone removes a matching earlier record; an edit is a tombstone plus
+// the new record.
+#pragma once
+
+#include "bytes.h"
+#include "hist_segment.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+struct HistJournal {
+    static constexpr uint32_t kAddMagic = 0x314A5457;   // "WTJ1"
+    static constexpr uint32_t kTombMagic = 0x544A5457;  // "WTJT"
+    static constexpr size_t   kHeader = 12;
+
+    static void Put(std::string& out, const HistRecord& r, bool tomb) {
+        ByteWriter p;
+        p.U64((uint64_t)r.start);
+        p.Var(r.dur);
+        p.WStr(r.app);
+        p.WStr(r.source);
+        p.WStr(r.category);
+        ByteWriter w;
+        w.U32(tomb ? kTombMagic : kAddMagic);
+        w.U32((uint32_t)p.buf.size());
+        w.U32(Fnv1a(p.buf.data(), p.buf.size()));
+        out += w.buf;
+        out += p.buf;
+    }
+
+    // Calls fn(record, tomb) in journal order and returns how many bad
+    // stretches were skipped. A torn record (a writer died mid-append)
+    // fails its checksum and the scan resumes at the next magic, so one
+    // bad write never hides the records after it.
+    template <class Fn>
+    static size_t Parse(const std::string& raw, Fn fn) {
+        const char magic[3] = { 'W', 'T', 'J' };
+        size_t pos = 0, bad = 0;
+        bool skipping = false;
+        while (pos + kHeader <= raw.size()) {
+            ByteReader h(raw.data() + pos, kHeader);
+            uint32_t m = h.U32(), len = h.U32(), sum = h.U32();
+            if ((m != kAddMagic && m != kTombMagic) || len > raw.size() - pos - kHeader ||
+                Fnv1a(raw.data() + pos + kHeader, len) != sum) {
+                bad += !skipping;
+                skipping = true;
+                size_t next = raw.find(std::string_view(magic, 3), pos + 1);
+                if (next == std::string::npos) return bad;
+                pos = next;
+                continue;
+            }
+            skipping = false;
+            ByteReader r(raw.data() + pos + kHeader, len);
+            HistRecord rec;
+            rec.start = (int64_t)r.U64();
+            rec.dur = (uint32_t)r.Var();
+            rec.app = r.WStr();
+            rec.source = r.WStr();
+            rec.category = r.WStr();
+            if (r.Ok()) fn(rec, m == kTombMagic);
+            else bad++;
+            pos += kHeader + len;
+        }
+        return bad + (pos < raw.size() && !skipping);
+    }
+
+    static uint32_t Fnv1a(const char* p, size_t n) {
+        uint32_t h = 2166136261u;
+        for (size_t i = 0; i < n; i++) h = (h ^ (uint8_t)p[i]) * 16777619u;
+        return h;
+    }
+};
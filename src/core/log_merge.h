@@ -0,0 +1,57 @@
+// K-way merge of sorted session runs for the offline log import. Plain
+// C++17, no wxWidgets.
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+struct MergeRec {
+    int64_t  start;
+    uint32_t dur;
+    uint32_t app;   // ids into one name table shared by all runs
+    uint32_t src;
+    uint32_t cat;
+};
+
+// Min-heap over the run heads; each run is sorted by start. Overlapping
+// intervals of one source and app collapse into their union; the same
+// interval under another source is a copied log, not a second machine,
+// and is dropped. total is only a reserve hint.
+inline std::vector<MergeRec> MergeRuns(const std::vector<const std::vector<MergeRec>*>& runs,
+    size_t total) {
+    typedef std::pair<int64_t, uint32_t> Head;     // start, run
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heap;
+    std::vector<size_t> pos(runs.size(), 0);
+    for (uint32_t i = 0; i < runs.size(); i++)
+        if (!runs[i]->empty()) heap.push({ (*runs[i])[0].start, i });
+
+    std::vector<MergeRec> out;
+    out.reserve(total);
+    std::unordered_map<uint64_t, size_t> last;   // src << 32 | app -> index in out
+    while (!heap.empty()) {
+        uint32_t i = heap.top().second;
+        heap.pop();
+        const std::vector<MergeRec>& run = *runs[i];
+        const MergeRec& r = run[pos[i]++];
+        if (pos[i] < run.size()) heap.push({ run[pos[i]].start, i });
+
+        uint64_t key = (uint64_t)r.src << 32 | r.app;
+        auto it = last.find(key);
+        if (it != last.end() && r.start < out[it->second].start + out[it->second].dur) {
+            MergeRec& o = out[it->second];
+            o.dur = (uint32_t)(std::max(o.start + o.dur, r.start + r.dur) - o.start);
+            continue;
+        }
+        bool copy = false;
+        for (size_t k = out.size(); k-- > 0 && out[k].start == r.start; )
+            if (out[k].dur == r.dur && out[k].app == r.app) { copy = true; break; }
+        if (copy) continue;
+        last[key] = out.size();
+        out.push_back(r);
+    }
+    return out;
+}
@@ -0,0 +1,173 @@
+// Process snapshot diffing for the Add App picker: which exe names
+// appeared or disappeared since the last snapshot. Plain C++17, no
+// wxWidgets; the snapshot itself comes from a SnapshotSource (Toolhelp in
+// the app, /proc on Linux, a fake in the tests).
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __linux__
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#endif
+
+struct ProcEntry {
+    uint32_t     pid = 0;
+    uint32_t     parent = 0;
+    uint64_t     started = 0;   // creation time in the source's units; 0 = unknown
+    std::wstring exe;           // file name, "Code.exe"
+};
+
+class SnapshotSource {
+public:
+    // Every process running now. False if no snapshot could be taken.
+    virtual bool Take(std::vector<ProcEntry>& out) = 0;
+
+protected:
+    ~SnapshotSource() = default;
+};
+
+// An instance is (PID, start time). A source without start times keeps a
+// PID as the same instance while its exe and parent are unchanged; with
+// them the parent may change (a reparented orphan) and the start time
+// decides. The cost per poll is the snapshot plus the churn.
+class ProcSnapshotDiff {
+public:
+    struct Delta {
+        std::vector<ProcEntry>    added;    // first instance of each newly seen exe name
+        std::vector<std::wstring> exited;   // exe names with no instances left
+    };
+
+    // False if the source failed; d is left as it was.
+    bool Poll(SnapshotSource& src, Delta& d) {
+        m_snap.clear();
+        if (!src.Take(m_snap)) return false;
+        m_gen++;
+        for (const ProcEntry& e : m_snap) {
+            if (e.exe.empty()) continue;
+            auto it = m_live.find(e.pid);
+            if (it != m_live.end()) {
+                Instance& old = it->second;
+                bool same = old.exe == e.exe &&
+                    (e.started || old.started ? old.started == e.started : old.parent == e.parent);
+                if (same) {
+                    old.parent = e.parent;
+                    old.gen = m_gen;
+                    continue;
+                }
+                Release(old.exe, d);
+                m_live.erase(it);
+            }
+            Instance& inst = m_live[e.pid];
+            inst.exe = e.exe;
+            inst.parent = e.parent;
+            inst.started = e.started;
+            inst.gen = m_gen;
+            if (m_refs[e.exe]++ > 0) continue;
+            // A reused PID whose name came straight back: report neither.
+            auto x = std::find(d.exited.begin(), d.exited.end(), e.exe);
+            if (x != d.exited.end()) d.exited.erase(x);
+            else d.added.push_back(e);
+        }
+        for (auto it = m_live.begin(); it != m_live.end(); ) {
+            if (it->second.gen == m_gen) { ++it; continue; }
+            Release(it->second.exe, d);
+            it = m_live.erase(it);
+        }
+        return true;
+    }
+
+    bool Running(const std::wstring& exe) const { return m_refs.count(exe) != 0; }
+    bool Live(uint32_t pid) const { return m_live.count(pid) != 0; }
+
+    // Some live instance of exe, e.g. to retry one whose PID was reused.
+    bool AnyInstance(const std::wstring& exe, uint32_t& pid) const {
+        for (const auto& kv : m_live) {
+            if (kv.second.exe != exe) continue;
+            pid = kv.first;
+            return true;
+        }
+        return false;
+    }
+
+private:
+    struct Instance {
+        std::wstring exe;
+        uint32_t     parent = 0;
+        uint64_t     started = 0;
+        unsigned     gen = 0;
+    };
+    std::unordered_map<uint32_t, Instance> m_live;
+    std::map<std::wstring, int>            m_refs;
+    std::vector<ProcEntry>                 m_snap;
+    unsigned                               m_gen = 0;
+
+    void Release(const std::wstring& exe, Delta& d) {
+        auto r = m_refs.find(exe);
+        if (r == m_refs.end() || --r->second > 0) return;
+        m_refs.erase(r);
+        // Appeared and vanished within this poll: report neither.
+        for (auto a = d.added.begin(); a != d.added.end(); ++a) {
+            if (a->exe != exe) continue;
+            d.added.erase(a);
+            return;
+        }
+        d.exited.push_back(exe);
+    }
+};
+
+#ifdef __linux__
+// /proc/<pid>/stat: "pid (comm) state ppid ..." with the start time, in
+// clock ticks since boot, as field 22. comm is the name the kernel keeps
+// (at most 15 bytes) and is taken as ASCII.
+class ProcFsSource : public SnapshotSource {
+public:
+    bool Take(std::vector<ProcEntry>& out) override {
+        DIR* dir = opendir("/proc");
+        if (!dir) return false;
+        while (dirent* de = readdir(dir)) {
+            char* end;
+            unsigned long pid = std::strtoul(de->d_name, &end, 10);
+            if (*end || !pid) continue;
+            ProcEntry e;
+            if (Read((uint32_t)pid, e)) out.push_back(e);  // gone in between: skip
+        }
+        closedir(dir);
+        return true;
+    }
+
+    static bool Read(uint32_t pid, ProcEntry& e) {
+        char path[32], buf[1024];
+        std::snprintf(path, sizeof(path), "/proc/%u/stat", pid);
+        FILE* f = std::fopen(path, "r");
+        if (!f) return false;
+        size_t n = std::fread(buf, 1, sizeof(buf) - 1, f);
+        std::fclose(f);
+        buf[n] = 0;
+        // comm may hold spaces and parentheses; it ends at the last ')'.
+        char* open = std::strchr(buf, '(');
+        char* close = std::strrchr(buf, ')');
+        if (!open || !close || close < open) return false;
+        e.pid = pid;
+        e.exe.assign(open + 1, close);
+        char* p = close + 1;
+        unsigned long long parent = 0, started = 0;
+        for (int field = 3; field <= 22 && *p; field++) {
+            while (*p == ' ') p++;
+            if (field == 4) parent = std::strtoull(p, nullptr, 10);
+            if (field == 22) started = std::strtoull(p, nullptr, 10);
+            while (*p && *p != ' ') p++;
+        }
+        e.parent = (uint32_t)parent;
+        e.started = started;
+        return true;
+    }
+};
+#endif
@@ -0,0 +1,245 @@
+// Tracking rules, one per line, first match wins:
+//   <exe|*> [title~text] [title!~text] [days=mon-fri,sun] [time=HH:MM-HH:MM] -> <category|ignore>
+// e.g.  chrome.exe title~jira -> Jira
+//       * days=sat,sun -> ignore
+//       slack.exe time=10:00-11:00 -> Meetings
+// Text with spaces goes in double quotes. Matching is case-insensitive.
+// A sample that matches no rule falls back to the work-app list.
+//
+// Rules compile into a flat decision table grouped by exe, with the
+// wildcard rows copied into every group in rule order. A sample binary
+// searches its exe and walks only that group's rows. The window title is
+// fetched only when a row with a title test is reached. Plain C++17, no
+// wxWidgets.
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cwchar>
+#include <cwctype>
+#include <string>
+#include <vector>
+
+// Lazily fetched, lower-cased foreground window title for rule tests.
+class TitleSource {
+public:
+    virtual const wchar_t* Title() = 0;
+
+protected:
+    ~TitleSource() = default;
+};
+
+struct RuleSample {
+    const wchar_t* exe;         // lower-case file name
+    int            weekday;     // 0 = Sunday
+    int            minute;      // since local midnight
+    TitleSource*   title;       // may be null
+};
+
+class RuleTable {
+public:
+    static const int kIgnore = -1;
+    static const int kNoMatch = -2;
+
+    // Replaces the table. On a bad line the table is left empty and error
+    // names the line.
+    bool Compile(const std::vector<std::wstring>& lines, std::wstring* error) {
+        std::vector<Row> rows;
+        std::vector<std::wstring> exes;     // per row, "" = any
+        Clear();
+        for (size_t i = 0; i < lines.size(); i++) {
+            std::wstring why;
+            Row row;
+            std::wstring exe;
+            if (!ParseLine(lines[i], row, exe, why)) {
+                if (error) *error = L"Line " + std::to_wstring(i + 1) + L": " + why;
+                Clear();
+                return false;
+            }
+            if (row.days == 0) continue;    // blank or comment
+            rows.push_back(row);
+            exes.push_back(exe);
+        }
+
+        for (auto& e : exes)
+            if (!e.empty()) m_exes.push_back(e);
+        std::sort(m_exes.begin(), m_exes.end());
+        m_exes.erase(std::unique(m_exes.begin(), m_exes.end()), m_exes.end());
+        // One group per named exe, then the wildcard-only group.
+        for (size_t g = 0; g <= m_exes.size(); g++) {
+            m_groups.push_back((uint32_t)m_table.size());
+            for (size_t r = 0; r < rows.size(); r++)
+                if (exes[r].empty() || (g < m_exes.size() && exes[r] == m_exes[g]))
+                    m_table.push_back(rows[r]);
+        }
+        m_groups.push_back((uint32_t)m_table.size());
+        return true;
+    }
+
+    // Category index, kIgnore or kNoMatch. Allocation-free.
+    int Eval(const RuleSample& s) const {
+        if (m_table.empty()) return kNoMatch;
+        auto it = std::lower_bound(m_exes.begin(), m_exes.end(), s.exe,
+            [](const std::wstring& a, const wchar_t* b) { return wcscmp(a.c_str(), b) < 0; });
+        size_t g = it != m_exes.end() && wcscmp(it->c_str(), s.exe) == 0 ?
+            it - m_exes.begin() : m_exes.size();
+        for (uint32_t i = m_groups[g]; i < m_groups[g + 1]; i++) {
+            const Row& r = m_table[i];
+            if (!(r.days >> s.weekday & 1)) continue;
+            bool inside = r.from <= r.to ? s.minute >= r.from && s.minute < r.to
+                                         : s.minute >= r.from || s.minute < r.to;
+            if (!inside) continue;
+            if (r.needle >= 0) {
+                const wchar_t* t = s.title ? s.title->Title() : L"";
+                if ((wcsstr(t, m_needles[r.needle].c_str()) != nullptr) == r.negate) continue;
+            }
+            return r.action;
+        }
+        return kNoMatch;
+    }
+
+    const std::wstring& Category(int i) const { return m_categories[i]; }
+    bool Empty() const { return m_table.empty(); }
+
+private:
+    struct Row {
+        uint8_t days = 0x7f;    // bit per weekday, Sunday = bit 0
+        int16_t from = 0;       // minutes; from > to wraps past midnight
+        int16_t to = 24 * 60;
+        int16_t needle = -1;    // into m_needles
+        bool    negate = false;
+        int     action = kIgnore;
+    };
+
+    std::vector<Row>          m_table;
+    std::vector<uint32_t>     m_groups;     // m_exes.size() + 2 offsets into m_table
+    std::vector<std::wstring> m_exes;       // sorted, lower-case
+    std::vector<std::wstring> m_needles;    // lower-case
+    std::vector<std::wstring> m_categories;
+
+    void Clear() {
+        m_table.clear();
+        m_groups.clear();
+        m_exes.clear();
+        m_needles.clear();
+        m_categories.clear();
+    }
+
+    static std::wstring Lower(std::wstring w) {
+        for (auto& c : w) c = (wchar_t)towlower(c);
+        return w;
+    }
+
+    static bool Prefix(const std::wstring& s, const wchar_t* p, std::wstring* rest = nullptr) {
+        size_t n = wcslen(p);
+        if (s.compare(0, n, p) != 0) return false;
+        if (rest) *rest = s.substr(n);
+        return true;
+    }
+
+    // Whitespace-separated, "..." keeps spaces (also after title~).
+    static std::vector<std::wstring> Tokens(const std::wstring& line) {
+        std::vector<std::wstring> out;
+        std::wstring cur;
+        bool quoted = false, any = false;
+        for (wchar_t c : line) {
+            if (c == '"') { quoted = !quoted; any = true; continue; }
+            if (!quoted && (c == ' ' || c == '\t')) {
+                if (any) out.push_back(cur);
+                cur.clear();
+                any = false;
+                continue;
+            }
+            cur += c;
+            any = true;
+        }
+        if (any) out.push_back(cur);
+        return out;
+    }
+
+    // Up to four digits, nothing else.
+    static bool ParseNumber(const std::wstring& s, int& out) {
+        if (s.empty() || s.size() > 4) return false;
+        out = 0;
+        for (wchar_t c : s) {
+            if (c < '0' || c > '9') return false;
+            out = out * 10 + (c - '0');
+        }
+        return true;
+    }
+
+    static bool ParseClock(const std::wstring& s, int16_t& out) {
+        size_t colon = s.find(':');
+        int h = 0, m = 0;
+        if (colon == std::wstring::npos || !ParseNumber(s.substr(0, colon), h) ||
+            !ParseNumber(s.substr(colon + 1), m) ||
+            h > 24 || m > 59 || h * 60 + m > 24 * 60) return false;
+        out = (int16_t)(h * 60 + m);
+        return true;
+    }
+
+    static bool ParseDays(const std::wstring& s, uint8_t& mask) {
+        static const wchar_t* const names[] = { L"sun", L"mon", L"tue", L"wed", L"thu", L"fri", L"sat" };
+        auto day = [&](const std::wstring& n) {
+            for (int i = 0; i < 7; i++) if (n == names[i]) return i;
+            return -1;
+        };
+        mask = 0;
+        std::wstring low = Lower(s);
+        for (size_t at = 0; at <= low.size() && !low.empty(); ) {
+            size_t comma = std::min(low.find(L',', at), low.size());
+            std::wstring part = low.substr(at, comma - at);
+            at = comma + 1;
+            if (part == L"weekdays") { mask |= 0x3e; continue; }
+            if (part == L"weekends") { mask |= 0x41; continue; }
+            size_t dash = part.find(L'-');
+            int a = day(part.substr(0, dash));
+            int b = dash == std::wstring::npos ? a : day(part.substr(dash + 1));
+            if (a < 0 || b < 0) return false;
+            for (int d = a; ; d = (d + 1) % 7) {
+                mask |= (uint8_t)(1 << d);
+                if (d == b) break;
+            }
+        }
+        return mask != 0;
+    }
+
+    // A blank or '#' line yields row.days == 0.
+    bool ParseLine(const std::wstring& line, Row& row, std::wstring& exe, std::wstring& why) {
+        std::vector<std::wstring> tok = Tokens(line);
+        if (tok.empty() || tok[0][0] == '#') { row.days = 0; return true; }
+        size_t arrow = std::find(tok.begin(), tok.end(), L"->") - tok.begin();
+        if (arrow + 2 != tok.size()) { why = L"expected '... -> category'"; return false; }
+        exe = tok[0] == L"*" ? std::wstring() : Lower(tok[0]);
+
+        for (size_t i = 1; i < arrow; i++) {
+            const std::wstring& t = tok[i];
+            std::wstring v;
+            if (Prefix(t, L"title!~", &v) || Prefix(t, L"title~", &v)) {
+                if (v.empty()) { why = L"empty title text"; return false; }
+                row.negate = Prefix(t, L"title!~");
+                row.needle = (int16_t)m_needles.size();
+                m_needles.push_back(Lower(v));
+            } else if (Prefix(t, L"days=", &v)) {
+                if (!ParseDays(v, row.days)) { why = L"bad days '" + v + L"'"; return false; }
+            } else if (Prefix(t, L"time=", &v)) {
+                size_t dash = v.find(L'-');
+                if (dash == std::wstring::npos || !ParseClock(v.substr(0, dash), row.from) ||
+                    !ParseClock(v.substr(dash + 1), row.to)) {
+                    why = L"bad time '" + v + L"'";
+                    return false;
+                }
+            } else {
+                why = L"unknown condition '" + t + L"'";
+                return false;
+            }
+        }
+
+        const std::wstring& act = tok[arrow + 1];
+        if (Lower(act) == L"ignore") { row.action = kIgnore; return true; }
+        auto c = std::find(m_categories.begin(), m_categories.end(), act);
+        row.action = (int)(c - m_categories.begin());
+        if (c == m_categories.end()) m_categories.push_back(act);
+        return true;
+    }
+};
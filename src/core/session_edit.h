@@ -0,0 +1,33 @@
+// Where an edit of one stored session is written. This month's sessions
+// are hot: rows of the ini list, rewritten with it on save. Older ones are
+// cold: in the history archive, where a change is journaled as a tombstone
+// plus the new record. An edit may move a session across the split either
+// way. Plain C++17, no wxWidgets.
+#pragma once
+
+#include "hist_segment.h"
+
+#include <cstddef>
+
+struct SessionEditPlan {
+    int               hotOld = -1;          // old's hot row to erase, or -1
+    bool              hotNew = false;       // repl becomes a hot row
+    const HistRecord* archiveOld = nullptr; // to tombstone in the archive
+    const HistRecord* archiveNew = nullptr; // to journal in the archive
+};
+
+// old -> repl, either null for an add or a delete. rowAt(i) gives hot row
+// i of rows as a record; old is hot only if it equals one exactly, so an
+// undo must pass repl back as it was stored (hot rows keep end times to
+// the minute). replHot: repl falls in this month.
+template <class RowAt>
+SessionEditPlan PlanSessionEdit(size_t rows, RowAt rowAt,
+    const HistRecord* old, const HistRecord* repl, bool replHot) {
+    SessionEditPlan p;
+    for (size_t i = 0; old && p.hotOld < 0 && i < rows; i++)
+        if (rowAt(i) == *old) p.hotOld = (int)i;
+    p.hotNew = repl && replHot;
+    p.archiveOld = old && p.hotOld < 0 ? old : nullptr;
+    p.archiveNew = repl && !replHot ? repl : nullptr;
+    return p;
+}
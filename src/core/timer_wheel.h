@@ -0,0 +1,121 @@
+// Hierarchical timing wheel over a seconds clock: 4 levels of 64 slots
+// (64 s, ~68 min, ~73 h, ~194 days). Each second touches one level-0 slot.
+// Every 64th second one upper slot is cascaded down a level, so a tick
+// costs the same however many timers are armed. Timers are intrusive
+// index-linked nodes sized once by Reserve; Add, Cancel and cascades
+// don't allocate. Plain C++17, no wxWidgets.
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+class TimerWheel {
+public:
+    TimerWheel() { Reset(0); }
+
+    void Reset(int64_t now) {
+        m_now = now;
+        std::fill(std::begin(m_heads), std::end(m_heads), -1);
+        for (auto& n : m_nodes) n.slot = -1;
+    }
+
+    int64_t Now() const { return m_now; }
+
+    // Sizes the node table for ids [0, n) and disarms them all. Call when
+    // the timer set changes, never per tick.
+    void Reserve(size_t n) {
+        m_nodes.assign(n, Node());
+        Reset(m_now);
+    }
+
+    // Re-adding an armed id moves it. A time not after Now() fires next tick.
+    void Add(uint32_t id, int64_t when) {
+        assert(id < m_nodes.size());
+        Cancel(id);
+        m_nodes[id].when = std::max(when, m_now + 1);
+        Place(id);
+    }
+
+    void Cancel(uint32_t id) {
+        if (id >= m_nodes.size() || m_nodes[id].slot < 0) return;
+        Node& n = m_nodes[id];
+        if (n.prev >= 0) m_nodes[n.prev].next = n.next;
+        else m_heads[n.slot] = n.next;
+        if (n.next >= 0) m_nodes[n.next].prev = n.prev;
+        n.slot = -1;
+    }
+
+    // Steps the clock to now, appending due ids to fired. A jump of more
+    // than a day (sleep, clock change) re-places everything in one pass.
+    void Advance(int64_t now, std::vector<uint32_t>& fired) {
+        if (now - m_now > 24 * 3600) {
+            m_now = now - 1;
+            for (uint32_t id = 0; id < m_nodes.size(); id++) {
+                if (m_nodes[id].slot < 0) continue;
+                Cancel(id);
+                m_nodes[id].when = std::max(m_nodes[id].when, now);
+                Place(id);
+            }
+        }
+        while (m_now < now) {
+            m_now++;
+            for (int lvl = 1; lvl < kLevels && Index(m_now, lvl - 1) == 0; lvl++)
+                Cascade(lvl * kSlots + Index(m_now, lvl));
+            int slot = Index(m_now, 0);
+            for (int32_t id = m_heads[slot]; id >= 0; ) {
+                int32_t next = m_nodes[id].next;
+                Cancel(id);
+                fired.push_back((uint32_t)id);
+                id = next;
+            }
+        }
+    }
+
+private:
+    static const int kBits = 6;
+    static const int kSlots = 1 << kBits;
+    static const int kLevels = 4;
+
+    struct Node {
+        int64_t when = 0;
+        int32_t prev = -1;
+        int32_t next = -1;
+        int16_t slot = -1;      // -1 = not armed
+    };
+
+    std::vector<Node> m_nodes;
+    int32_t           m_heads[kLevels * kSlots];
+    int64_t           m_now = 0;
+
+    static int Index(int64_t t, int lvl) { return (int)((t >> (lvl * kBits)) & (kSlots - 1)); }
+
+    void Place(uint32_t id) {
+        Node& n = m_nodes[id];
+        int64_t when = std::max(n.when, m_now);
+        int64_t delta = when - m_now;
+        int lvl = 0;
+        while (lvl < kLevels - 1 && delta >= (int64_t)1 << ((lvl + 1) * kBits)) lvl++;
+        if (delta >= (int64_t)1 << (kLevels * kBits))
+            when = m_now + ((int64_t)1 << (kLevels * kBits)) - 1;
+        int slot = lvl * kSlots + Index(when, lvl);
+        n.slot = (int16_t)slot;
+        n.prev = -1;
+        n.next = m_heads[slot];
+        if (n.next >= 0) m_nodes[n.next].prev = (int32_t)id;
+        m_heads[slot] = (int32_t)id;
+    }
+
+    void Cascade(int slot) {
+        int32_t id = m_heads[slot];
+        m_heads[slot] = -1;
+        while (id >= 0) {
+            int32_t next = m_nodes[id].next;
+            m_nodes[id].slot = -1;
+            Place((uint32_t)id);
+            id = next;
+        }
+    }
+};
@@ -5,6 +5,7 @@
  * - System tray icon
  * - Onboarding wizard
  * - App list with icons
+ * - Headless tracking mode (--headless)
  */
 
 #include "wx/wxprec.h"
@@ -26,19 +27,62 @@
 #include <wx/imaglist.h>
 #include <wx/wizard.h>
 #include <wx/checklst.h>
+#include <wx/file.h>
+#include <wx/dcbuffer.h>
+#include <wx/dir.h>
+#include <wx/snglinst.h>
+#include <unordered_map>
 
 #include <windows.h>
 #include <psapi.h>
 #include <shellapi.h>
+#include <shlobj.h>
 #include <tlhelp32.h>
 #include <vector>
+#include <array>
 #include <string>
 #include <map>
 #include <set>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <deque>
+#include <condition_variable>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <cwctype>
+#include <new>
+#include <memory>
+#include <limits>
+#include <queue>
+#include <random>
+#include <functional>
+#include <string_view>
+#include <ctime>
+#include <tuple>
+
+#include "core/bucket_pyramid.h"
+#include "core/bytes.h"
+#include "core/civil.h"
+#include "core/clock_text.h"
+#include "core/csv.h"
+#include "core/hist_segment.h"
+#include "core/idle_gap.h"
+#include "core/journal.h"
+#include "core/log_merge.h"
+#include "core/proc_snapshot.h"
+#include "core/rule_table.h"
+#include "core/session_edit.h"
+#include "core/timer_wheel.h"
 
 #pragma comment(lib, "psapi.lib")
 #pragma comment(lib, "shell32.lib")
+#pragma comment(lib, "version.lib")
+#pragma comment(lib, "ole32.lib")
 
  // -----------------------------------------
  // Colors
@@ -52,6 +96,564 @@
 #define CLR_GREEN   wxColour(68,  255, 136)
 #define CLR_ORANGE  wxColour(255, 170, 0  )
 
+// -----------------------------------------
+// Perf instrumentation
+// -----------------------------------------
+// Scoped timers feed per-thread log-linear (HDR-style) histograms. Only the
+// owning thread writes its buffers, so recording is a relaxed load/store
+// with no locks. Switched off, a scope costs one relaxed load and a branch.
+// The same scopes also feed the trace recorder when it is running.
+#ifndef WT_PERF
+#define WT_PERF 1
+#endif
+
+// Diagnostic builds only (CMake WT_ALLOC_CHECK): replaces the global
+// operator new to count allocations on the tick and sample paths.
+#ifndef WT_ALLOC_CHECK
+#define WT_ALLOC_CHECK 0
+#endif
+
+enum PerfId {
+    kPerfForeground,
+    kPerfMonitor,
+    kPerfSaveConfig,
+    kPerfLoadConfig,
+    kPerfProcesses,
+    kPerfRefreshApps,
+    kPerfTick,
+    kPerfIconExtract,
+    kPerfDialogBuild,
+    kPerfPaint,
+    kPerfCatalogSearch,
+    kPerfCatalogScan,
+    kPerfHistoryPack,
+    kPerfHistoryQuery,
+    kPerfLogMerge,
+    kPerfHistoryExport,
+    kPerfHistoryImport,
+    kPerfRules,
+    kPerfTimelineBuild,
+    kPerfTimelinePaint,
+    kPerfCount
+};
+
+enum PerfCounter {
+    kCtrSamples,
+    kCtrIconCacheHits,
+    kCtrSaves,
+    kCtrBytesWritten,
+    kCtrPaints,
+    kCtrPaintNs,
+    kCtrHotAllocs,
+    kCtrImported,
+    kCtrCount
+};
+
+static const char* const kPerfNames[kPerfCount] = {
+    "ForegroundSampler::Sample", "OnMonitor", "SaveConfig",
+    "LoadConfig", "ProcessWatcher::Poll", "RefreshAppList",
+    "OnTick", "IconExtract", "DialogBuild", "TimerDisplay::OnPaint",
+    "ExeCatalog::Search", "ExeCatalog::Scan",
+    "HistoryArchive::Pack", "HistoryArchive::Query", "LogMerge::Run",
+    "HistoryIO::Export", "HistoryIO::Import", "RuleTable::Eval",
+    "Tracker::BuildTimeline", "TimelineView::OnPaint",
+};
+static const char* const kCtrNames[kCtrCount] = {
+    "samples", "icon cache hits", "saves", "bytes written",
+    "timer paints", "timer paint ns", "tick/sample allocs",
+    "imported sessions",
+};
+
+// 16 linear sub-buckets per power of two: <7% relative error up to 2^63 ns.
+static const int kHistBuckets = 64 * 16;
+
+inline int HistBucket(uint64_t v) {
+    if (v < 32) return (int)v;
+    int m = 63;
+    while (!(v >> m)) m--;
+    return (m - 3) * 16 + (int)((v >> (m - 4)) & 15);
+}
+
+inline uint64_t HistBucketFloor(int idx) {
+    if (idx < 32) return (uint64_t)idx;
+    int m = idx / 16 + 3;
+    return (uint64_t)(16 + idx % 16) << (m - 4);
+}
+
+struct PerfThreadData {
+    std::atomic<uint64_t> hist[kPerfCount][kHistBuckets];
+    std::atomic<uint64_t> maxNs[kPerfCount];
+    std::atomic<uint64_t> counters[kCtrCount];
+};
+
+struct PerfRegistry {
+    std::mutex lock;
+    std::vector<PerfThreadData*> threads;
+};
+
+// Bit 0: histograms/counters, bit 1: trace recording.
+enum { kInstrPerf = 1, kInstrTrace = 2 };
+static std::atomic<unsigned> g_instr{ 0 };
+
+inline PerfRegistry& GetPerfRegistry() {
+    static PerfRegistry reg;
+    return reg;
+}
+
+// Per-thread buffers are never freed so readers stay valid after a thread exits.
+inline PerfThreadData& PerfLocal() {
+    thread_local PerfThreadData* data = nullptr;
+    if (!data) {
+        data = new PerfThreadData();
+        for (auto& h : data->hist) for (auto& b : h) b.store(0, std::memory_order_relaxed);
+        for (auto& m : data->maxNs) m.store(0, std::memory_order_relaxed);
+        for (auto& c : data->counters) c.store(0, std::memory_order_relaxed);
+        PerfRegistry& reg = GetPerfRegistry();
+        std::lock_guard<std::mutex> g(reg.lock);
+        reg.threads.push_back(data);
+    }
+    return *data;
+}
+
+inline bool PerfEnabled() { return (g_instr.load(std::memory_order_relaxed) & kInstrPerf) != 0; }
+inline void PerfEnable(bool on) {
+    if (on) g_instr.fetch_or(kInstrPerf, std::memory_order_relaxed);
+    else    g_instr.fetch_and(~kInstrPerf, std::memory_order_relaxed);
+}
+inline bool TraceEnabled() { return (g_instr.load(std::memory_order_relaxed) & kInstrTrace) != 0; }
+
+inline uint64_t PerfNowNs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline void PerfRecord(PerfId id, uint64_t ns) {
+    PerfThreadData& d = PerfLocal();
+    auto& b = d.hist[id][HistBucket(ns)];
+    b.store(b.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (ns > d.maxNs[id].load(std::memory_order_relaxed))
+        d.maxNs[id].store(ns, std::memory_order_relaxed);
+}
+
+inline void PerfAdd(PerfCounter c, uint64_t n = 1) {
+    if (!PerfEnabled()) return;
+    auto& v = PerfLocal().counters[c];
+    v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+// -----------------------------------------
+// Trace recording
+// -----------------------------------------
+// Chrome/Perfetto trace-event JSON. Each thread appends to its own SPSC
+// ring; a background thread drains the rings and writes the file, so the
+// recording thread never formats or touches disk. Full rings drop events.
+struct TraceEvent {
+    const char* name;
+    uint64_t    tsNs;
+    uint64_t    durNs;
+    char        ph;         // 'X' complete span, 'i' instant
+    char        arg[47];    // optional UTF-8 detail, NUL-terminated
+};
+
+struct TraceRing {
+    static const uint32_t kSize = 4096;   // power of two
+    TraceEvent            ev[kSize];
+    std::atomic<uint32_t> head{ 0 };      // advanced by the owning thread
+    std::atomic<uint32_t> tail{ 0 };      // advanced by the flusher
+    DWORD                 tid = 0;
+};
+
+class TraceRecorder {
+public:
+    static TraceRecorder& Get() {
+        static TraceRecorder rec;
+        return rec;
+    }
+
+    bool Start(const wxString& path) {
+        if (TraceEnabled()) return true;
+        if (!m_file.Open(path, wxFile::write)) return false;
+        m_path = path;
+        m_first = true;
+        m_t0Ns = PerfNowNs();
+        m_dropped.store(0);
+        m_file.Write("{\"traceEvents\":[\n", 17);
+        m_stop = false;
+        m_thread = std::thread([this] { FlushLoop(); });
+        g_instr.fetch_or(kInstrTrace, std::memory_order_relaxed);
+        return true;
+    }
+
+    void Stop() {
+        if (!TraceEnabled()) return;
+        g_instr.fetch_and(~kInstrTrace, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> g(m_wake);
+            m_stop = true;
+        }
+        m_cv.notify_one();
+        m_thread.join();
+        std::string out;
+        Drain(out);
+        out += "\n]}\n";
+        m_file.Write(out.data(), out.size());
+        m_file.Close();
+    }
+
+    const wxString& Path() const { return m_path; }
+    uint64_t Dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    void Push(const TraceEvent& e) {
+        TraceRing& r = Local();
+        uint32_t h = r.head.load(std::memory_order_relaxed);
+        if (h - r.tail.load(std::memory_order_acquire) >= TraceRing::kSize) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        r.ev[h & (TraceRing::kSize - 1)] = e;
+        r.head.store(h + 1, std::memory_order_release);
+    }
+
+private:
+    std::mutex              m_lock;     // guards m_rings
+    std::vector<TraceRing*> m_rings;
+    std::mutex              m_wake;
+    std::condition_variable m_cv;
+    bool                    m_stop = false;
+    std::thread             m_thread;
+    wxFile                  m_file;
+    wxString                m_path;
+    bool                    m_first = true;
+    uint64_t                m_t0Ns = 0;
+    std::atomic<uint64_t>   m_dropped{ 0 };
+
+    // Rings outlive their threads, like the perf buffers.
+    TraceRing& Local() {
+        thread_local TraceRing* ring = nullptr;
+        if (!ring) {
+            ring = new TraceRing();
+            ring->tid = GetCurrentThreadId();
+            std::lock_guard<std::mutex> g(m_lock);
+            m_rings.push_back(ring);
+        }
+        return *ring;
+    }
+
+    void FlushLoop() {
+        std::string out;
+        std::unique_lock<std::mutex> lk(m_wake);
+        while (!m_stop) {
+            m_cv.wait_for(lk, std::chrono::milliseconds(250));
+            lk.unlock();
+            out.clear();
+            Drain(out);
+            if (!out.empty()) m_file.Write(out.data(), out.size());
+            lk.lock();
+        }
+    }
+
+    static void AppendEscaped(std::string& out, const char* s) {
+        for (; *s; s++) {
+            if (*s == '"' || *s == '\\') out += '\\';
+            if ((unsigned char)*s >= 0x20) out += *s;
+        }
+    }
+
+    void Drain(std::string& out) {
+        std::lock_guard<std::mutex> g(m_lock);
+        char num[96];
+        DWORD pid = GetCurrentProcessId();
+        for (auto* r : m_rings) {
+            uint32_t t = r->tail.load(std::memory_order_relaxed);
+            uint32_t h = r->head.load(std::memory_order_acquire);
+            for (; t != h; t++) {
+                const TraceEvent& e = r->ev[t & (TraceRing::kSize - 1)];
+                out += m_first ? "" : ",\n";
+                m_first = false;
+                out += "{\"name\":\"";
+                AppendEscaped(out, e.name);
+                uint64_t ts = e.tsNs > m_t0Ns ? e.tsNs - m_t0Ns : 0;
+                snprintf(num, sizeof(num), "\",\"ph\":\"%c\",\"pid\":%lu,\"tid\":%lu,\"ts\":%.3f",
+                    e.ph, (unsigned long)pid, (unsigned long)r->tid, ts / 1000.0);
+                out += num;
+                if (e.ph == 'X') {
+                    snprintf(num, sizeof(num), ",\"dur\":%.3f", e.durNs / 1000.0);
+                    out += num;
+                }
+                else {
+                    out += ",\"s\":\"t\"";
+                }
+                if (e.arg[0]) {
+                    out += ",\"args\":{\"detail\":\"";
+                    AppendEscaped(out, e.arg);
+                    out += "\"}";
+                }
+                out += "}";
+            }
+            r->tail.store(h, std::memory_order_release);
+        }
+    }
+};
+
+inline void TraceInstant(const char* name, const char* arg = "") {
+    if (!TraceEnabled()) return;
+    TraceEvent e;
+    e.name = name;
+    e.tsNs = PerfNowNs();
+    e.durNs = 0;
+    e.ph = 'i';
+    strncpy(e.arg, arg, sizeof(e.arg) - 1);
+    e.arg[sizeof(e.arg) - 1] = 0;
+    TraceRecorder::Get().Push(e);
+}
+
+class PerfScope {
+public:
+    explicit PerfScope(PerfId id, const char* traceName = nullptr)
+        : m_id(id), m_name(traceName),
+          m_mode(WT_PERF ? g_instr.load(std::memory_order_relaxed) : 0),
+          m_t0(m_mode ? PerfNowNs() : 0) {}
+    ~PerfScope() { End(); }
+
+    // Closes the scope early; later calls and the destructor do nothing.
+    void End() {
+        if (!m_mode) return;
+        uint64_t dur = PerfNowNs() - m_t0;
+        if (m_mode & kInstrPerf) PerfRecord(m_id, dur);
+        if (m_mode & kInstrTrace) {
+            TraceEvent e;
+            e.name = m_name ? m_name : kPerfNames[m_id];
+            e.tsNs = m_t0;
+            e.durNs = dur;
+            e.ph = 'X';
+            e.arg[0] = 0;
+            TraceRecorder::Get().Push(e);
+        }
+        m_mode = 0;
+    }
+
+    PerfScope(const PerfScope&) = delete;
+    PerfScope& operator=(const PerfScope&) = delete;
+private:
+    PerfId      m_id;
+    const char* m_name;
+    unsigned    m_mode;
+    uint64_t    m_t0;
+};
+
+#if WT_PERF
+#define PERF_SCOPE(id)              PerfScope perfScope_(id)
+#define PERF_SCOPE_NAMED(id, name)  PerfScope perfScope_(id, name)
+#define PERF_COUNT(ctr, n)          PerfAdd(ctr, n)
+#define TRACE_INSTANT(name, arg)    TraceInstant(name, arg)
+#else
+#define PERF_SCOPE(id)              ((void)0)
+#define PERF_SCOPE_NAMED(id, name)  ((void)0)
+#define PERF_COUNT(ctr, n)          ((void)0)
+#define TRACE_INSTANT(name, arg)    ((void)0)
+#endif
+
+#if WT_ALLOC_CHECK
+// Heap allocations made by this thread. Steady-state ticks and samples
+// (no start/stop transition) report their deltas as kCtrHotAllocs, and a
+// trace replay fails if any of its steady steps allocated.
+static thread_local uint64_t t_allocs = 0;
+
+void* operator new(size_t n) {
+    t_allocs++;
+    if (void* p = malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+inline uint64_t ThreadAllocs() { return t_allocs; }
+
+class HotAllocScope {
+public:
+    HotAllocScope() : m_start(t_allocs) {}
+    ~HotAllocScope() { if (!m_skip) PerfAdd(kCtrHotAllocs, t_allocs - m_start); }
+    void Skip() { m_skip = true; }
+private:
+    uint64_t m_start;
+    bool     m_skip = false;
+};
+
+#define PERF_HOT_ALLOCS()           HotAllocScope hotAllocs_
+#define PERF_HOT_ALLOCS_SKIP()      hotAllocs_.Skip()
+#else
+#define PERF_HOT_ALLOCS()           ((void)0)
+#define PERF_HOT_ALLOCS_SKIP()      ((void)0)
+#endif
+
+struct PerfSummary {
+    uint64_t count = 0, p50 = 0, p99 = 0, maxNs = 0;
+};
+
+// p50/p99 of a kHistBuckets histogram.
+inline PerfSummary HistSummarize(const std::vector<uint64_t>& merged, uint64_t maxNs) {
+    PerfSummary r;
+    r.maxNs = maxNs;
+    for (auto c : merged) r.count += c;
+    if (!r.count) return r;
+    uint64_t want50 = (r.count + 1) / 2, want99 = r.count - r.count / 100, seen = 0;
+    for (int i = 0; i < kHistBuckets; i++) {
+        if (!merged[i]) continue;
+        seen += merged[i];
+        if (!r.p50 && seen >= want50) r.p50 = HistBucketFloor(i);
+        if (seen >= want99) { r.p99 = HistBucketFloor(i); break; }
+    }
+    return r;
+}
+
+// Merges every thread's histogram for one id.
+inline PerfSummary PerfSummarize(PerfId id) {
+    std::vector<uint64_t> merged(kHistBuckets, 0);
+    uint64_t maxNs = 0;
+    PerfRegistry& reg = GetPerfRegistry();
+    {
+        std::lock_guard<std::mutex> g(reg.lock);
+        for (auto* t : reg.threads) {
+            for (int i = 0; i < kHistBuckets; i++)
+                merged[i] += t->hist[id][i].load(std::memory_order_relaxed);
+            maxNs = std::max(maxNs, t->maxNs[id].load(std::memory_order_relaxed));
+        }
+    }
+    return HistSummarize(merged, maxNs);
+}
+
+inline uint64_t PerfCounterTotal(PerfCounter c) {
+    uint64_t n = 0;
+    PerfRegistry& reg = GetPerfRegistry();
+    std::lock_guard<std::mutex> g(reg.lock);
+    for (auto* t : reg.threads) n += t->counters[c].load(std::memory_order_relaxed);
+    return n;
+}
+
+// -----------------------------------------
+// Startup phases
+// -----------------------------------------
+// Milestones measured from process creation, so loader and static init
+// count too. Always recorded: a mark is one clock read. The first
+// foreground sample is held to kFirstSampleBudgetMs.
+static const double kFirstSampleBudgetMs = 100.0;
+
+class StartupPhases {
+public:
+    static StartupPhases& Get() {
+        static StartupPhases phases;
+        return phases;
+    }
+
+    void Mark(const char* phase) {
+        uint64_t ns = SinceCreationNs();
+        {
+            std::lock_guard<std::mutex> g(m_lock);
+            if (m_count < kMaxMarks) m_marks[m_count++] = { phase, ns };
+        }
+        TRACE_INSTANT("startup", phase);
+    }
+
+    // Milliseconds to the first mark of phase, or -1 if not reached.
+    double Ms(const char* phase) {
+        std::lock_guard<std::mutex> g(m_lock);
+        for (int i = 0; i < m_count; i++)
+            if (strcmp(m_marks[i].phase, phase) == 0) return m_marks[i].ns / 1e6;
+        return -1;
+    }
+
+    wxString Report() {
+        std::lock_guard<std::mutex> g(m_lock);
+        wxString out = wxString::Format("%-26s %8s %10s\n", "startup phase", "ms", "+ms");
+        uint64_t prev = 0;
+        for (int i = 0; i < m_count; i++) {
+            const Entry& e = m_marks[i];
+            double ms = e.ns / 1e6;
+            out += wxString::Format("%-26s %8.1f %10.1f", e.phase, ms, (e.ns - prev) / 1e6);
+            if (strcmp(e.phase, "first sample") == 0)
+                out += ms <= kFirstSampleBudgetMs ? "  within budget" : "  OVER BUDGET";
+            out += "\n";
+            prev = e.ns;
+        }
+        return out;
+    }
+
+private:
+    struct Entry {
+        const char* phase;
+        uint64_t    ns;
+    };
+    static const int kMaxMarks = 16;
+
+    std::mutex m_lock;
+    Entry      m_marks[kMaxMarks];
+    int        m_count = 0;
+    uint64_t   m_created = 0;      // FILETIME units
+
+    StartupPhases() {
+        FILETIME created, exited, kernel, user;
+        if (GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user))
+            m_created = ((uint64_t)created.dwHighDateTime << 32) | created.dwLowDateTime;
+    }
+
+    uint64_t SinceCreationNs() const {
+        FILETIME now;
+        GetSystemTimePreciseAsFileTime(&now);
+        uint64_t t = ((uint64_t)now.dwHighDateTime << 32) | now.dwLowDateTime;
+        return t > m_created ? (t - m_created) * 100 : 0;
+    }
+};
+
+// Resident memory of this process. --headless is held to
+// kHeadlessBudgetMb of working set.
+static const double kHeadlessBudgetMb = 5.0;
+
+// Working set in MB, or -1 if it can't be read.
+double WorkingSetMb() {
+    PROCESS_MEMORY_COUNTERS pmc = {};
+    pmc.cb = sizeof(pmc);
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) return -1;
+    return pmc.WorkingSetSize / (1024.0 * 1024.0);
+}
+
+wxString MemoryReport(bool headless) {
+    PROCESS_MEMORY_COUNTERS_EX pmc = {};
+    pmc.cb = sizeof(pmc);
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), (PROCESS_MEMORY_COUNTERS*)&pmc, sizeof(pmc)))
+        return "memory                     unavailable\n";
+    const double mb = 1024.0 * 1024.0;
+    double ws = pmc.WorkingSetSize / mb;
+    wxString out = wxString::Format("%-26s %8.1f MB", "working set", ws);
+    if (headless) out += ws <= kHeadlessBudgetMb ? "  within budget" : "  OVER BUDGET";
+    out += wxString::Format("\n%-26s %8.1f MB\n%-26s %8.1f MB\n",
+        "peak working set", pmc.PeakWorkingSetSize / mb, "private bytes", pmc.PrivateUsage / mb);
+    return out;
+}
+
+wxString PerfReport(bool headless = false) {
+    wxString out = wxString::Format("%-26s %8s %10s %10s %10s\n",
+        "scope", "count", "p50 us", "p99 us", "max us");
+    for (int i = 0; i < kPerfCount; i++) {
+        PerfSummary sm = PerfSummarize((PerfId)i);
+        out += wxString::Format("%-26s %8llu %10.1f %10.1f %10.1f\n",
+            kPerfNames[i], (unsigned long long)sm.count,
+            sm.p50 / 1000.0, sm.p99 / 1000.0, sm.maxNs / 1000.0);
+    }
+    out += "\n";
+    for (int i = 0; i < kCtrCount; i++)
+        out += wxString::Format("%-26s %8llu\n", kCtrNames[i],
+            (unsigned long long)PerfCounterTotal((PerfCounter)i));
+    out += "\n" + StartupPhases::Get().Report();
+    out += "\n" + MemoryReport(headless);
+    return out;
+}
+
+bool PerfDump(const wxString& path, bool headless = false) {
+    wxFile f;
+    if (!f.Open(path, wxFile::write)) return false;
+    return f.Write(PerfReport(headless));
+}
+
 // -----------------------------------------
 // Structs
 // -----------------------------------------
@@ -73,15 +675,22 @@ struct Session {
     int      duration;
     wxString date;
     wxString endTime;
+    wxString source;    // machine tag from a log import; empty for this machine
+    wxString category;  // from the rule that started it; may be empty
 };
 
 struct AppConfig {
-    std::vector<WorkApp> workApps;
+    std::vector<WorkApp>  workApps;
+    std::vector<wxString> rules;     // see RuleTable
+    std::vector<wxString> alerts;    // see AlertScheduler
+    wxString alertsFired;            // AlertScheduler::FiredToday() for lastDate
     bool     colorAlert = true;
     int      alertMinutes = 30;
+    int      idleMinutes = 5;     // no input this long pauses tracking; 0 = off
     bool     alwaysOnTop = true;
     bool     startInTray = false;
     bool     onboardDone = false;
+    bool     perfEnabled = false;
     int      todayTotal = 0;
     wxString lastDate;
 };
@@ -89,85 +698,464 @@ struct AppConfig {
 // -----------------------------------------
 // Win32 helpers
 // -----------------------------------------
-std::vector<ProcessInfo> GetRunningProcesses() {
-    std::vector<ProcessInfo> result;
-    std::set<wxString> seen;
+// Second-launch handover. The tracking instance serves a named pipe,
+// which unlike a window broadcast also reaches launches from other logon
+// sessions. A request is one byte; the reply is u8 kind, u32 session id,
+// u32 pid, so the caller can tell a window it can raise from one in
+// another session or from a headless tracker.
+class InstancePipe {
+public:
+    enum Kind : uint8_t { kNobody = 0, kWindow = 'W', kHeadless = 'H' };
+    enum Request : uint8_t { kActivate = 'A', kQuit = 'Q' };
 
-    HANDLE snap = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
-    if (snap == INVALID_HANDLE_VALUE) return result;
+    struct Reply {
+        uint8_t  kind = kNobody;
+        uint32_t session = 0;
+        uint32_t pid = 0;
+    };
 
-    PROCESSENTRY32W pe; pe.dwSize = sizeof(pe);
-    if (Process32FirstW(snap, &pe)) {
-        do {
-            wxString exeName(pe.szExeFile);
-            if (exeName.IsEmpty() || seen.count(exeName)) continue;
-            seen.insert(exeName);
+    ~InstancePipe() { Stop(); }
 
-            ProcessInfo info;
-            info.exeName = exeName;
-            info.pid = pe.th32ProcessID;
-
-            HANDLE hProc = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pe.th32ProcessID);
-            if (hProc) {
-                wchar_t path[MAX_PATH]; DWORD sz = MAX_PATH;
-                if (QueryFullProcessImageNameW(hProc, 0, path, &sz))
-                    info.exePath = wxString(path);
-                CloseHandle(hProc);
+    // handler runs on the pipe thread; UI work goes through CallAfter.
+    void Serve(Kind kind, std::function<void(Request)> handler) {
+        m_kind = kind;
+        m_handler = std::move(handler);
+        m_thread = std::thread([this] { Run(); });
+    }
+
+    void Stop() {
+        if (!m_thread.joinable()) return;
+        m_stop = true;
+        // Unblock ConnectNamedPipe with a connection of our own.
+        HANDLE h = CreateFileW(Name().wc_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL,
+            OPEN_EXISTING, 0, NULL);
+        if (h != INVALID_HANDLE_VALUE) CloseHandle(h);
+        m_thread.join();
+    }
+
+    // Asks the running instance; kind stays kNobody if none answers
+    // within about two seconds.
+    static Reply Call(Request req) {
+        Reply r;
+        wxString name = Name();
+        HANDLE h = INVALID_HANDLE_VALUE;
+        for (int tries = 0; tries < 20 && h == INVALID_HANDLE_VALUE; tries++) {
+            h = CreateFileW(name.wc_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL);
+            if (h != INVALID_HANDLE_VALUE) break;
+            // Busy, or between connections while the server re-arms.
+            if (GetLastError() != ERROR_PIPE_BUSY || !WaitNamedPipeW(name.wc_str(), 100)) Sleep(100);
+        }
+        if (h == INVALID_HANDLE_VALUE) return r;
+        uint8_t buf[kReply];
+        DWORD n = 0, got = 0;
+        if (WriteFile(h, &req, 1, &n, NULL))
+            while (got < kReply && ReadFile(h, buf + got, kReply - got, &n, NULL) && n) got += n;
+        CloseHandle(h);
+        if (got == kReply) {
+            r.kind = buf[0];
+            memcpy(&r.session, buf + 1, 4);
+            memcpy(&r.pid, buf + 5, 4);
+        }
+        return r;
+    }
+
+    static uint32_t Session() {
+        DWORD id = 0;
+        ProcessIdToSessionId(GetCurrentProcessId(), &id);
+        return id;
+    }
+
+private:
+    static const DWORD kReply = 9;
+
+    Kind                         m_kind = kWindow;
+    std::function<void(Request)> m_handler;
+    std::thread                  m_thread;
+    std::atomic<bool>            m_stop{ false };
+
+    // Machine-wide, unlike the Local\ object namespace.
+    static wxString Name() { return "\\\\.\\pipe\\WorkTimer-" + wxGetUserId(); }
+
+    void Run() {
+        uint8_t reply[kReply] = { (uint8_t)m_kind };
+        uint32_t session = Session(), pid = GetCurrentProcessId();
+        memcpy(reply + 1, &session, 4);
+        memcpy(reply + 5, &pid, 4);
+        while (!m_stop) {
+            // First-instance only, so nobody else can have claimed the name.
+            HANDLE h = CreateNamedPipeW(Name().wc_str(),
+                PIPE_ACCESS_DUPLEX | FILE_FLAG_FIRST_PIPE_INSTANCE,
+                PIPE_TYPE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS, 1, kReply, 1, 0, NULL);
+            if (h == INVALID_HANDLE_VALUE) return;
+            bool connected = ConnectNamedPipe(h, NULL) || GetLastError() == ERROR_PIPE_CONNECTED;
+            uint8_t req = 0;
+            DWORD n = 0;
+            if (connected && !m_stop && ReadFile(h, &req, 1, &n, NULL) && n == 1) {
+                WriteFile(h, reply, kReply, &n, NULL);
+                FlushFileBuffers(h);
+                if (req == kActivate || req == kQuit) m_handler((Request)req);
             }
+            DisconnectNamedPipe(h);
+            CloseHandle(h);
+        }
+    }
+};
+
+// Raw icon for an exe. Plain Win32, so safe off the UI thread; the caller
+// owns the handle.
+HICON ExtractExeIcon(const wchar_t* path) {
+    PERF_SCOPE(kPerfIconExtract);
+    HICON hIco = NULL;
+    ExtractIconExW(path, 0, NULL, &hIco, 1);
+    if (!hIco) ExtractIconExW(path, 0, &hIco, NULL, 1);
+    return hIco;
+}
+
+bool LoadExeIcon(const wxString& path, wxIcon& icon) {
+    HICON hIco = ExtractExeIcon(path.wc_str());
+    if (!hIco) return false;
+    icon.CreateFromHICON(hIco);
+    DestroyIcon(hIco);
+    return icon.IsOk();
+}
+
+// Toolhelp process snapshot. It has no start times, so ProcSnapshotDiff
+// falls back to exe and parent for telling a reused PID apart.
+class ToolhelpSource : public SnapshotSource {
+public:
+    bool Take(std::vector<ProcEntry>& out) override {
+        HANDLE snap = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+        if (snap == INVALID_HANDLE_VALUE) return false;
+        PROCESSENTRY32W pe; pe.dwSize = sizeof(pe);
+        if (Process32FirstW(snap, &pe)) {
+            do {
+                ProcEntry e;
+                e.pid = pe.th32ProcessID;
+                e.parent = pe.th32ParentProcessID;
+                e.exe = pe.szExeFile;
+                out.push_back(std::move(e));
+            } while (Process32NextW(snap, &pe));
+        }
+        CloseHandle(snap);
+        return true;
+    }
+};
+
+// Incremental process list over ProcSnapshotDiff (core/proc_snapshot.h):
+// reports exe names that appeared or disappeared since the last Poll().
+// The UI thread only walks the snapshot: the first instance of a new exe
+// name is handed to a worker, which opens it for its creation time, image
+// path and icon, and the result comes back in a later Poll() or
+// Resolved() call. The cost beyond the snapshot scales with churn.
+//
+// A new PID is checked with GetProcessTimes: one created after the
+// snapshot was reused in between and is resolved again from another
+// instance of the name.
+class ProcessWatcher {
+public:
+    struct Delta {
+        std::vector<ProcessInfo> added;     // one per newly seen exe name, path and icon to follow
+        std::vector<wxString>    exited;    // exe names with no instances left
+        std::vector<ProcessInfo> resolved;  // path and icon for names added earlier
+    };
+
+    // onResolved runs on the worker whenever its queue drains.
+    explicit ProcessWatcher(std::function<void()> onResolved = nullptr)
+        : m_onResolved(std::move(onResolved)), m_worker([this] { Work(); }) {}
+
+    ~ProcessWatcher() {
+        {
+            std::lock_guard<std::mutex> g(m_lock);
+            m_quit = true;
+        }
+        m_wake.notify_one();
+        m_worker.join();
+        for (auto& r : m_done) if (r.icon) DestroyIcon(r.icon);
+    }
+
+    Delta Poll() {
+        PERF_SCOPE(kPerfProcesses);
+        Delta d = Resolved();
+        FILETIME ft;
+        GetSystemTimeAsFileTime(&ft);
+        uint64_t now = Ticks(ft);
+        ProcSnapshotDiff::Delta sd;
+        if (!m_diff.Poll(m_source, sd)) return d;
+
+        std::vector<Job> jobs;
+        for (ProcEntry& e : sd.added) {
+            ProcessInfo info;
+            info.exeName = wxString(e.exe);
+            info.pid = e.pid;
+            d.added.push_back(info);
+            jobs.push_back({ e.pid, std::move(e.exe), now });
+        }
+        for (auto& name : sd.exited) d.exited.push_back(wxString(name));
+        // Names that vanished again are dropped when their result arrives.
+        Queue(jobs);
+        return d;
+    }
 
-            if (!info.exePath.IsEmpty()) {
-                HICON hIco = NULL;
-                ExtractIconExW(info.exePath.wc_str(), 0, NULL, &hIco, 1);
-                if (!hIco) ExtractIconExW(info.exePath.wc_str(), 0, &hIco, NULL, 1);
-                if (hIco) {
-                    info.icon.CreateFromHICON(hIco);
-                    info.hasIcon = info.icon.IsOk();
-                    DestroyIcon(hIco);
+    // Results finished since the last call, for names still running.
+    Delta Resolved() {
+        std::vector<Result> done;
+        {
+            std::lock_guard<std::mutex> g(m_lock);
+            done.swap(m_done);
+        }
+        Delta d;
+        std::vector<Job> retry;
+        for (Result& r : done) {
+            wxString name(r.exeName);
+            if (m_diff.Running(r.exeName)) {
+                if (r.reused) {
+                    Retry(r.exeName, retry);
+                } else {
+                    ProcessInfo info;
+                    info.exeName = name;
+                    info.pid = r.pid;
+                    info.exePath = wxString(r.path);
+                    if (r.icon) {
+                        info.icon.CreateFromHICON(r.icon);
+                        info.hasIcon = info.icon.IsOk();
+                    }
+                    d.resolved.push_back(info);
                 }
             }
-            result.push_back(info);
-        } while (Process32NextW(snap, &pe));
+            if (r.icon) DestroyIcon(r.icon);
+        }
+        Queue(retry);
+        return d;
     }
-    CloseHandle(snap);
 
-    std::sort(result.begin(), result.end(),
-        [](const ProcessInfo& a, const ProcessInfo& b) {
-            return a.exeName.CmpNoCase(b.exeName) < 0;
-        });
-    return result;
+private:
+    struct Job {
+        DWORD        pid;
+        std::wstring exeName;
+        uint64_t     seen;      // snapshot time, FILETIME ticks
+    };
+    struct Result {
+        DWORD        pid = 0;
+        std::wstring exeName;
+        std::wstring path;
+        HICON        icon = NULL;
+        bool         reused = false;
+    };
+    ToolhelpSource   m_source;
+    ProcSnapshotDiff m_diff;
+
+    std::function<void()>   m_onResolved;
+    std::mutex              m_lock;
+    std::condition_variable m_wake;
+    std::deque<Job>         m_jobs;
+    std::vector<Result>     m_done;
+    bool                    m_quit = false;
+    std::thread             m_worker;   // last: started once the rest exists
+
+    static uint64_t Ticks(const FILETIME& ft) {
+        return ((uint64_t)ft.dwHighDateTime << 32) | ft.dwLowDateTime;
+    }
+
+    // Another live instance of a name whose first one was reused.
+    void Retry(const std::wstring& exeName, std::vector<Job>& jobs) {
+        uint32_t pid;
+        if (!m_diff.AnyInstance(exeName, pid)) return;
+        FILETIME ft;
+        GetSystemTimeAsFileTime(&ft);
+        jobs.push_back({ (DWORD)pid, exeName, Ticks(ft) });
+    }
+
+    void Queue(std::vector<Job>& jobs) {
+        if (jobs.empty()) return;
+        {
+            std::lock_guard<std::mutex> g(m_lock);
+            for (Job& j : jobs) m_jobs.push_back(std::move(j));
+        }
+        m_wake.notify_one();
+    }
+
+    void Work() {
+        std::unique_lock<std::mutex> lk(m_lock);
+        for (;;) {
+            m_wake.wait(lk, [this] { return m_quit || !m_jobs.empty(); });
+            if (m_quit) return;
+            Job job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+            lk.unlock();
+            Result r = Resolve(job);
+            lk.lock();
+            m_done.push_back(std::move(r));
+            if (m_jobs.empty() && m_onResolved) {
+                lk.unlock();
+                m_onResolved();
+                lk.lock();
+            }
+        }
+    }
+
+    static Result Resolve(const Job& job) {
+        Result r;
+        r.pid = job.pid;
+        r.exeName = job.exeName;
+        HANDLE hProc = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, job.pid);
+        if (!hProc) return r;   // gone, or protected: no path
+        FILETIME created, exited, kernel, user;
+        if (GetProcessTimes(hProc, &created, &exited, &kernel, &user) &&
+            Ticks(created) > job.seen) {
+            r.reused = true;
+        } else {
+            wchar_t path[MAX_PATH]; DWORD sz = MAX_PATH;
+            if (QueryFullProcessImageNameW(hProc, 0, path, &sz))
+                r.path = path;
+        }
+        CloseHandle(hProc);
+        if (!r.path.empty()) r.icon = ExtractExeIcon(r.path.c_str());
+        return r;
+    }
+};
+
+bool ProcessLess(const ProcessInfo& a, const ProcessInfo& b) {
+    return a.exeName.CmpNoCase(b.exeName) < 0;
 }
 
-wxString GetForegroundProcessName() {
-    HWND hwnd = GetForegroundWindow();
-    if (!hwnd) return wxEmptyString;
-    DWORD pid = 0;
-    GetWindowThreadProcessId(hwnd, &pid);
-    HANDLE hProc = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
-    if (!hProc) return wxEmptyString;
-    wchar_t buf[MAX_PATH]; DWORD sz = MAX_PATH;
-    wxString name;
-    if (QueryFullProcessImageNameW(hProc, 0, buf, &sz))
-        name = wxFileName(wxString(buf)).GetFullName();
-    CloseHandle(hProc);
-    return name;
+// Distinct running exe names, sorted case-insensitively. No process is
+// opened and no icon loaded, so it is cheap enough for a worker thread.
+std::vector<std::wstring> RunningExeNames() {
+    PERF_SCOPE(kPerfProcesses);
+    std::vector<std::wstring> names;
+    HANDLE snap = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+    if (snap == INVALID_HANDLE_VALUE) return names;
+    PROCESSENTRY32W pe; pe.dwSize = sizeof(pe);
+    if (Process32FirstW(snap, &pe)) {
+        do {
+            if (pe.szExeFile[0]) names.push_back(pe.szExeFile);
+        } while (Process32NextW(snap, &pe));
+    }
+    CloseHandle(snap);
+    auto less = [](const std::wstring& a, const std::wstring& b) { return _wcsicmp(a.c_str(), b.c_str()) < 0; };
+    std::sort(names.begin(), names.end(), less);
+    names.erase(std::unique(names.begin(), names.end(),
+        [](const std::wstring& a, const std::wstring& b) { return _wcsicmp(a.c_str(), b.c_str()) == 0; }),
+        names.end());
+    return names;
 }
 
+// Milliseconds since the last keyboard or mouse input.
+class InputSource {
+public:
+    virtual uint32_t IdleMs() = 0;
+
+protected:
+    ~InputSource() = default;
+};
+
+// Foreground exe lookup without heap allocation. The image path lives in
+// a reusable buffer and is only re-queried when the foreground window or
+// its process changes. The title is read only if a rule asks for it.
+class ForegroundSampler : public TitleSource, public InputSource {
+public:
+    // Returns the exe file name ("Code.exe") or nullptr. Valid until the next call.
+    const wchar_t* Sample() {
+        PERF_SCOPE(kPerfForeground);
+        m_titleValid = false;
+        HWND hwnd = GetForegroundWindow();
+        if (!hwnd) return nullptr;
+        DWORD pid = 0;
+        GetWindowThreadProcessId(hwnd, &pid);
+        if (hwnd == m_hwnd && pid == m_pid) return m_name;
+
+        m_hwnd = hwnd;
+        m_pid = pid;
+        m_name = nullptr;
+        HANDLE hProc = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+        if (!hProc) return nullptr;
+        DWORD sz = MAX_PATH;
+        if (QueryFullProcessImageNameW(hProc, 0, m_path, &sz)) {
+            const wchar_t* slash = wcsrchr(m_path, L'\\');
+            m_name = slash ? slash + 1 : m_path;
+        }
+        CloseHandle(hProc);
+        return m_name;
+    }
+
+    // Title of the window from the last Sample(); re-read once per sample
+    // since tabs and documents change it without changing the window.
+    const wchar_t* Title() override {
+        if (!m_titleValid) {
+            int n = m_hwnd ? GetWindowTextW(m_hwnd, m_title, kTitleLen) : 0;
+            m_title[n > 0 ? n : 0] = 0;
+            for (wchar_t* p = m_title; *p; p++) *p = (wchar_t)towlower(*p);
+            m_titleValid = true;
+        }
+        return m_title;
+    }
+
+    DWORD Pid() const { return m_pid; }
+
+    // The session-wide last-input tick the OS already keeps; one call per
+    // sample, no hooks. Tick wraparound cancels out in the subtraction.
+    uint32_t IdleMs() override {
+        LASTINPUTINFO li = { sizeof(li) };
+        if (!GetLastInputInfo(&li)) return 0;
+        return GetTickCount() - li.dwTime;
+    }
+
+private:
+    static const int kTitleLen = 256;
+
+    HWND           m_hwnd = nullptr;
+    DWORD          m_pid = 0;
+    const wchar_t* m_name = nullptr;
+    wchar_t        m_path[MAX_PATH] = {};
+    wchar_t        m_title[kTitleLen] = {};
+    bool           m_titleValid = false;
+};
+
 // -----------------------------------------
 // Config
 // -----------------------------------------
-wxString GetConfigPath() {
-    wxFileName fn(wxStandardPaths::Get().GetUserDataDir(), "work_timer.ini");
+// Where the ini and history live. A trace replay passes its own scratch
+// directory instead.
+wxString DataDir() {
+    return wxStandardPaths::Get().GetUserDataDir();
+}
+
+// A fresh data directory under the temp dir for replays and test runs,
+// named per process so parallel ones can't collide; removed with
+// everything in it. path is empty if it couldn't be made, or if make
+// was false.
+struct ScratchDir {
+    wxString path;
+
+    explicit ScratchDir(bool make = true) {
+        if (!make) return;
+        wxString tmp = wxFileName::CreateTempFileName(
+            wxString::Format("wtscratch%lu-", (unsigned long)GetCurrentProcessId()));
+        if (!tmp.IsEmpty() && wxRemoveFile(tmp) && wxMkdir(tmp)) path = tmp;
+    }
+    ~ScratchDir() {
+        if (!path.IsEmpty()) wxFileName::Rmdir(path, wxPATH_RMDIR_RECURSIVE);
+    }
+};
+
+wxString GetConfigPath(const wxString& dir = DataDir()) {
+    wxFileName fn(dir, "work_timer.ini");
     fn.Mkdir(wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
     return fn.GetFullPath();
 }
 
-void SaveConfig(const AppConfig& cfg, const std::vector<Session>& sessions) {
-    wxFileConfig fc(wxEmptyString, wxEmptyString, GetConfigPath());
+void SaveConfig(const AppConfig& cfg, const std::vector<Session>& sessions,
+                const wxString& dir = DataDir()) {
+    PERF_SCOPE(kPerfSaveConfig);
+    wxString path = GetConfigPath(dir);
+    wxFileConfig fc(wxEmptyString, wxEmptyString, path);
     fc.Write("/settings/colorAlert", cfg.colorAlert);
     fc.Write("/settings/alertMinutes", cfg.alertMinutes);
+    fc.Write("/settings/idleMinutes", cfg.idleMinutes);
     fc.Write("/settings/alwaysOnTop", cfg.alwaysOnTop);
     fc.Write("/settings/startInTray", cfg.startInTray);
     fc.Write("/settings/onboardDone", cfg.onboardDone);
+    fc.Write("/settings/perfEnabled", cfg.perfEnabled);
     fc.Write("/settings/todayTotal", cfg.todayTotal);
     fc.Write("/settings/lastDate", cfg.lastDate);
 
@@ -177,6 +1165,15 @@ void SaveConfig(const AppConfig& cfg, const std::vector<Session>& sessions) {
         fc.Write(wxString::Format("/apps/label%d", i), cfg.workApps[i].label);
     }
 
+    fc.DeleteGroup("/rules");
+    for (int i = 0; i < (int)cfg.rules.size(); i++)
+        fc.Write(wxString::Format("/rules/r%d", i), cfg.rules[i]);
+
+    fc.DeleteGroup("/alerts");
+    for (int i = 0; i < (int)cfg.alerts.size(); i++)
+        fc.Write(wxString::Format("/alerts/a%d", i), cfg.alerts[i]);
+    if (!cfg.alertsFired.IsEmpty()) fc.Write("/alerts/fired", cfg.alertsFired);
+
     fc.DeleteGroup("/sessions");
     int keep = std::max(0, (int)sessions.size() - 500);
     for (int i = keep; i < (int)sessions.size(); i++) {
@@ -185,19 +1182,30 @@ void SaveConfig(const AppConfig& cfg, const std::vector<Session>& sessions) {
         fc.Write(wxString::Format("/sessions/s%d_dur", idx), sessions[i].duration);
         fc.Write(wxString::Format("/sessions/s%d_date", idx), sessions[i].date);
         fc.Write(wxString::Format("/sessions/s%d_end", idx), sessions[i].endTime);
+        if (!sessions[i].category.IsEmpty())
+            fc.Write(wxString::Format("/sessions/s%d_cat", idx), sessions[i].category);
     }
     fc.Write("/sessions/count", (int)(sessions.size() - keep));
     fc.Flush();
-}
 
-AppConfig LoadConfig(std::vector<Session>& sessions) {
+    PERF_COUNT(kCtrSaves, 1);
+    if (PerfEnabled()) {
+        wxFile f(path);
+        if (f.IsOpened()) PERF_COUNT(kCtrBytesWritten, (uint64_t)f.Length());
+    }
+}
+
+AppConfig LoadConfig(std::vector<Session>& sessions, const wxString& dir = DataDir()) {
+    PERF_SCOPE(kPerfLoadConfig);
     AppConfig cfg;
-    wxFileConfig fc(wxEmptyString, wxEmptyString, GetConfigPath());
+    wxFileConfig fc(wxEmptyString, wxEmptyString, GetConfigPath(dir));
     cfg.colorAlert = fc.ReadBool("/settings/colorAlert", true);
     cfg.alertMinutes = fc.ReadLong("/settings/alertMinutes", 30);
+    cfg.idleMinutes = std::max(0L, fc.ReadLong("/settings/idleMinutes", 5));
     cfg.alwaysOnTop = fc.ReadBool("/settings/alwaysOnTop", true);
     cfg.startInTray = fc.ReadBool("/settings/startInTray", false);
     cfg.onboardDone = fc.ReadBool("/settings/onboardDone", false);
+    cfg.perfEnabled = fc.ReadBool("/settings/perfEnabled", false);
     cfg.todayTotal = fc.ReadLong("/settings/todayTotal", 0);
     cfg.lastDate = fc.Read("/settings/lastDate", wxEmptyString);
 
@@ -210,6 +1218,19 @@ AppConfig LoadConfig(std::vector<Session>& sessions) {
         if (!a.exeName.IsEmpty()) cfg.workApps.push_back(a);
     }
 
+    for (int i = 0; ; i++) {
+        wxString kr = wxString::Format("/rules/r%d", i);
+        if (!fc.HasEntry(kr)) break;
+        cfg.rules.push_back(fc.Read(kr, wxEmptyString));
+    }
+
+    for (int i = 0; ; i++) {
+        wxString ka = wxString::Format("/alerts/a%d", i);
+        if (!fc.HasEntry(ka)) break;
+        cfg.alerts.push_back(fc.Read(ka, wxEmptyString));
+    }
+    cfg.alertsFired = fc.Read("/alerts/fired", wxEmptyString);
+
     int cnt = fc.ReadLong("/sessions/count", 0);
     for (int i = 0; i < cnt; i++) {
         Session s;
@@ -217,327 +1238,4257 @@ AppConfig LoadConfig(std::vector<Session>& sessions) {
         s.duration = fc.ReadLong(wxString::Format("/sessions/s%d_dur", i), 0);
         s.date = fc.Read(wxString::Format("/sessions/s%d_date", i), "");
         s.endTime = fc.Read(wxString::Format("/sessions/s%d_end", i), "");
+        s.category = fc.Read(wxString::Format("/sessions/s%d_cat", i), "");
         if (!s.appName.IsEmpty()) sessions.push_back(s);
     }
     return cfg;
 }
 
 wxString FormatTime(int secs) {
-    return wxString::Format("%02d:%02d:%02d",
-        secs / 3600, (secs % 3600) / 60, secs % 60);
+    char buf[16];
+    FormatClock(secs, buf);
+    return wxString(buf);
 }
 
-// =========================================
-// Forward declarations
-// =========================================
-class MainFrame;
+// -----------------------------------------
+// Binary IO
+// -----------------------------------------
+// Whole-file helpers; ByteWriter/ByteReader are in core/bytes.h.
+bool ReadWholeFile(const wxString& path, std::string& out) {
+    wxFile f;
+    if (!wxFileExists(path) || !f.Open(path, wxFile::read)) return false;
+    out.resize((size_t)f.Length());
+    return out.empty() || f.Read(&out[0], out.size()) == (ssize_t)out.size();
+}
+
+// Writes to a temp file and renames over the target so readers never see
+// a half-written file.
+bool WriteWholeFile(const wxString& path, const std::string& data) {
+    wxString tmp = path + ".tmp";
+    {
+        wxFile f;
+        if (!f.Open(tmp, wxFile::write)) return false;
+        if (f.Write(data.data(), data.size()) != data.size()) return false;
+    }
+    return wxRenameFile(tmp, path, true);
+}
+
+// One write through a FILE_APPEND_DATA handle, the Win32 O_APPEND: the
+// data lands whole at the end of file even while other processes append.
+bool AppendToFile(const wxString& path, const std::string& data) {
+    HANDLE h = CreateFileW(path.wc_str(), FILE_APPEND_DATA,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_ALWAYS,
+        FILE_ATTRIBUTE_NORMAL, NULL);
+    if (h == INVALID_HANDLE_VALUE) return false;
+    DWORD n = 0;
+    bool ok = WriteFile(h, data.data(), (DWORD)data.size(), &n, NULL) && n == data.size();
+    CloseHandle(h);
+    return ok;
+}
 
 // =========================================
-// Tray Icon
+// History archive
 // =========================================
-class TrayIcon : public wxTaskBarIcon {
+// Sessions from closed months live in compressed per-month segments
+// (history\YYYY-MM.seg) instead of work_timer.ini. New sessions are
+// appended to history\journal.wtj, which any process can do without a
+// rewrite; a background thread packs the journal into the segments under
+// an exclusive file lock. Range queries read only the segments and blocks
+// whose time range overlaps, plus the journal. The segment format is in
+// core/hist_segment.h.
+// Session keeps only the end date and "HH:MM"; start is end - duration.
+HistRecord ToHistRecord(const Session& s) {
+    HistRecord r;
+    r.dur = (uint32_t)std::max(0, s.duration);
+    r.app = s.appName.ToStdWstring();
+    r.source = s.source.ToStdWstring();
+    r.category = s.category.ToStdWstring();
+    wxDateTime d;
+    long h = 0, m = 0;
+    if (d.ParseISODate(s.date)) {
+        s.endTime.BeforeFirst(':').ToLong(&h);
+        s.endTime.AfterFirst(':').ToLong(&m);
+        d.SetHour((wxDateTime::wxDateTime_t)h).SetMinute((wxDateTime::wxDateTime_t)m);
+        r.start = (int64_t)d.GetTicks() - r.dur;
+    }
+    return r;
+}
+
+Session ToSession(const HistRecord& r) {
+    Session s;
+    s.appName = r.app;
+    s.duration = (int)r.dur;
+    s.source = r.source;
+    s.category = r.category;
+    wxDateTime end((time_t)r.End());
+    s.date = end.FormatISODate();
+    s.endTime = end.Format("%H:%M");
+    return s;
+}
+
+// Byte-range lock on history\archive.lock, held for one archive operation.
+// Journal appends and reads share it, so appenders in different processes
+// never wait on each other; packing (segment rewrites, emptying the
+// journal) takes it exclusively. Blocks until granted.
+class HistoryLock {
 public:
-    MainFrame* m_frame;
-    explicit TrayIcon(MainFrame* f) : m_frame(f) {}
-    wxMenu* CreatePopupMenu() override;
-    void OnLeftDClick(wxTaskBarIconEvent&);
-    wxDECLARE_EVENT_TABLE();
+    HistoryLock(const wxString& path, bool exclusive) {
+        m_file = CreateFileW(path.wc_str(), GENERIC_READ | GENERIC_WRITE,
+            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_ALWAYS,
+            FILE_ATTRIBUTE_NORMAL, NULL);
+        if (m_file == INVALID_HANDLE_VALUE) return;
+        OVERLAPPED ov = {};
+        m_locked = LockFileEx(m_file, exclusive ? LOCKFILE_EXCLUSIVE_LOCK : 0, 0, 1, 0, &ov) != 0;
+    }
+
+    ~HistoryLock() {
+        if (m_locked) {
+            OVERLAPPED ov = {};
+            UnlockFileEx(m_file, 0, 1, 0, &ov);
+        }
+        if (m_file != INVALID_HANDLE_VALUE) CloseHandle(m_file);
+    }
+
+    HistoryLock(const HistoryLock&) = delete;
+    HistoryLock& operator=(const HistoryLock&) = delete;
+
+    bool Ok() const { return m_locked; }
+
+private:
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    bool   m_locked = false;
+};
+
+class HistoryArchive {
+public:
+    // The user's archive, shared by the whole process.
+    static HistoryArchive& Get() {
+        static HistoryArchive arc(DataDir());
+        return arc;
+    }
+
+    // One under dataDir, e.g. a trace replay's scratch copy.
+    explicit HistoryArchive(const wxString& dataDir) : m_dir(Dir(dataDir)) {}
+
+    ~HistoryArchive() { Stop(); }
+
+    // Also packs anything a crashed run or another process left in the
+    // journal.
+    void Start() {
+        std::lock_guard<std::mutex> g(m_lock);
+        if (m_thread.joinable()) return;
+        m_quit = false;
+        m_dirty = true;
+        m_thread = std::thread([this] { Run(); });
+    }
+
+    // Packs whatever is still journaled, then joins.
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> g(m_lock);
+            m_quit = true;
+        }
+        m_wake.notify_one();
+        if (m_thread.joinable()) m_thread.join();
+    }
+
+    // Journals sessions for packing with one append; they are visible to
+    // Query from here on. False if nothing could be written.
+    bool Append(const std::vector<Session>& cold) {
+        if (cold.empty()) return true;
+        std::string batch;
+        for (auto& s : cold) HistJournal::Put(batch, ToHistRecord(s), false);
+        {
+            std::lock_guard<std::mutex> g(m_io);
+            HistoryLock lock(LockPath(), false);
+            if (!lock.Ok() || !AppendToFile(JournalPath(), batch)) return false;
+        }
+        Start();
+        {
+            std::lock_guard<std::mutex> g(m_lock);
+            m_dirty = true;
+        }
+        m_wake.notify_one();
+        return true;
+    }
+
+    // Called with each record that a merge actually added, i.e. one the
+    // segment didn't hold yet, once the segment is written.
+    typedef std::function<void(const HistRecord&)> AddedFn;
+
+    // Merges records straight into one month's segment, bypassing the
+    // journal. Safe to call from any thread or process.
+    bool AddMonth(const wxString& month, std::vector<HistRecord>& recs, const AddedFn& added = nullptr) {
+        std::lock_guard<std::mutex> g(m_io);
+        HistoryLock lock(LockPath(), true);
+        return lock.Ok() && PackMonth(month, recs, {}, added);
+    }
+
+    // Journals a tombstone for old and/or the record repl in one append,
+    // so an edit is never half applied. Either may be null.
+    bool Edit(const HistRecord* old, const HistRecord* repl) {
+        std::string batch;
+        if (old) HistJournal::Put(batch, *old, true);
+        if (repl) HistJournal::Put(batch, *repl, false);
+        if (batch.empty()) return true;
+        {
+            std::lock_guard<std::mutex> g(m_io);
+            HistoryLock lock(LockPath(), false);
+            if (!lock.Ok() || !AppendToFile(JournalPath(), batch)) return false;
+        }
+        Start();
+        {
+            std::lock_guard<std::mutex> g(m_lock);
+            m_dirty = true;
+        }
+        m_wake.notify_one();
+        return true;
+    }
+
+    // Packs the journal now, on the calling thread.
+    void Flush() { PackJournal(); }
+
+    // "YYYY-MM" names of the existing segments, and one segment's bytes.
+    std::vector<wxString> SegmentMonths() const { return Months(); }
+    bool ReadSegment(const wxString& month, std::string& raw) const {
+        std::lock_guard<std::mutex> g(m_io);
+        HistoryLock lock(LockPath(), false);
+        return ReadWholeFile(SegmentPath(month), raw);
+    }
+
+    // Segment key of a record: the local month of its end time.
+    static wxString MonthOf(const HistRecord& r) {
+        time_t t = (time_t)r.End();
+        std::tm tm = {};
+        localtime_s(&tm, &t);
+        return wxString::Format("%04d-%02d", tm.tm_year + 1900, tm.tm_mon + 1);
+    }
+
+    // Archived sessions overlapping [from, to), sorted by start.
+    std::vector<Session> Query(int64_t from, int64_t to) const {
+        PERF_SCOPE(kPerfHistoryQuery);
+        std::vector<HistRecord> recs;
+        {
+            std::lock_guard<std::mutex> g(m_io);
+            HistoryLock lock(LockPath(), false);
+            std::string raw;
+            HistSegment seg;
+            for (auto& m : Months()) {
+                if (MonthEnd(m) <= from) continue;
+                if (!ReadWholeFile(SegmentPath(m), raw) || !seg.Parse(raw)) continue;
+                for (auto& b : seg.blocks)
+                    if (b.maxEnd > from && b.minStart < to) seg.Decode(b, recs, from, to);
+            }
+            if (ReadWholeFile(JournalPath(), raw))
+                HistJournal::Parse(raw, [&](const HistRecord& r, bool tomb) {
+                    if (r.End() <= from || r.start >= to) return;
+                    if (!tomb) recs.push_back(r);
+                    else recs.erase(std::remove(recs.begin(), recs.end(), r), recs.end());
+                    });
+        }
+        // A record packed just before a crash can also still be journaled.
+        std::sort(recs.begin(), recs.end());
+        recs.erase(std::unique(recs.begin(), recs.end()), recs.end());
+
+        std::vector<Session> out;
+        out.reserve(recs.size());
+        for (auto& r : recs) out.push_back(ToSession(r));
+        return out;
+    }
+
+    // Calls fn(raw, seg) for every readable segment, oldest month first,
+    // after packing the journal so every record is in a segment. Only one
+    // segment is held in memory at a time.
+    template <class Fn>
+    void ForEachSegment(Fn fn) {
+        PackJournal();
+        std::lock_guard<std::mutex> g(m_io);
+        HistoryLock lock(LockPath(), false);
+        std::string raw;
+        HistSegment seg;
+        for (auto& m : Months())
+            if (ReadWholeFile(SegmentPath(m), raw) && seg.Parse(raw)) fn(raw, seg);
+    }
+
+    // Segment count, record count and packed size vs 16-byte fixed records.
+    wxString Report() {
+        size_t segs = 0;
+        uint64_t records = 0, packed = 0;
+        ForEachSegment([&](const std::string& raw, const HistSegment& seg) {
+            segs++;
+            records += seg.records;
+            packed += raw.size();
+            });
+        uint64_t fixed = records * 16;
+        return wxString::Format("%-26s %8llu segments, %llu sessions\n"
+            "%-26s %8llu bytes (fixed %llu, %.1fx)\n",
+            "history archive", (unsigned long long)segs, (unsigned long long)records,
+            "history packed", (unsigned long long)packed, (unsigned long long)fixed,
+            packed ? (double)fixed / packed : 0.0);
+    }
+
+private:
+    mutable std::mutex      m_lock;     // m_dirty, m_quit
+    mutable std::mutex      m_io;       // archive files, within this process
+    std::condition_variable m_wake;
+    std::thread             m_thread;
+    bool                    m_dirty = false;
+    bool                    m_quit = false;
+    const wxString          m_dir;
+
+    static wxString Dir(const wxString& dataDir) {
+        wxFileName fn(dataDir, wxEmptyString);
+        fn.AppendDir("history");
+        fn.Mkdir(wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+        return fn.GetPath();
+    }
+
+    wxString SegmentPath(const wxString& month) const {
+        return wxFileName(m_dir, month + ".seg").GetFullPath();
+    }
+    wxString JournalPath() const { return wxFileName(m_dir, "journal.wtj").GetFullPath(); }
+    wxString LockPath() const { return wxFileName(m_dir, "archive.lock").GetFullPath(); }
+
+    // "YYYY-MM" names of the existing segments.
+    std::vector<wxString> Months() const {
+        wxArrayString files;
+        wxDir::GetAllFiles(m_dir, &files, "*.seg", wxDIR_FILES);
+        std::vector<wxString> months;
+        for (auto& f : files) months.push_back(wxFileName(f).GetName());
+        std::sort(months.begin(), months.end());
+        return months;
+    }
+
+    static int64_t MonthEnd(const wxString& month) {
+        long y = 0, m = 0;
+        if (!month.BeforeFirst('-').ToLong(&y) || !month.AfterFirst('-').ToLong(&m) ||
+            m < 1 || m > 12) return std::numeric_limits<int64_t>::max();
+        wxDateTime d(1, (wxDateTime::Month)(m - 1), (int)y);
+        d += wxDateSpan::Month();
+        return (int64_t)d.GetTicks();
+    }
+
+    void Run() {
+        SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN);
+        std::unique_lock<std::mutex> lk(m_lock);
+        while (!m_quit) {
+            m_wake.wait(lk, [this] { return m_quit || m_dirty; });
+            m_dirty = false;
+            lk.unlock();
+            PackJournal();
+            lk.lock();
+        }
+        lk.unlock();
+        PackJournal();
+    }
+
+    // Folds the journal into its month segments and empties it. Records
+    // of a month that fails to pack stay journaled for the next run;
+    // segments dedupe, so packing a record twice is harmless.
+    void PackJournal() {
+        std::lock_guard<std::mutex> g(m_io);
+        HistoryLock lock(LockPath(), true);
+        std::string raw;
+        if (!lock.Ok() || !ReadWholeFile(JournalPath(), raw) || raw.empty()) return;
+
+        // Per month, the net effect in journal order: records to add and
+        // records to drop from the segment.
+        struct Ops { std::set<HistRecord> adds, tombs; };
+        std::map<wxString, Ops> byMonth;
+        HistJournal::Parse(raw, [&](const HistRecord& r, bool tomb) {
+            Ops& ops = byMonth[MonthOf(r)];
+            if (tomb) { ops.adds.erase(r); ops.tombs.insert(r); }
+            else { ops.tombs.erase(r); ops.adds.insert(r); }
+            });
+
+        std::string keep;
+        for (auto& m : byMonth) {
+            std::vector<HistRecord> month(m.second.adds.begin(), m.second.adds.end());
+            if (PackMonth(m.first, month, m.second.tombs)) continue;
+            for (auto& r : m.second.tombs) HistJournal::Put(keep, r, true);
+            for (auto& r : m.second.adds) HistJournal::Put(keep, r, false);
+        }
+        // Appenders need the shared lock, so nobody has the journal open.
+        if (keep.empty()) wxRemoveFile(JournalPath());
+        else WriteWholeFile(JournalPath(), keep);
+    }
+
+    // Merges recs into the month's segment minus the tombstoned records.
+    // Callers hold m_io and the exclusive HistoryLock.
+    bool PackMonth(const wxString& month, std::vector<HistRecord>& recs,
+        const std::set<HistRecord>& tombs, const AddedFn& added = nullptr) {
+        PERF_SCOPE(kPerfHistoryPack);
+        wxString path = SegmentPath(month);
+        std::string raw;
+        HistSegment seg;
+        size_t fresh = recs.size();
+        if (ReadWholeFile(path, raw)) {
+            bool ok = seg.Parse(raw);
+            for (size_t i = 0; ok && i < seg.blocks.size(); i++)
+                ok = seg.Decode(seg.blocks[i], recs,
+                    std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max());
+            // Keep an unreadable segment aside rather than overwrite it.
+            if (!ok && !wxRenameFile(path, path + ".bad", true)) return false;
+        }
+        if (!tombs.empty())
+            recs.erase(std::remove_if(recs.begin(), recs.end(),
+                [&](const HistRecord& r) { return tombs.count(r) > 0; }), recs.end());
+        if (recs.empty()) return !wxFileExists(path) || wxRemoveFile(path);
+        std::vector<HistRecord> news;
+        if (added) {
+            std::set<HistRecord> have(recs.begin() + std::min(fresh, recs.size()), recs.end());
+            for (size_t i = 0; i < fresh && i < recs.size(); i++)
+                if (have.insert(recs[i]).second) news.push_back(recs[i]);
+        }
+        if (!WriteWholeFile(path, HistSegment::Encode(recs))) return false;
+        for (auto& r : news) added(r);
+        return true;
+    }
+};
+
+// Interned app/source names for compact records. Lookups by UTF-8 bytes
+// don't allocate once a name is known.
+struct NameTable {
+    std::vector<std::wstring>                    names;
+    std::map<std::wstring, uint32_t>             ids;
+    std::map<std::string, uint32_t, std::less<>> utf8Ids;
+
+    uint32_t Intern(const std::wstring& s) {
+        auto it = ids.emplace(s, (uint32_t)names.size());
+        if (it.second) names.push_back(s);
+        return it.first->second;
+    }
+    uint32_t InternUtf8(std::string_view s) {
+        auto it = utf8Ids.find(s);
+        if (it != utf8Ids.end()) return it->second;
+        uint32_t id = Intern(wxString::FromUTF8(s.data(), s.size()).ToStdWstring());
+        utf8Ids.emplace(std::string(s), id);
+        return id;
+    }
 };
 
+// Unsigned decimal, at most 9 digits, nothing else.
+bool ParseDigits(std::string_view s, int& out) {
+    if (s.empty() || s.size() > 9) return false;
+    int v = 0;
+    for (char c : s) {
+        if (c < '0' || c > '9') return false;
+        v = v * 10 + (c - '0');
+    }
+    out = v;
+    return true;
+}
+
+// Local wall-clock time to epoch seconds, or -1. Thread-safe, unlike
+// going through wxDateTime's statics.
+int64_t LocalTicks(int y, int mo, int d, int h, int mi, int sec) {
+    std::tm tm = {};
+    tm.tm_year = y - 1900; tm.tm_mon = mo - 1; tm.tm_mday = d;
+    tm.tm_hour = h; tm.tm_min = mi; tm.tm_sec = sec; tm.tm_isdst = -1;
+    return (int64_t)mktime(&tm);
+}
+
+// Epoch seconds to local wall-clock seconds counted as if the zone were
+// UTC, so local days are exact multiples of 86400.
+int64_t LocalSeconds(int64_t epoch) {
+    time_t t = (time_t)epoch;
+    std::tm tm = {};
+    if (localtime_s(&tm, &t) != 0) return epoch;
+    return DaysFromCivil(tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday) * 86400 +
+        tm.tm_hour * 3600 + tm.tm_min * 60 + tm.tm_sec;
+}
+
 // =========================================
-// Add App Dialog
+// Log merge
 // =========================================
-class AddAppDialog : public wxDialog {
+// Offline import of logs copied from other machines: work_timer.ini files
+// and history\*.seg segments anywhere under a folder. Each file is parsed
+// on a worker thread into a sorted run of compact records. The runs are
+// k-way merged by start, overlapping intervals of the same source and app
+// are collapsed, and the result is packed into the history archive one
+// month at a time with a per-source tag.
+class LogMerge {
 public:
-    WorkApp result;
+    typedef MergeRec Rec;   // name ids: per run while parsing, global after
 
-    explicit AddAppDialog(wxWindow* parent)
-        : wxDialog(parent, wxID_ANY, "Add Work App",
-            wxDefaultPosition, wxSize(480, 520),
-            wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER)
-    {
-        SetBackgroundColour(CLR_BG);
-        auto* main = new wxBoxSizer(wxVERTICAL);
+    struct Result {
+        size_t files = 0;
+        size_t failed = 0;
+        size_t read = 0;        // sessions parsed
+        size_t merged = 0;      // sessions left after de-duplication
+        size_t sources = 0;
+    };
 
-        auto* lbl = new wxStaticText(this, wxID_ANY,
-            "Select a running process, or type an .exe name:");
-        lbl->SetForegroundColour(CLR_TEXT);
-        main->Add(lbl, 0, wxLEFT | wxTOP | wxRIGHT, 12);
+    static Result Run(const wxString& folder, const HistoryArchive::AddedFn& added = nullptr) {
+        PERF_SCOPE(kPerfLogMerge);
+        Result res;
+        wxArrayString files;
+        wxDir::GetAllFiles(folder, &files, "*.ini");
+        wxDir::GetAllFiles(folder, &files, "*.seg");
+        res.files = files.size();
+        if (files.empty()) return res;
 
-        auto* row = new wxBoxSizer(wxHORIZONTAL);
-        m_entry = new wxTextCtrl(this, wxID_ANY, wxEmptyString,
-            wxDefaultPosition, wxDefaultSize, wxTE_PROCESS_ENTER);
-        m_entry->SetBackgroundColour(CLR_PANEL);
-        m_entry->SetForegroundColour(*wxWHITE);
-        row->Add(m_entry, 1, wxEXPAND | wxRIGHT, 6);
+        std::vector<MergeRun> runs(files.size());
+        for (size_t i = 0; i < files.size(); i++) {
+            runs[i].path = files[i];
+            runs[i].source = SourceOf(files[i]);
+        }
+        ParseAll(runs);
 
-        auto* addBtn = new wxButton(this, wxID_ANY, "Add");
-        addBtn->SetBackgroundColour(CLR_RED);
-        addBtn->SetForegroundColour(*wxWHITE);
-        row->Add(addBtn, 0);
-        main->Add(row, 0, wxEXPAND | wxALL, 12);
+        // One name table for all runs, then remap the per-run ids into it.
+        std::vector<std::wstring> names;
+        std::map<std::wstring, uint32_t> ids;
+        for (auto& run : runs) {
+            if (!run.ok) { res.failed++; continue; }
+            std::vector<uint32_t> remap;
+            for (auto& n : run.names.names) {
+                auto it = ids.emplace(n, (uint32_t)names.size());
+                if (it.second) names.push_back(n);
+                remap.push_back(it.first->second);
+            }
+            for (auto& r : run.recs) {
+                r.app = remap[r.app];
+                r.src = remap[r.src];
+                r.cat = remap[r.cat];
+            }
+            res.read += run.recs.size();
+        }
 
-        auto* lbl2 = new wxStaticText(this, wxID_ANY,
-            "Running processes (double-click to select):");
-        lbl2->SetForegroundColour(CLR_DIM);
-        main->Add(lbl2, 0, wxLEFT | wxBOTTOM, 4);
+        std::vector<Rec> merged = Merge(runs, res.read);
+        runs.clear();
+        // Journaled records count as present when reporting what was added.
+        if (added) HistoryArchive::Get().Flush();
+        res.merged = merged.size();
+        std::set<uint32_t> srcs;
+        for (auto& r : merged) srcs.insert(r.src);
+        res.sources = srcs.size();
+        Pack(merged, names, added);
+        PERF_COUNT(kCtrImported, res.merged);
+        return res;
+    }
 
-        // Search bar
-        auto* searchRow = new wxBoxSizer(wxHORIZONTAL);
-        auto* searchLbl = new wxStaticText(this, wxID_ANY, "Search:");
-        searchLbl->SetForegroundColour(CLR_TEXT);
-        searchRow->Add(searchLbl, 0, wxALIGN_CENTER_VERTICAL | wxRIGHT, 6);
-        m_search = new wxTextCtrl(this, wxID_ANY);
-        m_search->SetBackgroundColour(CLR_PANEL);
-        m_search->SetForegroundColour(*wxWHITE);
-        searchRow->Add(m_search, 1);
-        main->Add(searchRow, 0, wxEXPAND | wxLEFT | wxRIGHT | wxBOTTOM, 8);
+    // Groups by end month (the segment key) and hands each month to the
+    // archive, so only one month is expanded to HistRecords at a time.
+    static void Pack(const std::vector<Rec>& recs, const std::vector<std::wstring>& names,
+        const HistoryArchive::AddedFn& added = nullptr) {
+        std::vector<std::pair<int, uint32_t>> order;     // yyyymm, index
+        order.reserve(recs.size());
+        int64_t lo = 1, hi = 0;
+        int key = 0;
+        for (uint32_t i = 0; i < recs.size(); i++) {
+            int64_t end = recs[i].start + recs[i].dur;
+            if (end < lo || end >= hi) {
+                wxDateTime d((time_t)end);
+                wxDateTime first(1, d.GetMonth(), d.GetYear());
+                key = d.GetYear() * 100 + d.GetMonth() + 1;
+                lo = (int64_t)first.GetTicks();
+                first += wxDateSpan::Month();
+                hi = (int64_t)first.GetTicks();
+            }
+            order.push_back({ key, i });
+        }
+        std::sort(order.begin(), order.end());
 
-        m_imgList = new wxImageList(16, 16, true);
-        m_list = new wxListCtrl(this, wxID_ANY, wxDefaultPosition, wxDefaultSize,
-            wxLC_REPORT | wxLC_SINGLE_SEL | wxBORDER_NONE);
-        m_list->SetBackgroundColour(CLR_PANEL);
-        m_list->SetForegroundColour(*wxWHITE);
-        m_list->SetTextColour(*wxWHITE);
-        m_list->SetImageList(m_imgList, wxIMAGE_LIST_SMALL);
-        m_list->InsertColumn(0, "Process", wxLIST_FORMAT_LEFT, 180);
-        m_list->InsertColumn(1, "Path", wxLIST_FORMAT_LEFT, 260);
-        main->Add(m_list, 1, wxEXPAND | wxLEFT | wxRIGHT | wxBOTTOM, 12);
+        std::vector<HistRecord> month;
+        for (size_t i = 0; i < order.size(); ) {
+            int k = order[i].first;
+            month.clear();
+            for (; i < order.size() && order[i].first == k; i++) {
+                const Rec& r = recs[order[i].second];
+                HistRecord h;
+                h.start = r.start;
+                h.dur = r.dur;
+                h.app = names[r.app];
+                h.source = names[r.src];
+                h.category = names[r.cat];
+                month.push_back(std::move(h));
+            }
+            HistoryArchive::Get().AddMonth(wxString::Format("%04d-%02d", k / 100, k % 100), month, added);
+        }
+    }
 
-        SetSizer(main);
+private:
+    struct MergeRun {
+        wxString         path;
+        std::wstring     source;    // tag for untagged records
+        NameTable        names;
+        std::vector<Rec> recs;
+        bool             ok = false;
+    };
 
-        // Fill process list
-        m_procs = GetRunningProcesses();
-        RebuildList(wxEmptyString);
+    // "D:\logs\laptop\work_timer.ini" and "D:\logs\laptop\history\2024-05.seg"
+    // are tagged "laptop"; "D:\logs\alice-desktop.ini" is "alice-desktop".
+    static std::wstring SourceOf(const wxString& path) {
+        wxFileName fn(path);
+        if (fn.GetExt() != "seg" && fn.GetName() != "work_timer")
+            return fn.GetName().ToStdWstring();
+        wxArrayString dirs = fn.GetDirs();
+        while (!dirs.empty() && (dirs.Last().CmpNoCase("history") == 0 ||
+            dirs.Last().CmpNoCase("WorkTimer") == 0))
+            dirs.RemoveAt(dirs.size() - 1);
+        return dirs.empty() ? fn.GetName().ToStdWstring() : dirs.Last().ToStdWstring();
+    }
 
-        // Search filter
-        m_search->Bind(wxEVT_TEXT, [this](wxCommandEvent&) {
-            RebuildList(m_search->GetValue().Lower());
-            });
+    static void ParseAll(std::vector<MergeRun>& runs) {
+        std::atomic<size_t> next{ 0 };
+        auto work = [&] {
+            std::string raw;
+            for (size_t i; (i = next++) < runs.size(); ) {
+                MergeRun& run = runs[i];
+                run.ok = ReadWholeFile(run.path, raw) &&
+                    (run.path.EndsWith(".seg") ? ParseSegment(raw, run) : ParseIni(raw, run));
+                std::sort(run.recs.begin(), run.recs.end(),
+                    [](const Rec& a, const Rec& b) { return a.start < b.start; });
+            }
+        };
+        size_t n = std::min<size_t>(runs.size(), std::max(1u, std::thread::hardware_concurrency()));
+        std::vector<std::thread> pool;
+        for (size_t t = 1; t < n; t++) pool.emplace_back(work);
+        work();
+        for (auto& t : pool) t.join();
+    }
 
-        m_list->Bind(wxEVT_LIST_ITEM_SELECTED, [this](wxListEvent& e) {
-            long itemIdx = e.GetIndex();
-            if (itemIdx >= 0 && itemIdx < m_list->GetItemCount()) {
-                wxListItem item;
-                item.SetId(itemIdx);
-                item.SetColumn(0);
-                item.SetMask(wxLIST_MASK_TEXT);
-                m_list->GetItem(item);
-                m_entry->SetValue(item.GetText());
+    static bool ParseSegment(const std::string& raw, MergeRun& run) {
+        HistSegment seg;
+        std::vector<HistRecord> recs;
+        if (!seg.Parse(raw)) return false;
+        for (auto& b : seg.blocks)
+            if (!seg.Decode(b, recs, std::numeric_limits<int64_t>::min(),
+                std::numeric_limits<int64_t>::max())) return false;
+        for (auto& r : recs)
+            run.recs.push_back({ r.start, r.dur, run.names.Intern(r.app),
+                run.names.Intern(r.source.empty() ? run.source : r.source),
+                run.names.Intern(r.category) });
+        return true;
+    }
+
+    // Reads the [sessions] group written by SaveConfig (s<N>_app, _dur,
+    // _date, _end, _cat) in place, without wxFileConfig or per-field strings.
+    static bool ParseIni(const std::string& raw, MergeRun& run) {
+        struct Row { std::string_view app, dur, date, end, cat; };
+        std::vector<Row> rows;
+        std::string_view text(raw);
+        if (text.substr(0, 3) == "\xEF\xBB\xBF") text.remove_prefix(3);
+        bool inSessions = false;
+        while (!text.empty()) {
+            size_t nl = text.find('\n');
+            std::string_view line = text.substr(0, nl);
+            text = nl == std::string_view::npos ? std::string_view() : text.substr(nl + 1);
+            while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) line.remove_suffix(1);
+            if (line.empty()) continue;
+            if (line.front() == '[') { inSessions = line == "[sessions]"; continue; }
+            size_t us = line.find('_'), eq = line.find('=');
+            if (!inSessions || line.front() != 's' || us == std::string_view::npos ||
+                eq == std::string_view::npos || us > eq) continue;
+            int idx = 0;
+            if (!ParseDigits(line.substr(1, us - 1), idx) || idx > 1000000) continue;
+            if (rows.size() <= (size_t)idx) rows.resize(idx + 1);
+            std::string_view key = line.substr(us + 1, eq - us - 1), val = line.substr(eq + 1);
+            Row& row = rows[idx];
+            if (key == "app") row.app = val;
+            else if (key == "dur") row.dur = val;
+            else if (key == "date") row.date = val;
+            else if (key == "end") row.end = val;
+            else if (key == "cat") row.cat = val;
+        }
+
+        uint32_t src = run.names.Intern(run.source);
+        for (auto& row : rows) {
+            int dur = 0, y = 0, mo = 0, d = 0, h = 0, mi = 0;
+            if (row.app.empty() || !ParseDigits(row.dur, dur) || row.date.size() != 10 ||
+                !ParseDigits(row.date.substr(0, 4), y) || !ParseDigits(row.date.substr(5, 2), mo) ||
+                !ParseDigits(row.date.substr(8, 2), d)) continue;
+            if (row.end.size() == 5) {
+                ParseDigits(row.end.substr(0, 2), h);
+                ParseDigits(row.end.substr(3, 2), mi);
+            }
+            int64_t end = LocalTicks(y, mo, d, h, mi, 0);
+            if (end < 0) continue;
+            run.recs.push_back({ end - dur, (uint32_t)dur, run.names.InternUtf8(row.app), src,
+                run.names.InternUtf8(row.cat) });
+        }
+        return true;
+    }
+
+    static std::vector<Rec> Merge(const std::vector<MergeRun>& runs, size_t total) {
+        std::vector<const std::vector<Rec>*> sorted;
+        for (auto& run : runs)
+            if (run.ok) sorted.push_back(&run.recs);
+        return MergeRuns(sorted, total);
+    }
+};
+
+// =========================================
+// History import / export
+// =========================================
+// Streams history to and from CSV or the binary interchange format through
+// fixed-size buffers. Export walks the archive one month segment at a
+// time. Import reads 64 KB chunks, tokenizes CSV in place and packs every
+// kBatch records into the archive.
+//
+// CSV: start,duration,app,source,category with start as local "YYYY-MM-DD HH:MM:SS"
+// (seconds optional, 'T' separator accepted). Any other extension is the
+// binary format: "WTHX" u32 version, then { u32 len, segment } chunks.
+class HistoryIO {
+public:
+    struct Result {
+        bool     ok = false;
+        size_t   sessions = 0;
+        size_t   skipped = 0;   // malformed CSV rows or binary chunks
+        size_t   hot = 0;       // already in the ini, left out of the archive
+        wxString error;
+    };
+
+    static bool IsCsv(const wxString& path) {
+        return wxFileName(path).GetExt().CmpNoCase("csv") == 0;
+    }
+
+    // Archived history followed by the hot (ini) sessions.
+    static Result Export(const wxString& path, const std::vector<Session>& hot) {
+        PERF_SCOPE(kPerfHistoryExport);
+        Result res;
+        wxFile f;
+        if (!f.Open(path, wxFile::write)) { res.error = "Could not write " + path; return res; }
+        bool csv = IsCsv(path);
+        Sink out(f);
+        if (csv) out.Put("start,duration,app,source,category\r\n");
+        else { out.U32(kMagic); out.U32(kVersion); }
+
+        std::vector<HistRecord> recs;
+        std::string utf8;
+        bool named = true;      // every name converted
+        HistoryArchive::Get().ForEachSegment([&](const std::string& raw, const HistSegment& seg) {
+            if (!csv) {
+                // Segments are already in the interchange encoding.
+                out.U32((uint32_t)raw.size());
+                out.Put(raw.data(), raw.size());
+                res.sessions += seg.records;
+                return;
+            }
+            for (auto& b : seg.blocks) {
+                recs.clear();
+                seg.Decode(b, recs, std::numeric_limits<int64_t>::min(),
+                    std::numeric_limits<int64_t>::max());
+                for (auto& r : recs) named = WriteRow(out, r, utf8) && named;
+                res.sessions += recs.size();
             }
             });
-        m_list->Bind(wxEVT_LIST_ITEM_ACTIVATED, [this](wxListEvent&) { OnAdd(); });
-        addBtn->Bind(wxEVT_BUTTON, [this](wxCommandEvent&) { OnAdd(); });
-        m_entry->Bind(wxEVT_TEXT_ENTER, [this](wxCommandEvent&) { OnAdd(); });
+
+        recs.clear();
+        for (auto& s : hot) recs.push_back(ToHistRecord(s));
+        if (!recs.empty()) {
+            if (csv) {
+                for (auto& r : recs) named = WriteRow(out, r, utf8) && named;
+            } else {
+                std::string chunk = HistSegment::Encode(recs);
+                out.U32((uint32_t)chunk.size());
+                out.Put(chunk.data(), chunk.size());
+            }
+            res.sessions += recs.size();
+        }
+        res.ok = out.Flush() && named;
+        if (!res.ok) res.error = named ? "Could not write " + path
+            : "Could not convert an app, source or category name to UTF-8";
+        return res;
     }
 
-    ~AddAppDialog() override {}
+    // Sessions matching one of the hot (ini) sessions are left out: Export
+    // writes those too, and the ini stays their owner until it rolls them
+    // into the archive.
+    static Result Import(const wxString& path, const std::vector<Session>& hot,
+        const HistoryArchive::AddedFn& added = nullptr) {
+        PERF_SCOPE(kPerfHistoryImport);
+        Result res;
+        wxFile f;
+        if (!wxFileExists(path) || !f.Open(path, wxFile::read)) {
+            res.error = "Could not read " + path;
+            return res;
+        }
+        if (added) HistoryArchive::Get().Flush();   // see LogMerge::Run
+        Batch batch;
+        batch.added = added;
+        for (auto& s : hot) batch.Exclude(ToHistRecord(s));
+        res.ok = IsCsv(path) ? ImportCsv(f, batch, res) : ImportBinary(f, batch, res);
+        batch.Flush();
+        res.sessions = batch.total;
+        res.hot = batch.excluded;
+        PERF_COUNT(kCtrImported, res.sessions);
+        return res;
+    }
 
 private:
-    wxTextCtrl* m_entry;
-    wxTextCtrl* m_search;
-    wxListCtrl* m_list;
-    wxImageList* m_imgList;
-    std::vector<ProcessInfo> m_procs;
-    std::map<wxString, int>  m_iconIndexCache;
+    static const uint32_t kMagic = 0x58485457;     // "WTHX"
+    static const uint32_t kVersion = 1;
+    static const size_t   kChunk = 64 * 1024;
+    static const size_t   kBatch = 64 * 1024;
+    static const uint32_t kMaxSegment = 64 * 1024 * 1024;
+    static const int      kCsvFields = 5;
 
-    void RebuildList(const wxString& filter) {
-        m_list->DeleteAllItems();
+    // Fixed-size write buffer over a wxFile.
+    class Sink {
+    public:
+        explicit Sink(wxFile& f) : m_f(f) {}
 
-        for (auto& p : m_procs) {
-            if (!filter.IsEmpty() && !p.exeName.Lower().Contains(filter)) continue;
+        void Put(const char* p, size_t n) {
+            if (m_n + n > kChunk) {
+                Flush();
+                if (n > kChunk) { m_ok = m_ok && m_f.Write(p, n) == n; return; }
+            }
+            memcpy(m_buf + m_n, p, n);
+            m_n += n;
+        }
+        void Put(const char* s) { Put(s, strlen(s)); }
+        void U32(uint32_t v) { Put((const char*)&v, 4); }
+
+        bool Flush() {
+            if (m_n) m_ok = m_ok && m_f.Write(m_buf, m_n) == m_n;
+            m_n = 0;
+            return m_ok;
+        }
+
+    private:
+        wxFile& m_f;
+        char    m_buf[kChunk];
+        size_t  m_n = 0;
+        bool    m_ok = true;
+    };
+
+    // Imported records waiting to be packed; flushed every kBatch.
+    struct Batch {
+        typedef std::tuple<int64_t, uint32_t, uint32_t, uint32_t, uint32_t> Key;
+
+        NameTable                  names;
+        std::vector<LogMerge::Rec> recs;
+        std::set<Key>              skip;
+        HistoryArchive::AddedFn    added;
+        size_t                     total = 0;
+        size_t                     excluded = 0;
+
+        Batch() { recs.reserve(kBatch); }
+
+        void Exclude(const HistRecord& r) {
+            skip.insert(Key(r.start, r.dur, names.Intern(r.app), names.Intern(r.source),
+                names.Intern(r.category)));
+        }
+
+        void Add(int64_t start, uint32_t dur, uint32_t app, uint32_t src, uint32_t cat) {
+            if (!skip.empty() && skip.count(Key(start, dur, app, src, cat))) {
+                excluded++;
+                return;
+            }
+            recs.push_back({ start, dur, app, src, cat });
+            if (recs.size() >= kBatch) Flush();
+        }
+        void Flush() {
+            if (recs.empty()) return;
+            total += recs.size();
+            LogMerge::Pack(recs, names.names, added);
+            recs.clear();
+        }
+    };
+
+    // False if a name couldn't be converted; the row is written anyway.
+    static bool WriteRow(Sink& out, const HistRecord& r, std::string& utf8) {
+        time_t t = (time_t)r.start;
+        std::tm tm = {};
+        localtime_s(&tm, &t);
+        char line[64];
+        int n = snprintf(line, sizeof(line), "%04d-%02d-%02d %02d:%02d:%02d,%u,",
+            tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+            tm.tm_hour, tm.tm_min, tm.tm_sec, r.dur);
+        out.Put(line, (size_t)n);
+        bool ok = PutField(out, r.app, utf8);
+        out.Put(",", 1);
+        ok = PutField(out, r.source, utf8) && ok;
+        out.Put(",", 1);
+        ok = PutField(out, r.category, utf8) && ok;
+        out.Put("\r\n", 2);
+        return ok;
+    }
+
+    // UTF-8, quoted only when it holds a separator or a quote. Names have
+    // no length limit, so utf8 is sized to fit; it keeps its capacity.
+    static bool PutField(Sink& out, const std::wstring& w, std::string& utf8) {
+        utf8.clear();
+        if (!w.empty()) {
+            int need = WideCharToMultiByte(CP_UTF8, 0, w.data(), (int)w.size(), NULL, 0, NULL, NULL);
+            if (need <= 0) return false;
+            utf8.resize((size_t)need);
+            if (WideCharToMultiByte(CP_UTF8, 0, w.data(), (int)w.size(),
+                &utf8[0], need, NULL, NULL) != need) return false;
+        }
+        std::string_view v(utf8);
+        if (v.find_first_of(",\"\r\n") == std::string_view::npos) { out.Put(v.data(), v.size()); return true; }
+        out.Put("\"", 1);
+        for (char c : v) {
+            if (c == '"') out.Put("\"", 1);
+            out.Put(&c, 1);
+        }
+        out.Put("\"", 1);
+        return true;
+    }
+
+    static bool ImportBinary(wxFile& f, Batch& batch, Result& res) {
+        uint32_t head[2] = {};
+        if (f.Read(head, 8) != 8 || head[0] != kMagic || head[1] != kVersion) {
+            res.error = "Not a WorkTimer history file";
+            return false;
+        }
+        std::string chunk;
+        std::vector<HistRecord> recs;
+        HistSegment seg;
+        for (;;) {
+            uint32_t len = 0;
+            ssize_t got = f.Read(&len, 4);
+            if (got == 0) return true;
+            chunk.resize(got == 4 && len <= kMaxSegment ? len : 0);
+            if (got != 4 || len > kMaxSegment || f.Read(&chunk[0], len) != (ssize_t)len) {
+                res.error = "Truncated history file";
+                return false;
+            }
+            if (!seg.Parse(chunk)) { res.skipped++; continue; }
+            for (auto& b : seg.blocks) {
+                recs.clear();
+                if (!seg.Decode(b, recs, std::numeric_limits<int64_t>::min(),
+                    std::numeric_limits<int64_t>::max())) res.skipped++;
+                for (auto& r : recs)
+                    batch.Add(r.start, r.dur, batch.names.Intern(r.app),
+                        batch.names.Intern(r.source), batch.names.Intern(r.category));
+            }
+        }
+    }
+
+    // Records through one kChunk buffer (core/csv.h).
+    static bool ImportCsv(wxFile& f, Batch& batch, Result& res) {
+        std::vector<char> buf(kChunk);
+        std::string scratch[kCsvFields];
+        bool first = true;
+        bool ok = CsvReadRecords(buf, [&](char* p, size_t n) { return f.Read(p, n); },
+            [&](std::string_view line) {
+                if (first) {
+                    if (line.substr(0, 3) == "\xEF\xBB\xBF") line.remove_prefix(3);
+                    first = false;
+                    if (line.substr(0, 5) == "start") return;
+                }
+                if (line.empty()) return;
+                if (!AddRow(line, scratch, batch)) res.skipped++;
+            });
+        if (!ok) res.error = "CSV record longer than 64 KB";
+        return ok;
+    }
+
+    static bool AddRow(std::string_view line, std::string* scratch, Batch& batch) {
+        std::string_view f[kCsvFields];
+        int n = CsvSplit(line, f, scratch, kCsvFields);
+        std::string_view t = f[0];
+        int y = 0, mo = 0, d = 0, h = 0, mi = 0, sec = 0, dur = 0;
+        if (n < 3 || t.size() < 16 || f[2].empty() ||
+            !ParseDigits(t.substr(0, 4), y) || !ParseDigits(t.substr(5, 2), mo) ||
+            !ParseDigits(t.substr(8, 2), d) || !ParseDigits(t.substr(11, 2), h) ||
+            !ParseDigits(t.substr(14, 2), mi) ||
+            (t.size() >= 19 && !ParseDigits(t.substr(17, 2), sec)) ||
+            !ParseDigits(f[1], dur)) return false;
+        int64_t start = LocalTicks(y, mo, d, h, mi, sec);
+        if (start < 0) return false;
+        batch.Add(start, (uint32_t)dur, batch.names.InternUtf8(f[2]),
+            batch.names.InternUtf8(n > 3 ? f[3] : std::string_view()),
+            batch.names.InternUtf8(n > 4 ? f[4] : std::string_view()));
+        return true;
+    }
+};
+
+// =========================================
+// Rules
+// =========================================
+// RuleTable (core/rule_table.h) works on std::wstring; config and the
+// rules dialog hold wxStrings.
+std::vector<std::wstring> RuleLines(const std::vector<wxString>& lines) {
+    std::vector<std::wstring> out;
+    out.reserve(lines.size());
+    for (auto& l : lines) out.push_back(l.ToStdWstring());
+    return out;
+}
+
+// =========================================
+// Alerts
+// =========================================
+// TimerWheel is in core/timer_wheel.h.
+//
+// Reminders from config, one per line:
+//   break 50m           every 50 min of timer time
+//   goal Code.exe 4h    once a day when that app's time today reaches 4 h
+//   budget 9h           once a day when today's total passes 9 h
+//   summary 18:00       once a day at 18:00 local time
+// The settings' colour alert is an implicit "break" line. Unknown lines
+// are ignored.
+//
+// Work-time alerts sit on a wheel clocked by tracked seconds; the summary
+// sits on one clocked by wall time. Nothing here reads a clock or
+// the tracker: callers pass times and state in, so a virtual clock can
+// drive it.
+class AlertScheduler {
+public:
+    enum Kind { kBreak, kGoal, kBudget, kSummary };
+
+    struct Alert {
+        Kind         kind = kBreak;
+        int          secs = 0;      // period, goal or budget; minute of day for summary
+        wxString     app;           // goal only, as written
+        std::wstring appKey;        // lower-case
+    };
+
+    // Tracker state the deadlines are computed from.
+    struct State {
+        int64_t        work = 0;        // tracked-seconds clock
+        int64_t        wall = 0;        // epoch seconds
+        int            elapsed = 0;     // timer value
+        int            today = 0;       // total tracked today
+        bool           running = false;
+        const wchar_t* appKey = L"";    // lower-case current app
+        int            appToday = 0;    // today's time in the current app
+    };
+
+    // Clears the fired-today set and disarms everything; follow with Sync().
+    void Configure(const std::vector<wxString>& lines, int breakMinutes) {
+        m_alerts.clear();
+        for (auto& l : lines) {
+            Alert a;
+            if (Parse(l, a)) m_alerts.push_back(a);
+        }
+        // Last, so toggling it doesn't renumber the persisted fired list.
+        if (breakMinutes > 0) {
+            Alert a;
+            a.secs = breakMinutes * 60;
+            m_alerts.push_back(a);
+        }
+        m_fired.assign(m_alerts.size(), false);
+        m_due.reserve(m_alerts.size());
+        m_work.Reserve(m_alerts.size());
+        m_wall.Reserve(m_alerts.size());
+    }
+
+    const std::vector<Alert>& Alerts() const { return m_alerts; }
+
+    // Re-arms every alert from scratch; call on start/stop/reset, config
+    // and day changes, not per tick.
+    void Sync(const State& st) {
+        m_work.Reset(st.work);
+        m_wall.Reset(st.wall);
+        for (uint32_t i = 0; i < m_alerts.size(); i++) {
+            const Alert& a = m_alerts[i];
+            if (m_fired[i]) continue;
+            switch (a.kind) {
+            case kBreak:
+                m_work.Add(i, st.work + a.secs - st.elapsed % a.secs);
+                break;
+            case kBudget:
+                m_work.Add(i, st.work + std::max(1, a.secs - st.today));
+                break;
+            case kGoal:
+                if (st.running && a.appKey == st.appKey)
+                    m_work.Add(i, st.work + std::max(1, a.secs - st.appToday));
+                break;
+            case kSummary:
+                m_wall.Add(i, NextTimeOfDay(st.wall, a.secs));
+                break;
+            }
+        }
+    }
+
+    // Advances both clocks. Returns the alerts that fell due (valid until
+    // the next call); breaks re-arm, the rest are done for the day.
+    const std::vector<uint32_t>& Advance(int64_t work, int64_t wall) {
+        m_due.clear();
+        m_work.Advance(work, m_due);
+        m_wall.Advance(wall, m_due);
+        for (uint32_t id : m_due) {
+            const Alert& a = m_alerts[id];
+            if (a.kind == kBreak) m_work.Add(id, work + a.secs);
+            else m_fired[id] = true;
+        }
+        return m_due;
+    }
+
+    // New day: once-a-day alerts may fire again. Follow with Sync().
+    void NewDay() { m_fired.assign(m_alerts.size(), false); }
+
+    // Persisted as "1,3" so a restart doesn't repeat today's alerts.
+    wxString FiredToday() const {
+        wxString out;
+        for (size_t i = 0; i < m_fired.size(); i++)
+            if (m_fired[i]) out += wxString::Format(out.IsEmpty() ? "%d" : ",%d", (int)i);
+        return out;
+    }
+
+    void SetFiredToday(const wxString& list) {
+        for (auto& part : wxSplit(list, ',')) {
+            long i = -1;
+            if (part.ToLong(&i) && i >= 0 && i < (long)m_fired.size()) m_fired[i] = true;
+        }
+    }
+
+private:
+    std::vector<Alert>    m_alerts;
+    std::vector<bool>     m_fired;
+    std::vector<uint32_t> m_due;
+    TimerWheel            m_work;
+    TimerWheel            m_wall;
+
+    // "90", "90s", "50m", "4h", "1h30m".
+    static bool ParseDuration(const wxString& s, int& secs) {
+        secs = 0;
+        long n = 0;
+        bool digits = false;
+        for (wchar_t c : s.ToStdWstring()) {
+            if (c >= '0' && c <= '9') { n = n * 10 + (c - '0'); digits = true; continue; }
+            int unit = c == 'h' ? 3600 : c == 'm' ? 60 : c == 's' ? 1 : 0;
+            if (!unit || !digits) return false;
+            secs += (int)n * unit;
+            n = 0;
+            digits = false;
+        }
+        secs += (int)n;
+        return secs > 0;
+    }
+
+    static bool Parse(const wxString& line, Alert& a) {
+        wxArrayString tok = wxSplit(line, ' ');
+        tok.erase(std::remove(tok.begin(), tok.end(), wxString()), tok.end());
+        if (tok.size() < 2) return false;
+        const wxString& kind = tok[0];
+        if (kind == "break" && tok.size() == 2) { a.kind = kBreak; return ParseDuration(tok[1], a.secs); }
+        if (kind == "budget" && tok.size() == 2) { a.kind = kBudget; return ParseDuration(tok[1], a.secs); }
+        if (kind == "goal" && tok.size() == 3) {
+            a.kind = kGoal;
+            a.app = tok[1];
+            a.appKey = tok[1].Lower().ToStdWstring();
+            return ParseDuration(tok[2], a.secs);
+        }
+        if (kind == "summary" && tok.size() == 2) {
+            long h = 0, m = 0;
+            a.kind = kSummary;
+            if (!tok[1].BeforeFirst(':').ToLong(&h) || !tok[1].AfterFirst(':').ToLong(&m) ||
+                h < 0 || h > 23 || m < 0 || m > 59) return false;
+            a.secs = (int)(h * 60 + m);
+            return true;
+        }
+        return false;
+    }
+
+    // Next local time minuteOfDay strictly after wall.
+    static int64_t NextTimeOfDay(int64_t wall, int minuteOfDay) {
+        time_t t = (time_t)wall;
+        std::tm tm = {};
+        localtime_s(&tm, &t);
+        for (int day = 0; day < 2; day++) {
+            int64_t at = LocalTicks(tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday + day,
+                minuteOfDay / 60, minuteOfDay % 60, 0);
+            if (at > wall) return at;
+        }
+        return wall + 24 * 3600;
+    }
+};
+
+// =========================================
+// Timeline
+// =========================================
+// "2024-05-03 14:20" for local seconds.
+wxString FormatLocal(int64_t t) {
+    int y, m, d;
+    CivilFromDays(FloorDiv(t, 86400), y, m, d);
+    int64_t s = t - FloorDiv(t, 86400) * 86400;
+    return wxString::Format("%04d-%02d-%02d %02d:%02d", y, m, d, (int)(s / 3600), (int)(s % 3600 / 60));
+}
+
+// =========================================
+// Session index
+// =========================================
+// Row access for the session browser without materialising the rows.
+// Per segment block it keeps the start range and a count per app, so row
+// counts under a filter and sort come from block counts and prefix sums;
+// only blocks straddling a date bound are scanned. Fetching a row decodes
+// one block, and the last few segments and blocks stay cached. The hot
+// (ini) sessions are indexed as one more, in-memory segment.
+//
+// Blocks of one segment never interleave, but blocks of different ones
+// can (a session filed under its end month, the hot sessions). Blocks
+// whose start ranges overlap form a cluster whose rows are k-way merged
+// by start when one of them is fetched; everywhere else a cluster is a
+// single block.
+class SessionIndex {
+public:
+    enum Sort { kByDate, kByApp };
+
+    struct Filter {
+        int     app = -1;   // into Apps(), -1 = all
+        int64_t from = std::numeric_limits<int64_t>::min();     // on start
+        int64_t to = std::numeric_limits<int64_t>::max();
+    };
+
+    // Indexes every segment, after packing the journal, plus hot.
+    void Build(const std::vector<Session>& hot) {
+        HistoryArchive::Get().Flush();
+        m_segs.clear();
+        for (auto& m : HistoryArchive::Get().SegmentMonths()) LoadMonth(m);
+        LoadHot(hot);
+        Relink();
+    }
+
+    // Re-reads the given months and hot after an edit.
+    void Refresh(const std::set<wxString>& months, const std::vector<Session>& hot) {
+        HistoryArchive::Get().Flush();
+        for (auto& m : months) {
+            m_segs.erase(std::remove_if(m_segs.begin(), m_segs.end(),
+                [&](const Seg& s) { return s.month == m; }), m_segs.end());
+            LoadMonth(m);
+        }
+        LoadHot(hot);
+        Relink();
+    }
+
+    const std::vector<std::wstring>& Apps() const { return m_apps; }
+
+    // Applies a filter and order; returns the number of rows.
+    size_t Select(const Filter& f, Sort sort, bool desc) {
+        m_filter = f;
+        m_desc = desc;
+        m_runs.clear();
+        m_mergedCluster = kNone;
+        Cluster();
+
+        std::vector<std::vector<Run>> byApp(sort == kByApp ? m_apps.size() : 0);
+        std::vector<std::pair<uint32_t, uint32_t>> counts;     // global app, count
+        std::map<uint32_t, uint32_t> sum;
+        for (uint32_t ci = 0; ci + 1 < m_clusterAt.size(); ci++) {
+            sum.clear();
+            for (uint32_t o = m_clusterAt[ci]; o < m_clusterAt[ci + 1]; o++) {
+                BlockCounts(m_order[o].first, m_order[o].second, counts);
+                for (auto& c : counts) sum[c.first] += c.second;
+            }
+            for (auto& c : sum) {
+                if (!c.second || (f.app >= 0 && (int)c.first != f.app)) continue;
+                Run run = { ci, sort == kByApp || f.app >= 0 ? (int)c.first : -1, c.second };
+                if (sort == kByApp) { byApp[c.first].push_back(run); continue; }
+                if (!m_runs.empty() && m_runs.back().cluster == ci)
+                    m_runs.back().count += c.second;
+                else m_runs.push_back(run);
+            }
+        }
+        for (auto& runs : byApp) m_runs.insert(m_runs.end(), runs.begin(), runs.end());
+        if (desc) std::reverse(m_runs.begin(), m_runs.end());
+
+        m_prefix.assign(1, 0);
+        for (auto& r : m_runs) m_prefix.push_back(m_prefix.back() + r.count);
+        return (size_t)m_prefix.back();
+    }
+
+    // Row i of the last Select().
+    bool Row(size_t i, HistRecord& out) {
+        if (i >= m_prefix.back()) return false;
+        size_t ri = std::upper_bound(m_prefix.begin(), m_prefix.end(), (uint64_t)i) - m_prefix.begin() - 1;
+        const Run& run = m_runs[ri];
+        uint32_t k = (uint32_t)(i - m_prefix[ri]);
+        if (m_desc) k = run.count - 1 - k;
+        const std::vector<std::pair<HistRecord, uint32_t>>* recs = Rows(run.cluster);
+        if (!recs) return false;
+        for (auto& e : *recs) {
+            if (!Match(e.first.start, e.second, run.app)) continue;
+            if (k-- == 0) { out = e.first; return true; }
+        }
+        return false;
+    }
+
+private:
+    struct Seg {
+        wxString    month;      // empty for the hot sessions
+        HistSegment seg;        // blocks and name tables; payload not kept
+        std::vector<uint32_t> global;   // local app id -> Apps() index
+        std::vector<uint32_t> countAt;  // per block, offset into counts
+        std::vector<std::pair<uint32_t, uint32_t>> counts;  // local app, count
+        std::vector<int64_t>  maxStart; // per block
+    };
+
+    struct Run {
+        uint32_t cluster;
+        int      app;       // global, or -1 for any
+        uint32_t count;
+    };
+
+    static const uint32_t kNone = ~0u;
+
+    struct Decoded {
+        uint32_t seg = 0, block = 0;
+        uint64_t used = 0;
+        std::vector<std::pair<HistRecord, uint32_t>> recs;  // with global app
+    };
+
+    std::vector<Seg>          m_segs;
+    std::vector<std::wstring> m_apps;       // sorted
+    Filter                    m_filter;
+    bool                      m_desc = false;
+    std::vector<Run>          m_runs;
+    std::vector<uint64_t>     m_prefix = { 0 };
+    std::vector<std::pair<uint32_t, uint32_t>> m_order;     // seg, block by minStart
+    std::vector<uint32_t>     m_clusterAt;  // cluster i is m_order[at[i], at[i + 1])
+    uint32_t                  m_mergedCluster = kNone;
+    std::vector<std::pair<HistRecord, uint32_t>> m_merged;  // rows of m_mergedCluster
+    Decoded                   m_cache[8];
+    uint64_t                  m_clock = 0;
+    std::string               m_hotRaw;
+    HistSegment               m_hotSeg;
+    wxString                  m_rawMonth;   // last archive segment read
+    std::string               m_raw;
+    HistSegment               m_rawSeg;
+
+    bool Match(int64_t start, uint32_t app, int runApp) const {
+        return start >= m_filter.from && start < m_filter.to && (runApp < 0 || (int)app == runApp);
+    }
+
+    // Per-block app counts from one pass over the block; the payload
+    // itself isn't kept.
+    static bool Count(Seg& s) {
+        s.countAt.clear();
+        s.counts.clear();
+        s.maxStart.clear();
+        std::map<uint32_t, uint32_t> n;
+        for (auto& b : s.seg.blocks) {
+            n.clear();
+            int64_t last = b.minStart;
+            if (!s.seg.Scan(b, [&](int64_t start, uint32_t, uint32_t app, uint32_t, uint32_t) {
+                n[app]++;
+                last = start;
+                return true;
+                })) return false;
+            s.countAt.push_back((uint32_t)s.counts.size());
+            s.counts.insert(s.counts.end(), n.begin(), n.end());
+            s.maxStart.push_back(last);
+        }
+        s.countAt.push_back((uint32_t)s.counts.size());
+        return true;
+    }
+
+    void LoadMonth(const wxString& month) {
+        Seg s;
+        s.month = month;
+        std::string raw;
+        if (!HistoryArchive::Get().ReadSegment(month, raw) || !s.seg.Parse(raw) || !Count(s)) return;
+        s.seg.payload = nullptr;
+        m_segs.push_back(std::move(s));
+    }
+
+    void LoadHot(const std::vector<Session>& hot) {
+        m_segs.erase(std::remove_if(m_segs.begin(), m_segs.end(),
+            [](const Seg& s) { return s.month.IsEmpty(); }), m_segs.end());
+        std::vector<HistRecord> recs;
+        for (auto& s : hot) recs.push_back(ToHistRecord(s));
+        m_hotRaw = HistSegment::Encode(recs);
+        Seg s;
+        if (!m_hotSeg.Parse(m_hotRaw)) return;
+        s.seg = m_hotSeg;
+        if (!Count(s)) return;
+        s.seg.payload = nullptr;
+        m_segs.push_back(std::move(s));
+    }
+
+    // Rebuilds the global app table after segments changed.
+    void Relink() {
+        std::set<std::wstring> names;
+        for (auto& s : m_segs) names.insert(s.seg.apps.begin(), s.seg.apps.end());
+        m_apps.assign(names.begin(), names.end());
+        for (auto& s : m_segs) {
+            s.global.clear();
+            for (auto& a : s.seg.apps)
+                s.global.push_back((uint32_t)(std::lower_bound(m_apps.begin(), m_apps.end(), a) - m_apps.begin()));
+        }
+        for (auto& c : m_cache) c = Decoded();
+        m_rawMonth.clear();
+        m_runs.clear();
+        m_prefix.assign(1, 0);
+        m_mergedCluster = kNone;
+    }
+
+    // Orders all blocks by start and groups those whose start ranges
+    // overlap. Consecutive blocks of one segment never do.
+    void Cluster() {
+        m_order.clear();
+        m_clusterAt.clear();
+        std::vector<std::pair<int64_t, std::pair<uint32_t, uint32_t>>> order;
+        for (uint32_t si = 0; si < m_segs.size(); si++)
+            for (uint32_t b = 0; b < m_segs[si].seg.blocks.size(); b++)
+                order.push_back({ m_segs[si].seg.blocks[b].minStart, { si, b } });
+        std::sort(order.begin(), order.end());
+        int64_t reach = std::numeric_limits<int64_t>::min();
+        for (auto& o : order) {
+            if (m_clusterAt.empty() || o.first >= reach) m_clusterAt.push_back((uint32_t)m_order.size());
+            reach = std::max(reach, m_segs[o.second.first].maxStart[o.second.second]);
+            m_order.push_back(o.second);
+        }
+        m_clusterAt.push_back((uint32_t)m_order.size());
+    }
+
+    // Rows of a cluster in start order. A lone block is returned from the
+    // block cache; overlapping blocks are k-way merged once and kept until
+    // another cluster is fetched.
+    const std::vector<std::pair<HistRecord, uint32_t>>* Rows(uint32_t ci) {
+        uint32_t first = m_clusterAt[ci], last = m_clusterAt[ci + 1];
+        if (last - first == 1) {
+            const Decoded* d = Block(m_order[first].first, m_order[first].second);
+            return d ? &d->recs : nullptr;
+        }
+        if (m_mergedCluster == ci) return &m_merged;
+        m_mergedCluster = kNone;
+        std::vector<std::vector<std::pair<HistRecord, uint32_t>>> parts;
+        size_t total = 0;
+        for (uint32_t o = first; o < last; o++) {
+            const Decoded* d = Block(m_order[o].first, m_order[o].second);
+            if (!d) return nullptr;
+            parts.push_back(d->recs);   // copied: the cache may evict it
+            total += d->recs.size();
+        }
+        // Ties keep segment order, so a re-fetch sees the same rows.
+        typedef std::pair<std::pair<int64_t, uint32_t>, size_t> Head;  // (start, part), pos
+        std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heap;
+        for (uint32_t p = 0; p < parts.size(); p++)
+            if (!parts[p].empty()) heap.push({ { parts[p][0].first.start, p }, 0 });
+        m_merged.clear();
+        m_merged.reserve(total);
+        while (!heap.empty()) {
+            Head h = heap.top();
+            heap.pop();
+            auto& part = parts[h.first.second];
+            m_merged.push_back(std::move(part[h.second]));
+            if (++h.second < part.size()) heap.push({ { part[h.second].first.start, h.first.second }, h.second });
+        }
+        m_mergedCluster = ci;
+        return &m_merged;
+    }
+
+    // Global-app counts of block b within the filter's date range. Only
+    // blocks straddling a bound are decoded.
+    void BlockCounts(uint32_t si, uint32_t b, std::vector<std::pair<uint32_t, uint32_t>>& out) {
+        out.clear();
+        const Seg& s = m_segs[si];
+        const HistBlock& hb = s.seg.blocks[b];
+        if (hb.minStart >= m_filter.to || hb.maxEnd <= m_filter.from) return;
+        if (hb.minStart >= m_filter.from && hb.maxEnd <= m_filter.to) {
+            for (uint32_t i = s.countAt[b]; i < s.countAt[b + 1]; i++)
+                out.push_back({ s.global[s.counts[i].first], s.counts[i].second });
+            return;
+        }
+        const Decoded* d = Block(si, b);
+        if (!d) return;
+        std::map<uint32_t, uint32_t> n;
+        for (auto& e : d->recs)
+            if (Match(e.first.start, e.second, -1)) n[e.second]++;
+        out.assign(n.begin(), n.end());
+    }
+
+    const Decoded* Block(uint32_t si, uint32_t b) {
+        Decoded* lru = &m_cache[0];
+        for (auto& c : m_cache) {
+            if (c.used && c.seg == si && c.block == b) { c.used = ++m_clock; return &c; }
+            if (c.used < lru->used) lru = &c;
+        }
+        const Seg& s = m_segs[si];
+        const HistSegment* seg = &m_hotSeg;
+        if (!s.month.IsEmpty()) {
+            if (m_rawMonth != s.month) {
+                m_rawMonth.clear();
+                // Another process may have repacked it since indexing.
+                if (!HistoryArchive::Get().ReadSegment(s.month, m_raw) || !m_rawSeg.Parse(m_raw) ||
+                    m_rawSeg.apps != s.seg.apps || m_rawSeg.blocks.size() != s.seg.blocks.size())
+                    return nullptr;
+                m_rawMonth = s.month;
+            }
+            seg = &m_rawSeg;
+        }
+        lru->used = 0;
+        lru->recs.clear();
+        bool ok = seg->Scan(seg->blocks[b],
+            [&](int64_t start, uint32_t dur, uint32_t app, uint32_t src, uint32_t cat) {
+                HistRecord r;
+                r.start = start;
+                r.dur = dur;
+                r.app = seg->apps[app];
+                r.source = seg->sources[src];
+                r.category = seg->categories[cat];
+                lru->recs.push_back({ std::move(r), s.global[app] });
+                return true;
+            });
+        if (!ok) return nullptr;
+        lru->seg = si;
+        lru->block = b;
+        lru->used = ++m_clock;
+        return lru;
+    }
+};
+
+// =========================================
+// Idle log
+// =========================================
+// Input gaps that cut a tracked session short. Fixed 12-byte records
+// (i64 epoch start, u32 seconds) appended to idle.bin; nothing reads it
+// on the sampling path.
+class IdleLog {
+public:
+    static wxString Path(const wxString& dir) { return wxFileName(dir, "idle.bin").GetFullPath(); }
+
+    static bool Append(int64_t start, uint32_t secs, const wxString& dir = DataDir()) {
+        ByteWriter w;
+        w.U64((uint64_t)start);
+        w.U32(secs);
+        return AppendToFile(Path(dir), w.buf);
+    }
+
+    // Idle seconds overlapping [from, to); gaps gets how many overlapped.
+    static int64_t Total(int64_t from, int64_t to, int* gaps = nullptr, const wxString& dir = DataDir()) {
+        std::string raw;
+        int64_t secs = 0;
+        int n = 0;
+        if (ReadWholeFile(Path(dir), raw)) {
+            // A torn last record is dropped.
+            ByteReader r(raw.data(), raw.size() / kRecord * kRecord);
+            while (!r.AtEnd()) {
+                int64_t start = (int64_t)r.U64();
+                int64_t end = start + r.U32();
+                if (end <= from || start >= to) continue;
+                secs += std::min(end, to) - std::max(start, from);
+                n++;
+            }
+        }
+        if (gaps) *gaps = n;
+        return secs;
+    }
+
+private:
+    static const size_t kRecord = 12;
+};
+
+// =========================================
+// Tracker
+// =========================================
+// Wall-clock source for Tracker; a trace replay drives a virtual one.
+class Clock {
+public:
+    virtual int64_t Now() = 0;      // epoch seconds
+
+protected:
+    ~Clock() = default;
+};
+
+class SystemClock : public Clock {
+public:
+    int64_t Now() override { return (int64_t)time(nullptr); }
+};
+
+inline Clock& SystemTime() {
+    static SystemClock clock;
+    return clock;
+}
+
+// Window-free tracking core: foreground matching, elapsed counting and
+// session persistence. Shared by MainFrame, the --headless host and the
+// trace replayer.
+class Tracker {
+public:
+    enum Change { kNone, kStarted, kStopped };
+
+    // The user's data directory and archive.
+    Tracker() : m_dir(DataDir()), m_arc(HistoryArchive::Get()) {}
+
+    // Keeps the ini, idle log and archive under dataDir instead.
+    Tracker(const wxString& dataDir, HistoryArchive& arc) : m_dir(dataDir), m_arc(arc) {}
+
+    AppConfig            cfg;
+    std::vector<Session> sessions;
+    int      elapsed = 0;
+    bool     running = false;
+    wxString curApp;
+    wxString curCategory;
+
+    // Every date and time the tracker uses comes from clock. Set before Load().
+    void SetClock(Clock& clock) { m_clock = &clock; }
+
+    void Load() {
+        cfg = LoadConfig(sessions, m_dir);
+        if (cfg.perfEnabled) PerfEnable(true);
+        wxString today = Now().FormatISODate();
+        if (cfg.lastDate != today) {
+            cfg.todayTotal = 0;
+            cfg.lastDate = today;
+            cfg.alertsFired.clear();
+        }
+        m_day = LocalNow().tm_mday;
+        ConfigChanged();
+    }
+
+    void Save() {
+        ArchiveCold();
+        SaveConfig(cfg, sessions, m_dir);
+    }
+
+    // Sessions overlapping [from, to): archived months plus the hot list.
+    std::vector<Session> History(int64_t from, int64_t to) const {
+        std::vector<Session> out = m_arc.Query(from, to);
+        for (auto& s : sessions) {
+            HistRecord r = ToHistRecord(s);
+            if (r.End() > from && r.start < to) out.push_back(s);
+        }
+        return out;
+    }
+
+    // Advances one second, running or not, and rolls the day over at local
+    // midnight. Returns the indices into Alerts().Alerts() that fell due;
+    // valid until the next call.
+    const std::vector<uint32_t>& Tick() {
+        if (running) {
+            elapsed++;
+            cfg.todayTotal++;
+            m_workClock++;
+        }
+        int day = LocalNow().tm_mday;
+        if (day != m_day) NewDay(day);
+
+        const std::vector<uint32_t>& due = m_alerts.Advance(m_workClock, m_clock->Now());
+        for (uint32_t id : due) {
+            if (m_alerts.Alerts()[id].kind == AlertScheduler::kBreak) continue;
+            // Once-a-day alert: persist so a restart doesn't repeat it.
+            cfg.alertsFired = m_alerts.FiredToday();
+            Save();
+            break;
+        }
+        return due;
+    }
+
+    const AlertScheduler& Alerts() const { return m_alerts; }
+
+    // Bucket totals over all history: built on first use, then kept
+    // current as sessions close, are edited or are imported.
+    const BucketPyramid& Timeline() {
+        if (!m_timelineOk) BuildTimeline();
+        return m_timeline;
+    }
+
+    // Moves one session's time in the timeline: old comes out, repl goes
+    // in. Either may be null. Nothing to do before the first build.
+    void TimelineEdit(const HistRecord* old, const HistRecord* repl) {
+        if (!m_timelineOk) return;
+        if (old) m_timeline.Remove(LocalSeconds(old->start), old->dur);
+        if (repl) m_timeline.Add(LocalSeconds(repl->start), repl->dur);
+    }
+
+    // Replaces old with repl; either may be null for an add or a delete.
+    // Split as in ArchiveCold (see PlanSessionEdit): only the archived
+    // side is journaled; this month's rows change with the ini, which
+    // Save() rewrites whole. stored gets repl as it was saved (the ini
+    // keeps end times to the minute), which is what an undo must pass
+    // back. False if nothing was written.
+    bool EditSession(const HistRecord* old, const HistRecord* repl, HistRecord* stored = nullptr) {
+        Session next;
+        if (repl) next = ToSession(*repl);
+        SessionEditPlan plan = PlanSessionEdit(sessions.size(),
+            [&](size_t i) { return ToHistRecord(sessions[i]); },
+            old, repl, repl && next.date.Left(7) == Now().Format("%Y-%m"));
+        if (!m_arc.Edit(plan.archiveOld, plan.archiveNew)) return false;
+
+        // todayTotal counts this machine's time only.
+        if (old && old->source.empty() && ToSession(*old).date == cfg.lastDate)
+            cfg.todayTotal = std::max(0, cfg.todayTotal - (int)old->dur);
+        if (repl && repl->source.empty() && next.date == cfg.lastDate)
+            cfg.todayTotal += (int)repl->dur;
+        if (plan.hotOld >= 0) sessions.erase(sessions.begin() + plan.hotOld);
+        if (plan.hotNew) {
+            auto at = std::upper_bound(sessions.begin(), sessions.end(), next,
+                [](const Session& a, const Session& b) {
+                    return a.date + a.endTime < b.date + b.endTime;
+                });
+            sessions.insert(at, next);
+        }
+        HistRecord saved = repl ? (plan.hotNew ? ToHistRecord(next) : *repl) : HistRecord();
+        if (repl && stored) *stored = saved;
+        TimelineEdit(old, repl ? &saved : nullptr);
+        Save();
+        SyncAlerts();
+        return true;
+    }
+
+    // Today's tracked time in appName, including the open session.
+    int AppToday(const wxString& appName) const {
+        int secs = running && curApp == appName ? elapsed - m_startElapsed : 0;
+        for (auto& s : sessions)
+            if (s.date == cfg.lastDate && s.appName == appName && s.source.IsEmpty()) secs += s.duration;
+        return secs;
+    }
+
+    // Rebuilds the interned match keys, recompiles the rules and re-arms
+    // the alerts; call after editing cfg.workApps, cfg.rules, cfg.alerts or
+    // the color alert. Bad rules leave the table empty.
+    void ConfigChanged() {
+        m_keys.clear();
+        for (auto& a : cfg.workApps) {
+            std::wstring k(a.exeName.wc_str());
+            for (auto& c : k) c = (wchar_t)towlower(c);
+            m_keys.push_back(k);
+        }
+        m_rules.Compile(RuleLines(cfg.rules), nullptr);
+        m_alerts.Configure(cfg.alerts, cfg.colorAlert ? cfg.alertMinutes : 0);
+        m_alerts.SetFiredToday(cfg.alertsFired);
+        SyncAlerts();
+    }
+
+    // Index into cfg.workApps, or -1. Allocation-free.
+    int Match(const wchar_t* exe) {
+        size_t n = 0;
+        for (; exe[n] && n < MAX_PATH - 1; n++) m_lower[n] = (wchar_t)towlower(exe[n]);
+        m_lower[n] = 0;
+        for (size_t i = 0; i < m_keys.size(); i++)
+            if (m_keys[i].size() == n && wcscmp(m_keys[i].c_str(), m_lower) == 0) return (int)i;
+        return -1;
+    }
+
+    // input, when given, pauses tracking after cfg.idleMinutes without
+    // keyboard or mouse input: the session is closed back at the last
+    // input, as are any a focus change closed since, and the next one
+    // starts when input resumes.
+    Change Sample(const wchar_t* active, TitleSource* title = nullptr, InputSource* input = nullptr) {
+        PERF_COUNT(kCtrSamples, 1);
+        if (input && cfg.idleMinutes > 0) {
+            int idle = (int)(input->IdleMs() / 1000);
+            int64_t now = m_clock->Now();
+            m_gap.Input(now, idle);
+            bool away = idle >= cfg.idleMinutes * 60;
+            if (away && Idle()) return kNone;
+            if (away && m_gap.Pending()) {
+                TrimGap();
+                if (!running) {
+                    m_idleSince = m_gap.LastInput();
+                    return kStopped;
+                }
+            }
+            if (away && running && !curApp.IsEmpty()) {
+                TRACE_INSTANT("foreground: idle", (const char*)curApp.utf8_str());
+                Stop(idle);
+                m_idleSince = now - idle;
+                return kStopped;
+            }
+            if (Idle()) EndIdle(now - idle);
+        }
+        if (!active || !*active) return kNone;
+
+        int id = Match(active);
+        int cat = -1;
+        bool track = Classify(id, title, cat);
+        if (track && running && !curApp.IsEmpty() && cat != m_curCat) {
+            // Category boundary: close this session and open the next below.
+            TRACE_INSTANT("foreground: category", (const char*)curCategory.utf8_str());
+            Stop();
+        }
+        if (track && !running) {
+            wxString matched = id >= 0 ? cfg.workApps[id].exeName : wxString(active);
+            TRACE_INSTANT("foreground: start", (const char*)matched.utf8_str());
+            Start(matched, cat);
+            return kStarted;
+        }
+        if (!track && running && !curApp.IsEmpty()) {
+            TRACE_INSTANT("foreground: stop", (const char*)wxString(active).utf8_str());
+            Stop();
+            return kStopped;
+        }
+        return kNone;
+    }
+
+    // cat is a rule category index, or -1 for none.
+    void Start(const wxString& appName = wxEmptyString, int cat = -1) {
+        running = true;
+        curApp = appName;
+        curCategory = cat >= 0 ? wxString(m_rules.Category(cat)) : wxString();
+        m_curCat = cat;
+        m_startElapsed = elapsed;
+        SyncAlerts();
+    }
+
+    // trim takes the last seconds back off the session, e.g. time spent
+    // idle. The alert work clock keeps them; its wheels only run forward.
+    void Stop(int trim = 0) {
+        bool was = running;
+        running = false;
+        if (Idle()) EndIdle(m_clock->Now());
+        trim = was ? std::min(trim, elapsed - m_startElapsed) : 0;
+        if (trim > 0) {
+            elapsed -= trim;
+            cfg.todayTotal = std::max(0, cfg.todayTotal - trim);
+        }
+        if (was && elapsed > m_startElapsed) {
+            Session s;
+            s.appName = curApp.IsEmpty() ? "Manual" : curApp;
+            s.duration = elapsed - m_startElapsed;
+            s.category = curCategory;
+            wxDateTime now((time_t)(m_clock->Now() - trim));
+            s.date = now.FormatISODate();
+            s.endTime = now.Format("%H:%M");
+            sessions.push_back(s);
+            if (m_timelineOk) {
+                HistRecord r = ToHistRecord(s);
+                m_timeline.Add(LocalSeconds(r.start), r.dur);
+            }
+            if (trim == 0) m_gap.Closed(m_clock->Now(), s.duration);
+            Save();
+        }
+        SyncAlerts();
+    }
+
+    // Paused by Sample() for lack of input; Stop() ends it.
+    bool Idle() const { return m_idleSince >= 0; }
+
+    void Reset() {
+        if (running || Idle()) Stop();
+        elapsed = 0;
+        m_startElapsed = 0;
+        SyncAlerts();
+    }
+
+private:
+    static const size_t kHotSessions = 500;
+
+    const wxString  m_dir;
+    HistoryArchive& m_arc;
+    std::vector<std::wstring> m_keys;
+    wchar_t   m_lower[MAX_PATH] = {};
+    RuleTable m_rules;
+    int       m_curCat = -1;
+    int       m_startElapsed = 0;
+    AlertScheduler m_alerts;
+    int64_t   m_workClock = 0;   // tracked seconds since launch
+    int       m_day = 0;         // local day of month, for rollover
+    Clock*    m_clock = &SystemTime();
+    int64_t   m_idleSince = -1;  // last input before an idle pause
+    IdleGap   m_gap;             // input gap as Sample last saw it
+    BucketPyramid m_timeline;
+    bool      m_timelineOk = false;
+
+    wxDateTime Now() const { return wxDateTime((time_t)m_clock->Now()); }
+
+    // An input gap reached the idle threshold: takes it back off the
+    // sessions a focus change closed during it. All but the first of them
+    // lie wholly inside it.
+    void TrimGap() {
+        IdleGap::Cut cut;
+        if (!m_gap.Take(sessions.size(), [&](size_t i) { return sessions[i].duration; }, cut)) return;
+        for (size_t i = cut.first; i < sessions.size(); i++) {
+            HistRecord old = ToHistRecord(sessions[i]);
+            TimelineEdit(&old, nullptr);
+        }
+        Session& s = sessions[cut.first];
+        s.duration -= cut.firstCut;
+        wxDateTime end((time_t)m_gap.LastInput());
+        s.date = end.FormatISODate();
+        s.endTime = end.Format("%H:%M");
+        if (cut.keepFirst) {
+            HistRecord r = ToHistRecord(s);
+            TimelineEdit(nullptr, &r);
+        }
+        sessions.erase(sessions.begin() + cut.first + (cut.keepFirst ? 1 : 0), sessions.end());
+        elapsed -= cut.total;
+        m_startElapsed -= cut.total;
+        cfg.todayTotal = std::max(0, cfg.todayTotal - cut.total);
+        Save();
+        SyncAlerts();
+    }
+
+    void EndIdle(int64_t until) {
+        if (until > m_idleSince) IdleLog::Append(m_idleSince, (uint32_t)(until - m_idleSince), m_dir);
+        m_idleSince = -1;
+    }
+
+    std::tm LocalNow() const {
+        time_t t = (time_t)m_clock->Now();
+        std::tm tm = {};
+        localtime_s(&tm, &t);
+        return tm;
+    }
+
+    void BuildTimeline() {
+        PERF_SCOPE(kPerfTimelineBuild);
+        m_timeline.Clear();
+        std::vector<HistRecord> recs;
+        m_arc.ForEachSegment([&](const std::string&, const HistSegment& seg) {
+            for (auto& b : seg.blocks) {
+                recs.clear();
+                seg.Decode(b, recs, std::numeric_limits<int64_t>::min(),
+                    std::numeric_limits<int64_t>::max());
+                for (auto& r : recs) m_timeline.Add(LocalSeconds(r.start), r.dur);
+            }
+            });
+        for (auto& s : sessions) {
+            HistRecord r = ToHistRecord(s);
+            m_timeline.Add(LocalSeconds(r.start), r.dur);
+        }
+        m_timelineOk = true;
+    }
+
+    // Re-arms the alert wheels from the current state. Only on transitions.
+    void SyncAlerts() {
+        AlertScheduler::State st;
+        st.work = m_workClock;
+        st.wall = m_clock->Now();
+        st.elapsed = elapsed;
+        st.today = cfg.todayTotal;
+        st.running = running;
+        std::wstring key = curApp.Lower().ToStdWstring();
+        st.appKey = key.c_str();
+        st.appToday = running ? AppToday(curApp) : 0;
+        m_alerts.Sync(st);
+    }
+
+    void NewDay(int day) {
+        m_day = day;
+        m_gap.Forget();         // a new month archives them
+        cfg.todayTotal = 0;
+        cfg.lastDate = Now().FormatISODate();
+        cfg.alertsFired.clear();
+        m_alerts.NewDay();
+        SyncAlerts();
+    }
+
+    // Rules first, then the work-app list. cat gets the rule category or -1.
+    bool Classify(int appId, TitleSource* title, int& cat) {
+        PERF_SCOPE(kPerfRules);
+        std::tm tm = LocalNow();
+        RuleSample rs = { m_lower, tm.tm_wday, tm.tm_hour * 60 + tm.tm_min, title };
+        int v = m_rules.Eval(rs);
+        if (v == RuleTable::kNoMatch) return appId >= 0;
+        cat = v >= 0 ? v : -1;
+        return v >= 0;
+    }
+
+    // Moves sessions from closed months, and any overflow past
+    // kHotSessions, out of the ini into the history archive. They stay
+    // in the ini if the archive can't be written.
+    void ArchiveCold() {
+        wxString month = Now().Format("%Y-%m");
+        size_t overflow = sessions.size() > kHotSessions ? sessions.size() - kHotSessions : 0;
+        std::vector<Session> cold, hot;
+        for (size_t i = 0; i < sessions.size(); i++) {
+            if (i < overflow || sessions[i].date.Left(7) < month) cold.push_back(sessions[i]);
+            else hot.push_back(sessions[i]);
+        }
+        if (cold.empty() || !m_arc.Append(cold)) return;
+        sessions.swap(hot);
+    }
+};
+
+// =========================================
+// Foreground traces
+// =========================================
+// Recorded or synthetic foreground samples, replayed through Tracker on a
+// virtual clock. File format (.wtt): "WTT2", u64 start (epoch ms), then
+// one record per foreground change or input gap:
+//   var dt ms, var kind
+//   kind 0, foreground: var pid, var exe ref, var title ref
+//   kind 1, input after a gap: var gap ms
+// A ref equal to its table's size introduces a new string (WStr) at that
+// index, so each exe and title is stored once. Titles are lower-case, as
+// TitleSource returns them; an empty exe means no foreground window.
+// "WTT1" files have no kind and only foreground records.
+class TraceWriter {
+public:
+    void Begin(int64_t startMs) {
+        m_out.buf.append("WTT2", 4);
+        m_out.U64((uint64_t)startMs);
+        m_last = startMs;
+    }
+
+    void Add(int64_t ms, uint32_t pid, const std::wstring& exe, const std::wstring& title) {
+        Stamp(ms, kForeground);
+        m_out.Var(pid);
+        Ref(m_exes, exe);
+        Ref(m_titles, title);
+    }
+
+    // Input arrived at ms after gapMs without any.
+    void AddInput(int64_t ms, int64_t gapMs) {
+        Stamp(ms, kInput);
+        m_out.Var((uint64_t)std::max<int64_t>(0, gapMs));
+    }
+
+    size_t Size() const { return m_out.buf.size(); }
+
+    // Hands over the bytes written since the last call; the string
+    // tables carry on.
+    std::string Take() {
+        std::string out;
+        out.swap(m_out.buf);
+        return out;
+    }
+
+private:
+    enum { kForeground, kInput };
+
+    ByteWriter m_out;
+    int64_t    m_last = 0;
+    std::unordered_map<std::wstring, uint32_t> m_exes, m_titles;
+
+    void Stamp(int64_t ms, int kind) {
+        m_out.Var((uint64_t)std::max<int64_t>(0, ms - m_last));
+        m_last = std::max(m_last, ms);
+        m_out.Var((uint64_t)kind);
+    }
+
+    void Ref(std::unordered_map<std::wstring, uint32_t>& table, const std::wstring& s) {
+        auto it = table.find(s);
+        if (it != table.end()) { m_out.Var(it->second); return; }
+        uint32_t id = (uint32_t)table.size();
+        table.emplace(s, id);
+        m_out.Var(id);
+        m_out.WStr(s);
+    }
+};
+
+struct ForegroundTrace {
+    struct Event {
+        int64_t  ms;        // epoch
+        uint32_t pid;
+        uint32_t exe;       // into exes
+        uint32_t title;     // into titles
+    };
+
+    // No keyboard or mouse input in [startMs, endMs).
+    struct Gap {
+        int64_t startMs;
+        int64_t endMs;
+    };
+
+    int64_t                   startMs = 0;
+    std::vector<std::wstring> exes;
+    std::vector<std::wstring> titles;
+    std::vector<Event>        events;
+    std::vector<Gap>          inputs;     // by endMs
+
+    // A record cut short by a crash ends the trace.
+    bool Parse(const std::string& raw) {
+        ByteReader r(raw.data(), raw.size());
+        bool v1 = raw.compare(0, 4, "WTT1") == 0;
+        if (!v1 && raw.compare(0, 4, "WTT2") != 0) return false;
+        r.Skip(4);
+        startMs = (int64_t)r.U64();
+        if (!r.Ok()) return false;
+        int64_t t = startMs;
+        while (!r.AtEnd()) {
+            t += (int64_t)r.Var();
+            uint64_t kind = v1 ? 0 : r.Var();
+            if (kind == 1) {
+                int64_t gap = (int64_t)r.Var();
+                if (!r.Ok()) break;
+                inputs.push_back({ t - gap, t });
+                continue;
+            }
+            Event e;
+            e.ms = t;
+            e.pid = (uint32_t)r.Var();
+            if (kind != 0 || !Ref(r, exes, e.exe) || !Ref(r, titles, e.title)) break;
+            events.push_back(e);
+        }
+        return true;
+    }
+
+private:
+    static bool Ref(ByteReader& r, std::vector<std::wstring>& table, uint32_t& id) {
+        uint64_t v = r.Var();
+        if (!r.Ok() || v > table.size()) return false;
+        if (v == table.size()) {
+            std::wstring s = r.WStr();
+            if (!r.Ok()) return false;
+            table.push_back(std::move(s));
+        }
+        id = (uint32_t)v;
+        return true;
+    }
+};
+
+// --record=<file>: appends each foreground change seen by the 1s sampler,
+// and each return of input after a gap of kMinGapMs or more. UI thread
+// only; written in 64 KB chunks, or after a minute.
+class SampleRecorder {
+public:
+    static SampleRecorder& Get() {
+        static SampleRecorder rec;
+        return rec;
+    }
+
+    bool Start(const wxString& path) {
+        if (m_active) return true;
+        m_writer = TraceWriter();
+        m_writer.Begin(NowMs());
+        if (!WriteWholeFile(path, m_writer.Take())) return false;
+        m_path = path;
+        m_flushedMs = m_inputMs = NowMs();
+        m_active = true;
+        return true;
+    }
+
+    void Stop() {
+        if (!m_active) return;
+        AppendToFile(m_path, m_writer.Take());
+        m_active = false;
+    }
+
+    // True if the sample differed from the last one and was logged.
+    bool Record(const wchar_t* exe, DWORD pid, TitleSource* title, InputSource* input) {
+        if (!m_active) return false;
+        int64_t now = NowMs();
+        bool logged = false;
+        // Tick-derived, so the last-input time jitters; only a real
+        // advance counts.
+        int64_t inputMs = input ? now - (int64_t)input->IdleMs() : now;
+        if (inputMs > m_inputMs + 500) {
+            if (inputMs - m_inputMs >= kMinGapMs) {
+                m_writer.AddInput(inputMs, inputMs - m_inputMs);
+                logged = true;
+            }
+            m_inputMs = inputMs;
+        }
+        const wchar_t* text = exe && title ? title->Title() : L"";
+        if (!exe) { exe = L""; pid = 0; }
+        if (pid != m_pid || m_exe != exe || m_title != text) {
+            m_pid = pid;
+            m_exe = exe;
+            m_title = text;
+            m_writer.Add(now, pid, m_exe, m_title);
+            logged = true;
+        }
+        if (logged && (m_writer.Size() >= 64 * 1024 || now - m_flushedMs >= 60000)) {
+            AppendToFile(m_path, m_writer.Take());
+            m_flushedMs = now;
+        }
+        return logged;
+    }
+
+private:
+    static const int64_t kMinGapMs = 10000;
+
+    bool         m_active = false;
+    wxString     m_path;
+    TraceWriter  m_writer;
+    int64_t      m_flushedMs = 0;
+    int64_t      m_inputMs = 0;     // last input seen
+    DWORD        m_pid = 0;
+    std::wstring m_exe;
+    std::wstring m_title;
+
+    static int64_t NowMs() {
+        return (int64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+};
+
+// Synthetic traces, the same bytes for the same pattern and length. Days
+// start Monday 2025-03-03; weekdays run about 09:00-18:00 with an hour on
+// the lock screen at noon, weekends are idle. On Tuesdays and Thursdays
+// lunch is taken with the editor still in front, so only the input gap
+// ends the session.
+//   heavy:  a switch every few seconds to minutes across eight apps, and
+//           now and then a pause of a minute or two or of 8-20 minutes
+//   steady: 10-90 minute blocks in the four busiest ones
+bool GenerateTrace(const wxString& path, const wxString& pattern, int days, wxString* error) {
+    struct App {
+        const wchar_t* exe;
+        double         weight;
+        const wchar_t* titles[3];
+    };
+    static const App kApps[] = {
+        { L"Code.exe", 30, { L"main.cpp - worktimer - visual studio code",
+            L"readme.md - worktimer - visual studio code", L"settings.json - visual studio code" } },
+        { L"chrome.exe", 20, { L"board - jira - google chrome",
+            L"stack overflow - google chrome", L"youtube - google chrome" } },
+        { L"devenv.exe", 15, { L"worktimer - microsoft visual studio",
+            L"worktimer (debugging) - microsoft visual studio", L"output - microsoft visual studio" } },
+        { L"WindowsTerminal.exe", 12, { L"windows powershell", L"cmake --build build", L"git log" } },
+        { L"slack.exe", 10, { L"general - slack", L"dev - slack", L"random - slack" } },
+        { L"OUTLOOK.EXE", 6, { L"inbox - outlook", L"calendar - outlook", L"re: release - message" } },
+        { L"Teams.exe", 4, { L"chat | microsoft teams", L"standup | microsoft teams", L"calendar | microsoft teams" } },
+        { L"explorer.exe", 3, { L"downloads", L"documents", L"worktimer" } },
+    };
+    const size_t nApps = sizeof(kApps) / sizeof(kApps[0]);
+    bool heavy = pattern == "heavy";
+    if (!heavy && pattern != "steady") {
+        *error = "Unknown trace pattern: " + pattern + " (heavy or steady)";
+        return false;
+    }
+    if (days < 1 || days > 3660) {
+        *error = "Days must be between 1 and 3660.";
+        return false;
+    }
+
+    std::mt19937 rng(20250303);
+    std::vector<double> weights;
+    for (size_t i = 0; i < nApps; i++) weights.push_back(heavy || i < 4 ? kApps[i].weight : 0);
+    std::discrete_distribution<int> pick(weights.begin(), weights.end());
+    std::exponential_distribution<double> dwell(1 / 45.0);
+
+    TraceWriter w;
+    w.Begin(LocalTicks(2025, 3, 3, 0, 0, 0) * 1000);
+    auto emit = [&](int64_t at, uint32_t pid, const wchar_t* exe, const wchar_t* title) {
+        w.Add(at * 1000 + (int64_t)(rng() % 1000), pid, exe, title);
+    };
+    int64_t lastInput = 0;      // before the current break, epoch seconds
+    for (int d = 0; d < days; d++) {
+        if (d % 7 >= 5) continue;
+        int64_t base = LocalTicks(2025, 3, 3 + d, 0, 0, 0);
+        int64_t spans[2][2] = {
+            { 9 * 3600 + (int64_t)(rng() % 1800), 12 * 3600 },
+            { 13 * 3600, 18 * 3600 + (int64_t)(rng() % 3600) },
+        };
+        bool deskLunch = d % 7 == 1 || d % 7 == 3;
+        for (int s = 0; s < 2; s++) {
+            int64_t* span = spans[s];
+            if (lastInput) w.AddInput((base + span[0]) * 1000, (base + span[0] - lastInput) * 1000);
+            for (int64_t t = span[0]; t < span[1]; ) {
+                int a = pick(rng);
+                emit(base + t, 1000 + 4 * a, kApps[a].exe, kApps[a].titles[rng() % 3]);
+                t += heavy ? 5 + std::min<int64_t>(900, (int64_t)dwell(rng)) : 600 + (int64_t)(rng() % 4800);
+                int64_t pause = rng() % 2 ? 30 + (int64_t)(rng() % 210) : 480 + (int64_t)(rng() % 720);
+                if (heavy && rng() % 40 == 0 && t + pause < span[1]) {
+                    t += pause;
+                    w.AddInput((base + t) * 1000, pause * 1000);
+                }
+            }
+            lastInput = base + span[1];
+            if (s == 0 && deskLunch) emit(base + span[1], 1000, kApps[0].exe, kApps[0].titles[0]);
+            else emit(base + span[1], 900, L"LockApp.exe", L"");
+        }
+    }
+    if (!WriteWholeFile(path, w.Take())) {
+        *error = "Could not write " + path;
+        return false;
+    }
+    return true;
+}
+
+// Runs a trace through the same Tracker calls MainFrame makes: each
+// virtual second one Tick() (OnTick) then one Sample() (OnMonitor), and
+// Stop() at the end (StopTimer). The tracker gets a virtual clock and a
+// scratch data directory seeded with a built-in config, so sessions,
+// alerts, the ini and the archive behave as they would live, only faster.
+// The trace's input gaps drive idle detection, and the saved total is
+// checked against one worked out from the trace alone.
+class TraceReplay {
+public:
+    struct Result {
+        bool     ok = false;
+        bool     passed = true;     // idle check
+        wxString error;
+        wxString report;
+    };
+
+    static Result Run(const wxString& tracePath) {
+        Result res;
+        std::string raw;
+        ForegroundTrace trace;
+        if (!ReadWholeFile(tracePath, raw) || !trace.Parse(raw)) {
+            res.error = "Not a foreground trace: " + tracePath;
+            return res;
+        }
+        if (trace.events.empty()) {
+            res.error = "No samples in " + tracePath;
+            return res;
+        }
+
+        ScratchDir dir;
+        if (dir.path.IsEmpty()) {
+            res.error = "Could not create a scratch directory";
+            return res;
+        }
+        AppConfig seed = Config();
+        SaveConfig(seed, std::vector<Session>(), dir.path);
+
+        VirtualClock clock;
+        clock.now = FloorDiv(trace.startMs, 1000);
+        HistoryArchive arc(dir.path);
+        Tracker trk(dir.path, arc);
+        trk.SetClock(clock);
+        trk.Load();
+
+        int64_t first = clock.now, last = FloorDiv(trace.events.back().ms, 1000) + 60;
+        size_t longGaps = 0;
+        int64_t expected = Expected(trace, seed, first, last, &longGaps);
+        int64_t slack = 2 * (int64_t)longGaps + 2;
+
+        ReplayTitle title;
+        ReplayInput input;
+        Latency step, transition, lag;
+        uint64_t steps = 0, transitions = 0, alerts[4] = {};
+        const ForegroundTrace::Event* cur = nullptr;
+        int64_t changedMs = -1;     // foreground change not yet sampled
+        size_t next = 0, gap = 0;
+#if WT_ALLOC_CHECK
+        uint64_t allocs = 0, allocSteps = 0;
+        int64_t allocDay = 0;
+#endif
+        uint64_t t0 = PerfNowNs();
+        for (int64_t sec = first + 1; sec <= last; sec++) {
+            int64_t ms = sec * 1000;
+            clock.now = sec;
+            for (; next < trace.events.size() && trace.events[next].ms <= ms; next++) {
+                cur = &trace.events[next];
+                changedMs = cur->ms;
+            }
+            const wchar_t* exe = nullptr;
+            if (cur && !trace.exes[cur->exe].empty()) {
+                exe = trace.exes[cur->exe].c_str();
+                title.text = trace.titles[cur->title].c_str();
+            }
+            for (; gap < trace.inputs.size() && trace.inputs[gap].endMs <= ms; gap++) {}
+            const ForegroundTrace::Gap* g = gap < trace.inputs.size() &&
+                trace.inputs[gap].startMs < ms ? &trace.inputs[gap] : nullptr;
+            input.idleMs = g ? (uint32_t)(ms - g->startMs) : 0;
+
+#if WT_ALLOC_CHECK
+            // Steady: no transition, alert, idle change or new day, and
+            // past the first minute's warm-up.
+            int64_t day = FloorDiv(LocalSeconds(sec), 86400);
+            bool idle0 = trk.Idle(), steady = day == allocDay && sec > first + 60;
+            allocDay = day;
+            uint64_t a0 = ThreadAllocs();
+#endif
+            uint64_t s0 = PerfNowNs();
+            const std::vector<uint32_t>& due = trk.Tick();
+            for (uint32_t id : due) alerts[trk.Alerts().Alerts()[id].kind]++;
+            bool fired = !due.empty();
+            Tracker::Change c = trk.Sample(exe, &title, &input);
+            uint64_t ns = PerfNowNs() - s0;
+#if WT_ALLOC_CHECK
+            if (steady && !fired && c == Tracker::kNone && trk.Idle() == idle0 && ThreadAllocs() != a0) {
+                allocSteps++;
+                allocs += ThreadAllocs() - a0;
+            }
+#else
+            (void)fired;
+#endif
+            steps++;
+            step.Add(ns);
+            if (c != Tracker::kNone) {
+                transitions++;
+                transition.Add(ns);
+                if (changedMs >= 0) lag.Add((uint64_t)(sec * 1000 - changedMs));
+            }
+            changedMs = -1;
+        }
+        if (trk.running || trk.Idle()) trk.Stop();
+        arc.Stop();         // packs the journal
+        double wall = std::max(1e-9, (PerfNowNs() - t0) / 1e9);
+
+        uint64_t sessions = 0;
+        int tracked = 0;
+        for (auto& s : trk.History(std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max())) {
+            sessions++;
+            tracked += s.duration;
+        }
+
+        int pauses = 0;
+        int64_t idle = IdleLog::Total(std::numeric_limits<int64_t>::min(),
+            std::numeric_limits<int64_t>::max(), &pauses, dir.path);
+        int64_t off = std::abs(tracked - expected);
+        res.passed = off <= slack;
+#if WT_ALLOC_CHECK
+        res.passed = res.passed && allocs == 0;
+#endif
+
+        char clockText[16], idleText[16], expectText[16];
+        FormatClock(tracked, clockText);
+        FormatClock((int)idle, idleText);
+        FormatClock((int)expected, expectText);
+        PerfSummary st = step.Summary(), tr = transition.Summary(), lg = lag.Summary();
+        wxString& r = res.report;
+        r = wxString::Format("Replayed %s\n", tracePath);
+        r += wxString::Format("  config       built in: %d apps, %d alerts, idle after %d min\n",
+            (int)seed.workApps.size(), (int)seed.alerts.size(), seed.idleMinutes);
+        r += wxString::Format("  trace        %llu changes, %s to %s\n",
+            (unsigned long long)trace.events.size(),
+            FormatLocal(LocalSeconds(first)), FormatLocal(LocalSeconds(last)));
+        r += wxString::Format("  speed        %llu virtual s in %.2f s (%.0fx real time)\n",
+            (unsigned long long)steps, wall, steps / wall);
+        r += wxString::Format("  sessions     %llu saved, %s tracked, %.0f sessions/s\n",
+            (unsigned long long)sessions, clockText, sessions / wall);
+        r += wxString::Format("  transitions  %llu; alerts: %llu break, %llu goal, %llu budget, %llu summary\n",
+            (unsigned long long)transitions, (unsigned long long)alerts[0], (unsigned long long)alerts[1],
+            (unsigned long long)alerts[2], (unsigned long long)alerts[3]);
+        r += wxString::Format("  step         p50 %.1f us  p99 %.1f us  max %.1f us  (Tick + Sample)\n",
+            st.p50 / 1000.0, st.p99 / 1000.0, st.maxNs / 1000.0);
+        r += wxString::Format("  transition   p50 %.1f us  p99 %.1f us  max %.1f us  (start/stop, with save)\n",
+            tr.p50 / 1000.0, tr.p99 / 1000.0, tr.maxNs / 1000.0);
+        r += wxString::Format("  switch lag   p50 %llu ms  p99 %llu ms  max %llu ms  (virtual, change to transition)\n",
+            (unsigned long long)lg.p50, (unsigned long long)lg.p99, (unsigned long long)lg.maxNs);
+        r += wxString::Format("  idle         %d pauses, %s trimmed or skipped; %llu input gaps over %d min\n",
+            pauses, idleText, (unsigned long long)longGaps, trk.cfg.idleMinutes);
+        r += wxString::Format("  idle check   %s tracked vs %s outside long gaps: off %lld s, allowed %lld s  %s\n",
+            clockText, expectText, (long long)off, (long long)slack, off <= slack ? "OK" : "FAIL");
+#if WT_ALLOC_CHECK
+        r += wxString::Format("  alloc check  %llu allocations in %llu steady steps  %s\n",
+            (unsigned long long)allocs, (unsigned long long)allocSteps, allocs == 0 ? "OK" : "FAIL");
+#endif
+        res.ok = true;
+        return res;
+    }
+
+private:
+    // The tracker's settings for every replay, whatever the user's ini
+    // says: the four busiest apps of GenerateTrace, no rules.
+    static AppConfig Config() {
+        static const wchar_t* const kApps[] = {
+            L"Code.exe", L"chrome.exe", L"devenv.exe", L"WindowsTerminal.exe" };
+        AppConfig cfg;
+        for (auto exe : kApps) cfg.workApps.push_back({ exe, exe });
+        cfg.alerts = { "break 50m", "goal Code.exe 4h", "budget 9h", "summary 18:00" };
+        cfg.colorAlert = false;
+        cfg.idleMinutes = 5;
+        cfg.onboardDone = true;
+        return cfg;
+    }
+
+    // Seconds cfg should save for the samples first+1 .. last-1, from the
+    // trace alone: one for each whose foreground exe is a work app, less
+    // those of each input gap that reaches the idle threshold at some
+    // sample, from the gap's start to the first sample after it. A sample
+    // with no foreground window leaves things as they were. longGaps gets
+    // how many gaps reached it.
+    static int64_t Expected(const ForegroundTrace& trace, const AppConfig& cfg,
+                            int64_t first, int64_t last, size_t* longGaps) {
+        auto lower = [](std::wstring s) {
+            for (auto& c : s) c = (wchar_t)towlower(c);
+            return s;
+        };
+        std::vector<bool> work(trace.exes.size(), false);
+        for (size_t i = 0; i < trace.exes.size(); i++)
+            for (auto& a : cfg.workApps)
+                if (lower(trace.exes[i]) == lower(a.exeName.ToStdWstring())) work[i] = true;
+
+        auto ceilSec = [](int64_t ms) { return -FloorDiv(-ms, 1000); };
+        int64_t thrMs = (int64_t)cfg.idleMinutes * 60000, secs = 0;
+        bool on = false;
+        *longGaps = 0;
+        size_t next = 0, gap = 0;
+        for (int64_t sec = first + 1; sec < last; sec++) {
+            for (; next < trace.events.size() && trace.events[next].ms <= sec * 1000; next++)
+                if (!trace.exes[trace.events[next].exe].empty()) on = work[trace.events[next].exe];
+            for (; gap < trace.inputs.size() && ceilSec(trace.inputs[gap].endMs) <= sec; gap++) {
+                const ForegroundTrace::Gap& g = trace.inputs[gap];
+                if (thrMs && ceilSec(g.startMs + thrMs) * 1000 < g.endMs) ++*longGaps;
+            }
+            const ForegroundTrace::Gap* g = gap < trace.inputs.size() ? &trace.inputs[gap] : nullptr;
+            bool away = thrMs && g && ceilSec(g->startMs) <= sec &&
+                ceilSec(g->startMs + thrMs) * 1000 < g->endMs;
+            if (on && !away) secs++;
+        }
+        return secs;
+    }
+
+    class VirtualClock : public Clock {
+    public:
+        int64_t now = 0;
+        int64_t Now() override { return now; }
+    };
+
+    class ReplayTitle : public TitleSource {
+    public:
+        const wchar_t* text = L"";
+        const wchar_t* Title() override { return text; }
+    };
+
+    class ReplayInput : public InputSource {
+    public:
+        uint32_t idleMs = 0;
+        uint32_t IdleMs() override { return idleMs; }
+    };
+
+    struct Latency {
+        std::vector<uint64_t> hist = std::vector<uint64_t>(kHistBuckets, 0);
+        uint64_t              maxNs = 0;
+
+        void Add(uint64_t v) {
+            hist[HistBucket(v)]++;
+            maxNs = std::max(maxNs, v);
+        }
+        PerfSummary Summary() const { return HistSummarize(hist, maxNs); }
+    };
+};
+
+// =========================================
+// Executable catalog
+// =========================================
+// Installed executables (Program Files, per-user Programs, Start Menu
+// shortcuts) with a trigram index over exe and product names. A background
+// scan walks the roots in parallel. Directories whose mtime is unchanged
+// reuse the previous listing and version info. The index is persisted as
+// catalog.bin and loaded before the rescan starts.
+struct CatalogEntry {
+    std::wstring exeName;   // "Code.exe"
+    std::wstring product;   // FileDescription / ProductName / shortcut name
+    std::wstring path;
+};
+
+struct CatalogDir {
+    std::wstring              path;
+    uint64_t                  mtime = 0;
+    std::vector<std::wstring> subdirs;
+    std::vector<CatalogEntry> entries;
+};
+
+inline uint64_t Trigram(wchar_t a, wchar_t b, wchar_t c) {
+    return ((uint64_t)(uint16_t)a << 32) | ((uint64_t)(uint16_t)b << 16) | (uint16_t)c;
+}
+
+inline std::wstring LowerW(const std::wstring& s) {
+    std::wstring r(s);
+    for (auto& c : r) c = (wchar_t)towlower(c);
+    return r;
+}
+
+// Immutable once published; searches run against a shared snapshot.
+class CatalogIndex {
+public:
+    std::vector<CatalogDir>   dirs;
+    std::vector<CatalogEntry> entries;    // flattened dirs, unique by exe name
+    std::vector<std::wstring> hay;        // lower-case "exe\nproduct" per entry
+    std::vector<uint64_t>     keys;       // sorted trigrams
+    std::vector<uint32_t>     offsets;    // keys.size() + 1, into postings
+    std::vector<uint32_t>     postings;   // entry ids
+
+    void Flatten() {
+        entries.clear();
+        hay.clear();
+        std::set<std::wstring> seen;
+        for (auto& d : dirs) {
+            for (auto& e : d.entries) {
+                std::wstring lowExe = LowerW(e.exeName);
+                if (!seen.insert(lowExe).second) continue;
+                entries.push_back(e);
+                hay.push_back(lowExe + L"\n" + LowerW(e.product));
+            }
+        }
+    }
+
+    void BuildPostings() {
+        std::vector<std::pair<uint64_t, uint32_t>> pairs;
+        for (uint32_t id = 0; id < hay.size(); id++) {
+            const std::wstring& h = hay[id];
+            for (size_t i = 0; i + 2 < h.size(); i++)
+                pairs.push_back({ Trigram(h[i], h[i + 1], h[i + 2]), id });
+        }
+        std::sort(pairs.begin(), pairs.end());
+        pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+        keys.clear(); offsets.clear(); postings.clear();
+        postings.reserve(pairs.size());
+        for (auto& p : pairs) {
+            if (keys.empty() || keys.back() != p.first) {
+                keys.push_back(p.first);
+                offsets.push_back((uint32_t)postings.size());
+            }
+            postings.push_back(p.second);
+        }
+        offsets.push_back((uint32_t)postings.size());
+    }
+
+    // Ranked by matched trigrams, then exact substring, exe prefix and
+    // shorter names. Queries under three chars fall back to a prefix scan.
+    std::vector<CatalogEntry> Search(const std::wstring& query, size_t limit) const {
+        PERF_SCOPE(kPerfCatalogSearch);
+        std::vector<CatalogEntry> out;
+        std::wstring q = LowerW(query);
+        if (q.empty() || entries.empty()) return out;
+
+        std::vector<std::pair<int, uint32_t>> ranked;   // (score, id)
+        auto bonus = [&](uint32_t id) {
+            const std::wstring& h = hay[id];
+            int b = 0;
+            if (h.find(q) != std::wstring::npos) b += 1000;
+            if (h.compare(0, q.size(), q) == 0) b += 500;
+            return b - (int)std::min<size_t>(h.find(L'\n'), 100);
+        };
+
+        if (q.size() < 3) {
+            for (uint32_t id = 0; id < hay.size(); id++)
+                if (hay[id].find(q) != std::wstring::npos) ranked.push_back({ bonus(id), id });
+        }
+        else {
+            std::vector<uint64_t> grams;
+            for (size_t i = 0; i + 2 < q.size(); i++) grams.push_back(Trigram(q[i], q[i + 1], q[i + 2]));
+            std::sort(grams.begin(), grams.end());
+            grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+
+            // Dense per-entry counters, reused across searches on this thread.
+            thread_local std::vector<uint16_t> hits;
+            thread_local std::vector<uint32_t> touched;
+            if (hits.size() < entries.size()) hits.assign(entries.size(), 0);
+            touched.clear();
+            for (uint64_t g : grams) {
+                auto k = std::lower_bound(keys.begin(), keys.end(), g);
+                if (k == keys.end() || *k != g) continue;
+                size_t ki = k - keys.begin();
+                for (uint32_t i = offsets[ki]; i < offsets[ki + 1]; i++) {
+                    uint32_t id = postings[i];
+                    if (!hits[id]++) touched.push_back(id);
+                }
+            }
+            // Tolerate a typo or two: require about two thirds of the trigrams.
+            int need = std::max<int>(1, (int)grams.size() * 2 / 3);
+            for (uint32_t id : touched) {
+                if (hits[id] >= need) ranked.push_back({ hits[id] * 100 + bonus(id), id });
+                hits[id] = 0;
+            }
+        }
+
+        size_t n = std::min(limit, ranked.size());
+        std::partial_sort(ranked.begin(), ranked.begin() + n, ranked.end(),
+            [](const std::pair<int, uint32_t>& a, const std::pair<int, uint32_t>& b) {
+                return a.first > b.first;
+            });
+        for (size_t i = 0; i < n; i++) out.push_back(entries[ranked[i].second]);
+        return out;
+    }
+
+    void Save(ByteWriter& w) const {
+        w.U32(0x31435457);  // "WTC1"
+        w.U32((uint32_t)dirs.size());
+        for (auto& d : dirs) {
+            w.WStr(d.path);
+            w.U64(d.mtime);
+            w.U32((uint32_t)d.subdirs.size());
+            for (auto& sd : d.subdirs) w.WStr(sd);
+            w.U32((uint32_t)d.entries.size());
+            for (auto& e : d.entries) { w.WStr(e.exeName); w.WStr(e.product); w.WStr(e.path); }
+        }
+        w.U32((uint32_t)keys.size());
+        for (size_t i = 0; i < keys.size(); i++) { w.U64(keys[i]); w.U32(offsets[i]); }
+        w.U32((uint32_t)postings.size());
+        for (uint32_t p : postings) w.U32(p);
+    }
+
+    bool Load(ByteReader& r) {
+        if (r.U32() != 0x31435457) return false;
+        uint32_t nd = r.U32();
+        for (uint32_t i = 0; i < nd && r.Ok(); i++) {
+            CatalogDir d;
+            d.path = r.WStr();
+            d.mtime = r.U64();
+            uint32_t ns = r.U32();
+            for (uint32_t j = 0; j < ns && r.Ok(); j++) d.subdirs.push_back(r.WStr());
+            uint32_t ne = r.U32();
+            for (uint32_t j = 0; j < ne && r.Ok(); j++) {
+                CatalogEntry e;
+                e.exeName = r.WStr(); e.product = r.WStr(); e.path = r.WStr();
+                d.entries.push_back(e);
+            }
+            dirs.push_back(d);
+        }
+        Flatten();
+        uint32_t nk = r.U32();
+        for (uint32_t i = 0; i < nk && r.Ok(); i++) { keys.push_back(r.U64()); offsets.push_back(r.U32()); }
+        uint32_t np = r.U32();
+        for (uint32_t i = 0; i < np && r.Ok(); i++) {
+            uint32_t id = r.U32();
+            if (id >= entries.size()) return false;
+            postings.push_back(id);
+        }
+        offsets.push_back((uint32_t)postings.size());
+        for (size_t i = 1; i < offsets.size(); i++)
+            if (offsets[i] < offsets[i - 1]) return false;
+        return r.Ok();
+    }
+};
+
+class ExeCatalog {
+public:
+    static ExeCatalog& Get() {
+        static ExeCatalog cat;
+        return cat;
+    }
+
+    ~ExeCatalog() { Stop(); }
+
+    // Loads the persisted index, then rescans in the background.
+    void Start() {
+        if (m_thread.joinable()) return;
+        m_quit = false;
+        m_path = wxFileName(DataDir(), "catalog.bin").GetFullPath();
+        m_thread = std::thread([this] { Run(); });
+    }
+
+    void Stop() {
+        m_quit = true;
+        if (m_thread.joinable()) m_thread.join();
+    }
+
+    std::vector<CatalogEntry> Search(const wxString& query, size_t limit) const {
+        std::shared_ptr<const CatalogIndex> idx;
+        {
+            std::lock_guard<std::mutex> g(m_lock);
+            idx = m_index;
+        }
+        if (!idx) return {};
+        return idx->Search(query.ToStdWstring(), limit);
+    }
+
+    // Times Search over a synthetic index of n entries against the
+    // per-keystroke budget. Names are built from a fixed seed so runs
+    // compare across builds.
+    static bool Bench(size_t n, wxString& report) {
+        static const wchar_t* parts[] = {
+            L"code", L"studio", L"chrome", L"fire", L"fox", L"note", L"pad", L"term",
+            L"win", L"word", L"excel", L"git", L"hub", L"zoom", L"slack", L"team",
+            L"photo", L"shop", L"sync", L"view", L"edit", L"play", L"net", L"data",
+        };
+        const size_t kParts = sizeof(parts) / sizeof(parts[0]);
+        std::mt19937 rng(42);
+        CatalogIndex idx;
+        CatalogDir dir;
+        for (size_t i = 0; i < n; i++) {
+            CatalogEntry e;
+            e.product = parts[rng() % kParts];
+            e.product += L" ";
+            e.product += parts[rng() % kParts];
+            e.exeName = parts[rng() % kParts];
+            e.exeName += parts[rng() % kParts] + std::to_wstring(i) + L".exe";
+            e.path = L"C:\\Program Files\\" + e.exeName;
+            dir.entries.push_back(std::move(e));
+        }
+        idx.dirs.push_back(std::move(dir));
+        idx.Flatten();
+        idx.BuildPostings();
+
+        const double kBudgetMs = 5.0;
+        const wchar_t* queries[] = { L"co", L"code", L"chrme", L"photo shop", L"notepad", L"zzz" };
+        bool ok = true;
+        report = wxString::Format("catalog search, %zu entries (budget %.1f ms)\n", idx.entries.size(), kBudgetMs);
+        for (const wchar_t* q : queries) {
+            std::vector<double> ms;
+            size_t hits = 0;
+            for (int rep = 0; rep < 21; rep++) {
+                auto t0 = std::chrono::steady_clock::now();
+                hits = idx.Search(q, 30).size();
+                ms.push_back(std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - t0).count());
+            }
+            std::sort(ms.begin(), ms.end());
+            bool within = ms[ms.size() / 2] <= kBudgetMs;
+            ok = ok && within;
+            report += wxString::Format("  %-12s median %6.3f ms  max %6.3f ms  %2zu hits  %s\n",
+                wxString(q), ms[ms.size() / 2], ms.back(), hits, within ? "OK" : "OVER");
+        }
+        return ok;
+    }
+
+private:
+    static const int kMaxDepth = 5;
+
+    mutable std::mutex                  m_lock;
+    std::shared_ptr<const CatalogIndex> m_index;
+    std::thread                         m_thread;
+    std::atomic<bool>                   m_quit{ false };
+    wxString                            m_path;
+
+    void Publish(std::shared_ptr<const CatalogIndex> idx) {
+        std::lock_guard<std::mutex> g(m_lock);
+        m_index = idx;
+    }
+
+    void Run() {
+        SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN);
+        auto prev = std::make_shared<CatalogIndex>();
+        std::string raw;
+        if (ReadWholeFile(m_path, raw)) {
+            ByteReader r(raw.data(), raw.size());
+            if (prev->Load(r)) Publish(prev);
+            else prev = std::make_shared<CatalogIndex>();
+        }
+
+        auto next = std::make_shared<CatalogIndex>();
+        {
+            PERF_SCOPE(kPerfCatalogScan);
+            Scan(*prev, next->dirs);
+        }
+        if (m_quit) return;
+        next->Flatten();
+        next->BuildPostings();
+        Publish(next);
+
+        ByteWriter w;
+        next->Save(w);
+        WriteWholeFile(m_path, w.buf);
+    }
+
+    static std::vector<std::wstring> Roots() {
+        std::vector<std::wstring> roots;
+        const KNOWNFOLDERID* ids[] = {
+            &FOLDERID_ProgramFiles, &FOLDERID_ProgramFilesX86, &FOLDERID_UserProgramFiles,
+            &FOLDERID_CommonPrograms, &FOLDERID_Programs,
+        };
+        for (auto* id : ids) {
+            PWSTR p = nullptr;
+            if (SUCCEEDED(SHGetKnownFolderPath(*id, 0, NULL, &p)) && p) {
+                if (std::find(roots.begin(), roots.end(), p) == roots.end()) roots.push_back(p);
+            }
+            CoTaskMemFree(p);
+        }
+        return roots;
+    }
+
+    // One thread per root; each writes its own dir list.
+    void Scan(const CatalogIndex& prev, std::vector<CatalogDir>& out) {
+        std::unordered_map<std::wstring, const CatalogDir*> byPath;
+        for (auto& d : prev.dirs) byPath[d.path] = &d;
+
+        std::vector<std::wstring> roots = Roots();
+        std::vector<std::vector<CatalogDir>> parts(roots.size());
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < roots.size(); i++) {
+            workers.emplace_back([&, i] {
+                SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN);
+                HRESULT co = CoInitializeEx(NULL, COINIT_MULTITHREADED);
+                Walk(roots[i], 0, byPath, parts[i]);
+                if (SUCCEEDED(co)) CoUninitialize();
+            });
+        }
+        for (auto& t : workers) t.join();
+        for (auto& p : parts)
+            for (auto& d : p) out.push_back(std::move(d));
+    }
+
+    void Walk(const std::wstring& dir, int depth,
+        const std::unordered_map<std::wstring, const CatalogDir*>& prev,
+        std::vector<CatalogDir>& out)
+    {
+        if (m_quit) return;
+        WIN32_FILE_ATTRIBUTE_DATA fad;
+        if (!GetFileAttributesExW(dir.c_str(), GetFileExInfoStandard, &fad)) return;
+
+        CatalogDir cur;
+        cur.path = dir;
+        cur.mtime = ((uint64_t)fad.ftLastWriteTime.dwHighDateTime << 32) |
+            fad.ftLastWriteTime.dwLowDateTime;
+
+        auto it = prev.find(dir);
+        const CatalogDir* old = it != prev.end() ? it->second : nullptr;
+        if (old && old->mtime == cur.mtime) {
+            cur.subdirs = old->subdirs;
+            cur.entries = old->entries;
+        }
+        else {
+            List(dir, old, cur);
+        }
+
+        std::vector<std::wstring> subdirs = cur.subdirs;
+        out.push_back(std::move(cur));
+        if (depth >= kMaxDepth) return;
+        for (auto& sd : subdirs) Walk(dir + L"\\" + sd, depth + 1, prev, out);
+    }
+
+    static bool EndsWithNoCase(const std::wstring& s, const wchar_t* suffix) {
+        size_t n = wcslen(suffix);
+        return s.size() >= n && _wcsicmp(s.c_str() + s.size() - n, suffix) == 0;
+    }
+
+    static void List(const std::wstring& dir, const CatalogDir* old, CatalogDir& cur) {
+        WIN32_FIND_DATAW fd;
+        HANDLE h = FindFirstFileExW((dir + L"\\*").c_str(), FindExInfoBasic, &fd,
+            FindExSearchNameMatch, NULL, FIND_FIRST_EX_LARGE_FETCH);
+        if (h == INVALID_HANDLE_VALUE) return;
+        do {
+            std::wstring name(fd.cFileName);
+            if (name == L"." || name == L"..") continue;
+            if (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+                if (!(fd.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT)) cur.subdirs.push_back(name);
+                continue;
+            }
+            CatalogEntry e;
+            if (EndsWithNoCase(name, L".exe")) {
+                if (_wcsnicmp(name.c_str(), L"unins", 5) == 0) continue;
+                e.exeName = name;
+                e.path = dir + L"\\" + name;
+                e.product = Reuse(old, e.path);
+                if (e.product.empty()) e.product = ReadProductName(e.path);
+            }
+            else if (EndsWithNoCase(name, L".lnk")) {
+                e.path = ResolveShortcut(dir + L"\\" + name);
+                if (!EndsWithNoCase(e.path, L".exe")) continue;
+                size_t slash = e.path.find_last_of(L'\\');
+                e.exeName = slash == std::wstring::npos ? e.path : e.path.substr(slash + 1);
+                e.product = name.substr(0, name.size() - 4);
+            }
+            else continue;
+            cur.entries.push_back(e);
+        } while (FindNextFileW(h, &fd));
+        FindClose(h);
+    }
+
+    static std::wstring Reuse(const CatalogDir* old, const std::wstring& path) {
+        if (!old) return std::wstring();
+        for (auto& e : old->entries)
+            if (e.path == path) return e.product;
+        return std::wstring();
+    }
+
+    static std::wstring ReadProductName(const std::wstring& path) {
+        DWORD ignored = 0;
+        DWORD size = GetFileVersionInfoSizeW(path.c_str(), &ignored);
+        if (!size) return std::wstring();
+        std::vector<BYTE> buf(size);
+        if (!GetFileVersionInfoW(path.c_str(), 0, size, buf.data())) return std::wstring();
+        struct LangCp { WORD lang, cp; }*tr = nullptr;
+        UINT len = 0;
+        if (!VerQueryValueW(buf.data(), L"\\VarFileInfo\\Translation", (LPVOID*)&tr, &len) ||
+            len < sizeof(LangCp)) return std::wstring();
+        for (const wchar_t* key : { L"FileDescription", L"ProductName" }) {
+            wchar_t q[96];
+            swprintf(q, 96, L"\\StringFileInfo\\%04x%04x\\%ls", tr->lang, tr->cp, key);
+            wchar_t* val = nullptr;
+            if (VerQueryValueW(buf.data(), q, (LPVOID*)&val, &len) && val && len > 1)
+                return std::wstring(val);
+        }
+        return std::wstring();
+    }
+
+    static std::wstring ResolveShortcut(const std::wstring& lnk) {
+        std::wstring target;
+        IShellLinkW* link = nullptr;
+        if (FAILED(CoCreateInstance(CLSID_ShellLink, NULL, CLSCTX_INPROC_SERVER,
+            IID_IShellLinkW, (void**)&link))) return target;
+        IPersistFile* file = nullptr;
+        if (SUCCEEDED(link->QueryInterface(IID_IPersistFile, (void**)&file))) {
+            wchar_t buf[MAX_PATH];
+            if (SUCCEEDED(file->Load(lnk.c_str(), STGM_READ)) &&
+                SUCCEEDED(link->GetPath(buf, MAX_PATH, NULL, 0)))
+                target = buf;
+            file->Release();
+        }
+        link->Release();
+        return target;
+    }
+};
+
+// =========================================
+// Forward declarations
+// =========================================
+class MainFrame;
+
+// =========================================
+// Tray Icon
+// =========================================
+class TrayIcon : public wxTaskBarIcon {
+public:
+    MainFrame* m_frame;
+    explicit TrayIcon(MainFrame* f) : m_frame(f) {}
+    wxMenu* CreatePopupMenu() override;
+    void OnLeftDClick(wxTaskBarIconEvent&);
+    wxDECLARE_EVENT_TABLE();
+};
+
+// =========================================
+// Add App Dialog
+// =========================================
+class AddAppDialog : public wxDialog {
+public:
+    WorkApp result;
+
+    explicit AddAppDialog(wxWindow* parent)
+        : wxDialog(parent, wxID_ANY, "Add Work App",
+            wxDefaultPosition, wxSize(480, 520),
+            wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER),
+          m_watcher([this] { CallAfter([this] { ApplyDelta(m_watcher.Resolved()); }); })
+    {
+        PERF_SCOPE_NAMED(kPerfDialogBuild, "AddAppDialog");
+        SetBackgroundColour(CLR_BG);
+        auto* main = new wxBoxSizer(wxVERTICAL);
+
+        auto* lbl = new wxStaticText(this, wxID_ANY,
+            "Select a running process, or type an .exe name:");
+        lbl->SetForegroundColour(CLR_TEXT);
+        main->Add(lbl, 0, wxLEFT | wxTOP | wxRIGHT, 12);
+
+        auto* row = new wxBoxSizer(wxHORIZONTAL);
+        m_entry = new wxTextCtrl(this, wxID_ANY, wxEmptyString,
+            wxDefaultPosition, wxDefaultSize, wxTE_PROCESS_ENTER);
+        m_entry->SetBackgroundColour(CLR_PANEL);
+        m_entry->SetForegroundColour(*wxWHITE);
+        row->Add(m_entry, 1, wxEXPAND | wxRIGHT, 6);
+
+        auto* addBtn = new wxButton(this, wxID_ANY, "Add");
+        addBtn->SetBackgroundColour(CLR_RED);
+        addBtn->SetForegroundColour(*wxWHITE);
+        row->Add(addBtn, 0);
+        main->Add(row, 0, wxEXPAND | wxALL, 12);
+
+        auto* lbl2 = new wxStaticText(this, wxID_ANY,
+            "Running processes (double-click to select; search also finds installed apps):");
+        lbl2->SetForegroundColour(CLR_DIM);
+        main->Add(lbl2, 0, wxLEFT | wxBOTTOM, 4);
+
+        // Search bar
+        auto* searchRow = new wxBoxSizer(wxHORIZONTAL);
+        auto* searchLbl = new wxStaticText(this, wxID_ANY, "Search:");
+        searchLbl->SetForegroundColour(CLR_TEXT);
+        searchRow->Add(searchLbl, 0, wxALIGN_CENTER_VERTICAL | wxRIGHT, 6);
+        m_search = new wxTextCtrl(this, wxID_ANY);
+        m_search->SetBackgroundColour(CLR_PANEL);
+        m_search->SetForegroundColour(*wxWHITE);
+        searchRow->Add(m_search, 1);
+        main->Add(searchRow, 0, wxEXPAND | wxLEFT | wxRIGHT | wxBOTTOM, 8);
+
+        m_imgList = new wxImageList(16, 16, true);
+        m_list = new wxListCtrl(this, wxID_ANY, wxDefaultPosition, wxDefaultSize,
+            wxLC_REPORT | wxLC_SINGLE_SEL | wxBORDER_NONE);
+        m_list->SetBackgroundColour(CLR_PANEL);
+        m_list->SetForegroundColour(*wxWHITE);
+        m_list->SetTextColour(*wxWHITE);
+        m_list->SetImageList(m_imgList, wxIMAGE_LIST_SMALL);
+        m_list->InsertColumn(0, "Process", wxLIST_FORMAT_LEFT, 180);
+        m_list->InsertColumn(1, "Path", wxLIST_FORMAT_LEFT, 260);
+        main->Add(m_list, 1, wxEXPAND | wxLEFT | wxRIGHT | wxBOTTOM, 12);
+
+        SetSizer(main);
+
+        // Fill process list, then keep it live from watcher deltas; paths
+        // and icons are patched in as the watcher's worker resolves them
+        ApplyDelta(m_watcher.Poll());
+        m_refresh.SetOwner(this);
+        Bind(wxEVT_TIMER, [this](wxTimerEvent&) { ApplyDelta(m_watcher.Poll()); });
+        m_refresh.Start(2000);
+
+        // Search filter
+        m_search->Bind(wxEVT_TEXT, [this](wxCommandEvent&) {
+            RebuildList(m_search->GetValue().Lower());
+            });
+
+        m_list->Bind(wxEVT_LIST_ITEM_SELECTED, [this](wxListEvent& e) {
+            long itemIdx = e.GetIndex();
+            if (itemIdx >= 0 && itemIdx < m_list->GetItemCount()) {
+                wxListItem item;
+                item.SetId(itemIdx);
+                item.SetColumn(0);
+                item.SetMask(wxLIST_MASK_TEXT);
+                m_list->GetItem(item);
+                m_entry->SetValue(item.GetText());
+            }
+            });
+        m_list->Bind(wxEVT_LIST_ITEM_ACTIVATED, [this](wxListEvent&) { OnAdd(); });
+        addBtn->Bind(wxEVT_BUTTON, [this](wxCommandEvent&) { OnAdd(); });
+        m_entry->Bind(wxEVT_TEXT_ENTER, [this](wxCommandEvent&) { OnAdd(); });
+    }
+
+    ~AddAppDialog() override { m_refresh.Stop(); }
+
+private:
+    wxTextCtrl* m_entry;
+    wxTextCtrl* m_search;
+    wxListCtrl* m_list;
+    wxImageList* m_imgList;
+    ProcessWatcher           m_watcher;
+    wxTimer                  m_refresh;
+    wxString                 m_filter;
+    std::vector<ProcessInfo> m_procs;     // sorted by ProcessLess
+    std::vector<bool>        m_shown;     // parallel to m_procs: row present in m_list
+    std::map<wxString, int>  m_iconIndexCache;
+
+    bool Matches(const ProcessInfo& p) const {
+        return m_filter.IsEmpty() || p.exeName.Lower().Contains(m_filter);
+    }
+
+    // List row of m_procs[i]; rows mirror the shown entries in order.
+    long RowOf(size_t i) const {
+        return (long)std::count(m_shown.begin(), m_shown.begin() + i, true);
+    }
+
+    int IconIndex(const ProcessInfo& p) {
+        auto it = m_iconIndexCache.find(p.exeName);
+        if (it != m_iconIndexCache.end()) {
+            PERF_COUNT(kCtrIconCacheHits, 1);
+            return it->second;
+        }
+        int imgIdx = -1;
+        if (p.hasIcon && p.icon.IsOk()) {
+            wxBitmap bmp(p.icon);
+            if (bmp.IsOk()) {
+                wxImage img = bmp.ConvertToImage().Rescale(16, 16);
+                imgIdx = m_imgList->Add(wxBitmap(img));
+            }
+            m_iconIndexCache[p.exeName] = imgIdx;
+        }
+        return imgIdx;
+    }
+
+    void InsertRow(long row, const ProcessInfo& p) {
+        long idx = m_list->InsertItem(row, p.exeName, IconIndex(p));
+        m_list->SetItem(idx, 1, p.exePath);
+    }
+
+    // Running processes first, then installed-app catalog hits for the
+    // search. Catalog rows always sit below the process rows.
+    void RebuildList(const wxString& filter) {
+        m_filter = filter;
+        m_list->DeleteAllItems();
+        std::set<wxString> listed;
+        for (size_t i = 0; i < m_procs.size(); i++) {
+            m_shown[i] = Matches(m_procs[i]);
+            if (m_shown[i]) InsertRow(m_list->GetItemCount(), m_procs[i]);
+            listed.insert(m_procs[i].exeName.Lower());
+        }
+        if (filter.IsEmpty()) return;
+        for (auto& e : ExeCatalog::Get().Search(filter, 30)) {
+            wxString exe(e.exeName);
+            if (listed.count(exe.Lower())) continue;
+            long idx = m_list->InsertItem(m_list->GetItemCount(), exe, -1);
+            m_list->SetItem(idx, 1, e.product.empty() ? wxString(e.path) : wxString(e.product));
+            m_list->SetItemTextColour(idx, CLR_DIM);
+        }
+    }
+
+    // Patches rows in place so selection and scroll position survive.
+    void ApplyDelta(const ProcessWatcher::Delta& d) {
+        for (auto& name : d.exited) {
+            auto it = std::find_if(m_procs.begin(), m_procs.end(),
+                [&](const ProcessInfo& p) { return p.exeName == name; });
+            if (it == m_procs.end()) continue;
+            size_t i = it - m_procs.begin();
+            if (m_shown[i]) m_list->DeleteItem(RowOf(i));
+            m_procs.erase(it);
+            m_shown.erase(m_shown.begin() + i);
+        }
+        for (auto& p : d.added) {
+            auto it = std::upper_bound(m_procs.begin(), m_procs.end(), p, ProcessLess);
+            size_t i = it - m_procs.begin();
+            bool show = Matches(p);
+            m_procs.insert(it, p);
+            m_shown.insert(m_shown.begin() + i, show);
+            if (show) InsertRow(RowOf(i), p);
+        }
+        for (auto& p : d.resolved) {
+            auto it = std::find_if(m_procs.begin(), m_procs.end(),
+                [&](const ProcessInfo& q) { return q.exeName == p.exeName; });
+            if (it == m_procs.end()) continue;
+            size_t i = it - m_procs.begin();
+            *it = p;
+            if (!m_shown[i]) continue;
+            long row = RowOf(i);
+            m_list->SetItemImage(row, IconIndex(p));
+            m_list->SetItem(row, 1, p.exePath);
+        }
+    }
+
+    void OnAdd() {
+        wxString exe = m_entry->GetValue().Trim();
+        if (exe.IsEmpty()) return;
+        if (!exe.Lower().EndsWith(".exe")) exe += ".exe";
+        result.exeName = exe;
+        result.label = wxFileName(exe).GetName();
+        EndModal(wxID_OK);
+    }
+};
+
+// =========================================
+// Onboarding Wizard
+// =========================================
+class OnboardWizard : public wxWizard {
+public:
+    std::vector<WorkApp> selectedApps;
+
+    explicit OnboardWizard(wxWindow* parent)
+        : wxWizard(parent, wxID_ANY, "WorkTimer - First Run Setup",
+            wxNullBitmap, wxDefaultPosition, wxDEFAULT_DIALOG_STYLE)
+    {
+        PERF_SCOPE_NAMED(kPerfDialogBuild, "OnboardWizard");
+        SetBackgroundColour(CLR_BG);
+
+        // Page 1: Welcome
+        m_p1 = new wxWizardPageSimple(this);
+        m_p1->SetBackgroundColour(CLR_BG);
+        {
+            auto* s = new wxBoxSizer(wxVERTICAL);
+            auto* t = new wxStaticText(m_p1, wxID_ANY, "Welcome to WorkTimer");
+            t->SetForegroundColour(CLR_RED);
+            wxFont f = t->GetFont(); f.SetPointSize(15); f.SetWeight(wxFONTWEIGHT_BOLD);
+            t->SetFont(f);
+            s->Add(t, 0, wxALL, 14);
+            auto* d = new wxStaticText(m_p1, wxID_ANY,
+                "WorkTimer tracks how long you work in specific apps.\n\n"
+                "It watches which app is in focus and automatically\n"
+                "starts and stops the timer for you.\n\n"
+                "This setup takes about 30 seconds.\n"
+                "Click Next to choose your work apps.");
+            d->SetForegroundColour(CLR_TEXT);
+            s->Add(d, 0, wxLEFT, 14);
+            m_p1->SetSizer(s);
+        }
+
+        // Page 2: Pick apps
+        m_p2 = new wxWizardPageSimple(this, m_p1);
+        m_p2->SetBackgroundColour(CLR_BG);
+        {
+            auto* s = new wxBoxSizer(wxVERTICAL);
+            auto* t = new wxStaticText(m_p2, wxID_ANY, "Choose apps to track");
+            t->SetForegroundColour(CLR_RED);
+            wxFont f = t->GetFont(); f.SetWeight(wxFONTWEIGHT_BOLD); f.SetPointSize(11);
+            t->SetFont(f);
+            s->Add(t, 0, wxALL, 12);
+            auto* h = new wxStaticText(m_p2, wxID_ANY,
+                "Check apps you work in. Timer starts when that app is active.");
+            h->SetForegroundColour(CLR_DIM);
+            s->Add(h, 0, wxLEFT | wxBOTTOM, 8);
+
+            // Search box
+            auto* searchRow = new wxBoxSizer(wxHORIZONTAL);
+            auto* searchLbl = new wxStaticText(m_p2, wxID_ANY, "Search:");
+            searchLbl->SetForegroundColour(CLR_TEXT);
+            searchRow->Add(searchLbl, 0, wxALIGN_CENTER_VERTICAL | wxRIGHT, 6);
+            m_search = new wxTextCtrl(m_p2, wxID_ANY);
+            m_search->SetBackgroundColour(CLR_PANEL);
+            m_search->SetForegroundColour(*wxWHITE);
+            searchRow->Add(m_search, 1);
+            s->Add(searchRow, 0, wxEXPAND | wxLEFT | wxRIGHT | wxBOTTOM, 10);
+
+            m_checkList = new wxCheckListBox(m_p2, wxID_ANY);
+            m_checkList->SetBackgroundColour(CLR_PANEL);
+            m_checkList->SetForegroundColour(*wxWHITE);
+            s->Add(m_checkList, 1, wxEXPAND | wxLEFT | wxRIGHT | wxBOTTOM, 12);
+
+            // Listed while the welcome page is up; filled in on arrival.
+            m_scan = std::thread([this] { m_scanned = RunningExeNames(); });
+            Bind(wxEVT_WIZARD_PAGE_CHANGED, [this](wxWizardEvent& e) {
+                if (e.GetPage() == m_p2) FillProcesses();
+                e.Skip();
+                });
+
+            // Live search filter
+            m_search->Bind(wxEVT_TEXT, [this](wxCommandEvent&) {
+                wxString filter = m_search->GetValue().Lower();
+                std::set<wxString> checked;
+                for (unsigned i = 0; i < m_checkList->GetCount(); i++)
+                    if (m_checkList->IsChecked(i))
+                        checked.insert(m_checkList->GetString(i));
+                m_checkList->Clear();
+                for (auto& p : m_procs) {
+                    if (filter.IsEmpty() || p.Lower().Contains(filter)) {
+                        unsigned idx = m_checkList->GetCount();
+                        m_checkList->Append(p);
+                        if (checked.count(p))
+                            m_checkList->Check(idx, true);
+                    }
+                }
+                });
+
+            m_p2->SetSizer(s);
+        }
+
+        // Page 3: Options
+        m_p3 = new wxWizardPageSimple(this, m_p2);
+        m_p3->SetBackgroundColour(CLR_BG);
+        {
+            auto* s = new wxBoxSizer(wxVERTICAL);
+            auto* t = new wxStaticText(m_p3, wxID_ANY, "Preferences");
+            t->SetForegroundColour(CLR_RED);
+            wxFont f = t->GetFont(); f.SetWeight(wxFONTWEIGHT_BOLD); f.SetPointSize(11);
+            t->SetFont(f);
+            s->Add(t, 0, wxALL, 12);
+
+            m_cbTop = new wxCheckBox(m_p3, wxID_ANY, "Always on top (recommended)");
+            m_cbTop->SetValue(true);
+            m_cbTop->SetForegroundColour(CLR_TEXT); m_cbTop->SetBackgroundColour(CLR_BG);
+            s->Add(m_cbTop, 0, wxLEFT | wxBOTTOM, 16);
+
+            m_cbTray = new wxCheckBox(m_p3, wxID_ANY, "Start minimized to system tray");
+            m_cbTray->SetValue(false);
+            m_cbTray->SetForegroundColour(CLR_TEXT); m_cbTray->SetBackgroundColour(CLR_BG);
+            s->Add(m_cbTray, 0, wxLEFT | wxBOTTOM, 16);
+
+            m_cbAlert = new wxCheckBox(m_p3, wxID_ANY, "Flash color alert every 30 min");
+            m_cbAlert->SetValue(true);
+            m_cbAlert->SetForegroundColour(CLR_TEXT); m_cbAlert->SetBackgroundColour(CLR_BG);
+            s->Add(m_cbAlert, 0, wxLEFT | wxBOTTOM, 16);
+
+            auto* done = new wxStaticText(m_p3, wxID_ANY,
+                "Click Finish to start WorkTimer.");
+            done->SetForegroundColour(CLR_DIM);
+            s->Add(done, 0, wxLEFT | wxTOP, 12);
+            m_p3->SetSizer(s);
+        }
+
+        wxWizardPageSimple::Chain(m_p1, m_p2);
+        wxWizardPageSimple::Chain(m_p2, m_p3);
+        GetPageAreaSizer()->Add(m_p1);
+        SetSize(wxSize(500, 440));
+    }
+
+    ~OnboardWizard() override {
+        if (m_scan.joinable()) m_scan.join();
+    }
+
+    wxWizardPage* GetFirstPage() const { return m_p1; }
+    bool startInTray() const { return m_cbTray->GetValue(); }
+    bool alwaysOnTop() const { return m_cbTop->GetValue(); }
+    bool colorAlert()  const { return m_cbAlert->GetValue(); }
+
+    void CollectApps() {
+        selectedApps.clear();
+        // Collect checked names from currently visible list
+        std::set<wxString> checkedNames;
+        for (unsigned i = 0; i < m_checkList->GetCount(); i++)
+            if (m_checkList->IsChecked(i))
+                checkedNames.insert(m_checkList->GetString(i));
+        // Keep process list order
+        for (auto& p : m_procs) {
+            if (checkedNames.count(p)) {
+                WorkApp a;
+                a.exeName = p;
+                a.label = wxFileName(p).GetName();
+                selectedApps.push_back(a);
+            }
+        }
+    }
+
+private:
+    wxWizardPageSimple* m_p1, * m_p2, * m_p3;
+    wxCheckListBox* m_checkList;
+    wxTextCtrl* m_search;
+    wxCheckBox* m_cbTray, * m_cbTop, * m_cbAlert;
+    std::vector<wxString>     m_procs;
+    std::thread               m_scan;
+    std::vector<std::wstring> m_scanned;    // written by m_scan
+
+    // Joins the scan and lists its result once.
+    void FillProcesses() {
+        if (!m_scan.joinable()) return;
+        m_scan.join();
+        for (auto& n : m_scanned) {
+            wxString p(n);
+            if (p == "WorkTimer.exe" || p == "explorer.exe" ||
+                p == "svchost.exe" || p == "System") continue;
+            m_procs.push_back(p);
+            m_checkList->Append(p);
+        }
+        m_scanned.clear();
+    }
+};
+
+// =========================================
+// Diagnostics Dialog
+// =========================================
+class DiagnosticsDialog : public wxDialog {
+public:
+    explicit DiagnosticsDialog(wxWindow* parent)
+        : wxDialog(parent, wxID_ANY, "Diagnostics",
+            wxDefaultPosition, wxSize(560, 400),
+            wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER)
+    {
+        PERF_SCOPE_NAMED(kPerfDialogBuild, "DiagnosticsDialog");
+        SetBackgroundColour(CLR_BG);
+        auto* s = new wxBoxSizer(wxVERTICAL);
+
+        m_cbOn = new wxCheckBox(this, wxID_ANY, "Enable instrumentation");
+        m_cbOn->SetValue(PerfEnabled());
+        m_cbOn->SetForegroundColour(CLR_TEXT); m_cbOn->SetBackgroundColour(CLR_BG);
+        s->Add(m_cbOn, 0, wxLEFT | wxRIGHT | wxTOP, 12);
+
+        m_cbTrace = new wxCheckBox(this, wxID_ANY, "Record trace (Chrome trace-event JSON)");
+        m_cbTrace->SetValue(TraceEnabled());
+        m_cbTrace->SetForegroundColour(CLR_TEXT); m_cbTrace->SetBackgroundColour(CLR_BG);
+        s->Add(m_cbTrace, 0, wxLEFT | wxRIGHT | wxTOP, 12);
+
+        m_tracePath = new wxStaticText(this, wxID_ANY, TraceEnabled() ?
+            TraceRecorder::Get().Path() : DefaultTracePath());
+        m_tracePath->SetForegroundColour(CLR_DIM);
+        s->Add(m_tracePath, 0, wxLEFT | wxRIGHT | wxBOTTOM, 12);
+
+        m_report = new wxTextCtrl(this, wxID_ANY, wxEmptyString,
+            wxDefaultPosition, wxDefaultSize, wxTE_MULTILINE | wxTE_READONLY | wxTE_DONTWRAP);
+        m_report->SetBackgroundColour(CLR_PANEL);
+        m_report->SetForegroundColour(CLR_TEXT);
+        wxFont f = m_report->GetFont(); f.SetFaceName("Consolas");
+        m_report->SetFont(f);
+        s->Add(m_report, 1, wxEXPAND | wxLEFT | wxRIGHT, 12);
+
+        auto* row = new wxBoxSizer(wxHORIZONTAL);
+        auto* refresh = new wxButton(this, wxID_ANY, "Refresh");
+        refresh->SetBackgroundColour(CLR_BLUE); refresh->SetForegroundColour(CLR_TEXT);
+        row->Add(refresh, 0, wxRIGHT, 6);
+        auto* dump = new wxButton(this, wxID_ANY, "Dump to file...");
+        dump->SetBackgroundColour(CLR_BLUE); dump->SetForegroundColour(CLR_TEXT);
+        row->Add(dump, 0);
+        row->AddStretchSpacer();
+        auto* ok = new wxButton(this, wxID_OK, "Close");
+        ok->SetBackgroundColour(CLR_RED); ok->SetForegroundColour(*wxWHITE);
+        row->Add(ok, 0);
+        s->Add(row, 0, wxEXPAND | wxALL, 12);
+        SetSizer(s);
+
+        m_report->SetValue(Report());
+
+        m_cbOn->Bind(wxEVT_CHECKBOX, [this](wxCommandEvent&) {
+            PerfEnable(m_cbOn->GetValue());
+            });
+        m_cbTrace->Bind(wxEVT_CHECKBOX, [this](wxCommandEvent&) {
+            if (!m_cbTrace->GetValue()) { TraceRecorder::Get().Stop(); return; }
+            if (!TraceRecorder::Get().Start(DefaultTracePath())) {
+                m_cbTrace->SetValue(false);
+                wxMessageBox("Could not open " + DefaultTracePath(), "Diagnostics");
+                return;
+            }
+            m_tracePath->SetLabel(TraceRecorder::Get().Path());
+            });
+        refresh->Bind(wxEVT_BUTTON, [this](wxCommandEvent&) {
+            m_report->SetValue(Report());
+            });
+        dump->Bind(wxEVT_BUTTON, [this](wxCommandEvent&) {
+            wxString path = wxFileSelector("Save diagnostics", wxEmptyString,
+                "work_timer_perf.txt", "txt", "Text files (*.txt)|*.txt",
+                wxFD_SAVE | wxFD_OVERWRITE_PROMPT, this);
+            if (!path.IsEmpty() && !PerfDump(path))
+                wxMessageBox("Could not write " + path, "Diagnostics");
+            });
+    }
+
+    static wxString DefaultTracePath() {
+        return wxFileName(wxStandardPaths::Get().GetUserDataDir(),
+            "work_timer_trace.json").GetFullPath();
+    }
+
+    static wxString Report() {
+        return PerfReport() + "\n" + HistoryArchive::Get().Report();
+    }
+
+private:
+    wxCheckBox*   m_cbOn;
+    wxCheckBox*   m_cbTrace;
+    wxStaticText* m_tracePath;
+    wxTextCtrl*   m_report;
+};
+
+// =========================================
+// Rules Dialog
+// =========================================
+class RulesDialog : public wxDialog {
+public:
+    RulesDialog(wxWindow* parent, const std::vector<wxString>& rules)
+        : wxDialog(parent, wxID_ANY, "Tracking rules",
+            wxDefaultPosition, wxSize(520, 380),
+            wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER)
+    {
+        PERF_SCOPE_NAMED(kPerfDialogBuild, "RulesDialog");
+        SetBackgroundColour(CLR_BG);
+        auto* s = new wxBoxSizer(wxVERTICAL);
+
+        auto* help = new wxStaticText(this, wxID_ANY,
+            "One rule per line, first match wins. Unmatched apps use the app list.\n"
+            "<exe|*> [title~text] [title!~text] [days=mon-fri] [time=HH:MM-HH:MM] -> <category|ignore>\n"
+            "e.g.  chrome.exe title~jira -> Jira      * days=sat,sun -> ignore");
+        help->SetForegroundColour(CLR_DIM);
+        s->Add(help, 0, wxALL, 12);
+
+        wxString text;
+        for (auto& r : rules) text += r + "\n";
+        m_text = new wxTextCtrl(this, wxID_ANY, text, wxDefaultPosition, wxDefaultSize,
+            wxTE_MULTILINE | wxTE_DONTWRAP);
+        m_text->SetBackgroundColour(CLR_PANEL);
+        m_text->SetForegroundColour(CLR_TEXT);
+        wxFont f = m_text->GetFont(); f.SetFaceName("Consolas");
+        m_text->SetFont(f);
+        s->Add(m_text, 1, wxEXPAND | wxLEFT | wxRIGHT, 12);
+
+        auto* row = new wxBoxSizer(wxHORIZONTAL);
+        row->AddStretchSpacer();
+        auto* cancel = new wxButton(this, wxID_CANCEL, "Cancel");
+        cancel->SetBackgroundColour(CLR_PANEL); cancel->SetForegroundColour(CLR_TEXT);
+        row->Add(cancel, 0, wxRIGHT, 6);
+        auto* ok = new wxButton(this, wxID_OK, "Save");
+        ok->SetBackgroundColour(CLR_RED); ok->SetForegroundColour(*wxWHITE);
+        row->Add(ok, 0);
+        s->Add(row, 0, wxEXPAND | wxALL, 12);
+        SetSizer(s);
+
+        // Only close on a table that compiles.
+        ok->Bind(wxEVT_BUTTON, [this](wxCommandEvent& e) {
+            RuleTable t;
+            std::wstring err;
+            if (!t.Compile(RuleLines(Rules()), &err)) {
+                wxMessageBox(wxString(err), "Tracking rules", wxOK | wxICON_WARNING, this);
+                return;
+            }
+            e.Skip();
+            });
+    }
+
+    std::vector<wxString> Rules() const {
+        std::vector<wxString> out;
+        for (auto& line : wxSplit(m_text->GetValue(), '\n')) {
+            wxString l = line;
+            l.Trim().Trim(false);
+            if (!l.IsEmpty()) out.push_back(l);
+        }
+        return out;
+    }
+
+private:
+    wxTextCtrl* m_text;
+};
+
+// =========================================
+// History Dialog
+// =========================================
+// Bars of tracked time per pixel column over a pannable, zoomable range
+// (minutes to decades) of local time. Wheel zooms around the cursor, drag
+// pans, double-click fits all history.
+class TimelineView : public wxWindow {
+public:
+    std::function<void()> onView;   // after every pan or zoom
+
+    TimelineView(wxWindow* parent, const BucketPyramid& pyr)
+        : wxWindow(parent, wxID_ANY, wxDefaultPosition, wxSize(-1, 150)), m_pyr(pyr)
+    {
+        SetBackgroundStyle(wxBG_STYLE_PAINT);
+        SetBackgroundColour(CLR_PANEL);
+        Bind(wxEVT_PAINT, &TimelineView::OnPaint, this);
+        Bind(wxEVT_MOUSEWHEEL, &TimelineView::OnWheel, this);
+        Bind(wxEVT_LEFT_DOWN, &TimelineView::OnDown, this);
+        Bind(wxEVT_MOTION, &TimelineView::OnMotion, this);
+        Bind(wxEVT_LEFT_UP, [this](wxMouseEvent&) { if (HasCapture()) ReleaseMouse(); });
+        Bind(wxEVT_MOUSE_CAPTURE_LOST, [](wxMouseCaptureLostEvent&) {});
+        Bind(wxEVT_LEFT_DCLICK, [this](wxMouseEvent&) { FitAll(); });
+        FitAll();
+    }
+
+    double From() const { return m_from; }
+    double Span() const { return m_span; }
+
+    void SetView(double from, double span) {
+        m_span = std::min(std::max(span, kMinSpan), kMaxSpan);
+        m_from = from;
+        Refresh(false);
+        if (onView) onView();
+    }
+
+    // All history, or today when there is none.
+    void FitAll() {
+        if (m_pyr.Empty()) {
+            int64_t now = LocalSeconds((int64_t)time(nullptr));
+            SetView((double)(FloorDiv(now, 86400) * 86400), 86400);
+            return;
+        }
+        double span = (double)(m_pyr.Last() - m_pyr.First());
+        SetView(m_pyr.First() - span * 0.02, span * 1.04);
+    }
+
+private:
+    static constexpr double kMinSpan = 30 * 60;
+    static constexpr double kMaxSpan = 30 * 366 * 86400.0;
+    static const int kAxisH = 18;
+
+    const BucketPyramid& m_pyr;
+    double m_from = 0;
+    double m_span = 86400;
+    int    m_dragX = 0;
+    double m_dragFrom = 0;
+    std::vector<double> m_cols;     // tracked seconds per pixel column
+
+    double PerPixel() const { return m_span / std::max(1, GetClientSize().x); }
+
+    void OnWheel(wxMouseEvent& e) {
+        double steps = (double)e.GetWheelRotation() / std::max(1, e.GetWheelDelta());
+        double span = std::min(std::max(m_span * std::pow(1.25, -steps), kMinSpan), kMaxSpan);
+        double at = m_from + e.GetX() * PerPixel();
+        SetView(at - (at - m_from) * span / m_span, span);
+    }
+
+    void OnDown(wxMouseEvent& e) {
+        m_dragX = e.GetX();
+        m_dragFrom = m_from;
+        CaptureMouse();
+    }
+
+    void OnMotion(wxMouseEvent& e) {
+        if (HasCapture()) SetView(m_dragFrom - (e.GetX() - m_dragX) * PerPixel(), m_span);
+    }
+
+    // Label positions: fixed steps up to a week, calendar months and
+    // years beyond that. About one label per 90 px.
+    void Ticks(std::vector<std::pair<int64_t, wxString>>& out) const {
+        static const int64_t steps[] = { 60, 300, 900, 1800, 3600, 3 * 3600, 6 * 3600,
+            12 * 3600, 86400, 7 * 86400 };
+        static const int months[] = { 1, 3, 6, 12, 24, 60, 120 };
+        double want = PerPixel() * 90;
+        int64_t from = (int64_t)std::floor(m_from), to = (int64_t)std::ceil(m_from + m_span);
+        int y, m, d;
+        for (int64_t step : steps) {
+            if (step < want) continue;
+            int64_t off = step == 7 * 86400 ? 3 * 86400 : 0;
+            for (int64_t t = (FloorDiv(from + off, step) + 1) * step - off; t < to; t += step) {
+                CivilFromDays(FloorDiv(t, 86400), y, m, d);
+                int64_t s = t - FloorDiv(t, 86400) * 86400;
+                // Midnights show the date.
+                out.push_back({ t, s ?
+                    wxString::Format("%02d:%02d", (int)(s / 3600), (int)(s % 3600 / 60)) :
+                    wxString::Format("%02d-%02d", m, d) });
+            }
+            return;
+        }
+        int per = months[0];
+        for (int n : months) { per = n; if (n * 30 * 86400.0 >= want) break; }
+        CivilFromDays(FloorDiv(from, 86400), y, m, d);
+        for (int i = ((y * 12 + m - 1) / per + 1) * per; ; i += per) {
+            int64_t t = DaysFromCivil(i / 12, i % 12 + 1, 1) * 86400;
+            if (t >= to) break;
+            out.push_back({ t, per >= 12 ? wxString::Format("%d", i / 12) :
+                wxString::Format("%04d-%02d", i / 12, i % 12 + 1) });
+        }
+    }
+
+    void OnPaint(wxPaintEvent&) {
+        PERF_SCOPE(kPerfTimelinePaint);
+        wxAutoBufferedPaintDC dc(this);
+        dc.SetBackground(wxBrush(CLR_PANEL));
+        dc.Clear();
+        wxSize sz = GetClientSize();
+        int h = sz.y - kAxisH;
+        if (sz.x <= 0 || h <= 0) return;
+
+        double spp = PerPixel();
+        m_pyr.Columns(m_from, m_span, sz.x, m_cols);
+
+        std::vector<std::pair<int64_t, wxString>> ticks;
+        Ticks(ticks);
+        dc.SetPen(wxPen(CLR_BLUE));
+        dc.SetTextForeground(CLR_DIM);
+        for (auto& t : ticks) {
+            int x = (int)((t.first - m_from) / spp);
+            dc.DrawLine(x, 0, x, h);
+            dc.DrawText(t.second, x + 3, h + 2);
+        }
+
+        dc.SetPen(*wxTRANSPARENT_PEN);
+        dc.SetBrush(wxBrush(CLR_RED));
+        for (int c = 0; c < sz.x; c++) {
+            if (m_cols[c] <= 0) continue;
+            int bh = std::max(1, (int)(std::min(1.0, m_cols[c] / spp) * h));
+            dc.DrawRectangle(c, h - bh, 1, bh);
+        }
+    }
+};
+
+// One calendar year of days, a column per week with Monday on top,
+// shaded by tracked time. Clicking a day calls onPick with its start.
+class HeatmapView : public wxWindow {
+public:
+    std::function<void(int64_t)> onPick;
+
+    HeatmapView(wxWindow* parent, const BucketPyramid& pyr)
+        : wxWindow(parent, wxID_ANY, wxDefaultPosition,
+            wxSize(kLeft + 54 * kCell, kTop + 7 * kCell)), m_pyr(pyr)
+    {
+        SetBackgroundStyle(wxBG_STYLE_PAINT);
+        SetBackgroundColour(CLR_BG);
+        Bind(wxEVT_PAINT, &HeatmapView::OnPaint, this);
+        Bind(wxEVT_LEFT_DOWN, &HeatmapView::OnClick, this);
+        Bind(wxEVT_MOTION, &HeatmapView::OnMotion, this);
+    }
+
+    void SetYear(int year) {
+        if (year == m_year) return;
+        m_year = year;
+        m_hover = -1;
+        m_jan1 = DaysFromCivil(year, 1, 1);
+        m_days = (int)(DaysFromCivil(year + 1, 1, 1) - m_jan1);
+        m_secs.assign(m_days, 0);
+        m_pyr.ForEach(BucketPyramid::kDay, m_jan1 * 86400, (m_jan1 + m_days) * 86400,
+            [&](int64_t start, uint32_t secs) { m_secs[(size_t)(start / 86400 - m_jan1)] = secs; });
+        Refresh(false);
+    }
+
+private:
+    static const int kCell = 13;
+    static const int kLeft = 30;
+    static const int kTop = 16;
+
+    const BucketPyramid& m_pyr;
+    int     m_year = 0;
+    int64_t m_jan1 = 0;     // days since 1970
+    int     m_days = 0;
+    int     m_hover = -1;
+    std::vector<uint32_t> m_secs;
+
+    // Grid cell of a day of the year.
+    wxRect Cell(int i) const {
+        int64_t day = m_jan1 + i;
+        int col = (int)(FloorDiv(day + 3, 7) - FloorDiv(m_jan1 + 3, 7));
+        int row = (int)(day + 3 - FloorDiv(day + 3, 7) * 7);
+        return wxRect(kLeft + col * kCell, kTop + row * kCell, kCell - 2, kCell - 2);
+    }
+
+    int DayAt(const wxPoint& p) const {
+        for (int i = 0; i < m_days; i++)
+            if (Cell(i).Contains(p)) return i;
+        return -1;
+    }
+
+    static wxColour Shade(uint32_t secs) {
+        if (!secs) return CLR_PANEL;
+        double f = std::min(1.0, 0.25 + secs / (8.0 * 3600) * 0.75);
+        wxColour a = CLR_PANEL, b = CLR_RED;
+        return wxColour((unsigned char)(a.Red() + (b.Red() - a.Red()) * f),
+            (unsigned char)(a.Green() + (b.Green() - a.Green()) * f),
+            (unsigned char)(a.Blue() + (b.Blue() - a.Blue()) * f));
+    }
+
+    void OnPaint(wxPaintEvent&) {
+        wxAutoBufferedPaintDC dc(this);
+        dc.SetBackground(wxBrush(CLR_BG));
+        dc.Clear();
+        dc.SetTextForeground(CLR_DIM);
+        dc.DrawText(wxString::Format("%d", m_year), 0, 0);
+        static const char* const kMonths[] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+            "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+        int y, m, d;
+        for (int i = 0; i < m_days; i++) {
+            CivilFromDays(m_jan1 + i, y, m, d);
+            if (d == 1) dc.DrawText(kMonths[m - 1], Cell(i).x, 0);
+        }
+        dc.SetPen(*wxTRANSPARENT_PEN);
+        for (int i = 0; i < m_days; i++) {
+            dc.SetBrush(wxBrush(Shade(m_secs[i])));
+            dc.DrawRectangle(Cell(i));
+        }
+    }
+
+    void OnClick(wxMouseEvent& e) {
+        int i = DayAt(e.GetPosition());
+        if (i >= 0 && onPick) onPick((m_jan1 + i) * 86400);
+    }
+
+    void OnMotion(wxMouseEvent& e) {
+        int i = DayAt(e.GetPosition());
+        if (i == m_hover) return;
+        m_hover = i;
+        if (i < 0) { SetToolTip(wxEmptyString); return; }
+        char clock[16];
+        FormatClock((int)m_secs[i], clock);
+        SetToolTip(FormatLocal((m_jan1 + i) * 86400).Left(10) + "  " + clock);
+    }
+};
+
+class HistoryDialog : public wxDialog {
+public:
+    HistoryDialog(wxWindow* parent, const BucketPyramid& pyr)
+        : wxDialog(parent, wxID_ANY, "History",
+            wxDefaultPosition, wxSize(800, 420),
+            wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER), m_pyr(pyr)
+    {
+        PERF_SCOPE_NAMED(kPerfDialogBuild, "HistoryDialog");
+        SetBackgroundColour(CLR_BG);
+        auto* s = new wxBoxSizer(wxVERTICAL);
+
+        auto* help = new wxStaticText(this, wxID_ANY,
+            "Wheel to zoom, drag to pan, double-click to show everything. "
+            "Click a day below to open it.");
+        help->SetForegroundColour(CLR_DIM);
+        s->Add(help, 0, wxLEFT | wxRIGHT | wxTOP, 12);
+        m_range = new wxStaticText(this, wxID_ANY, wxEmptyString);
+        m_range->SetForegroundColour(CLR_TEXT);
+        s->Add(m_range, 0, wxALL, 12);
+
+        m_timeline = new TimelineView(this, pyr);
+        s->Add(m_timeline, 1, wxEXPAND | wxLEFT | wxRIGHT, 12);
+        m_heatmap = new HeatmapView(this, pyr);
+        s->Add(m_heatmap, 0, wxALIGN_CENTER | wxALL, 12);
+        SetSizer(s);
+
+        m_timeline->onView = [this] { ViewChanged(); };
+        m_heatmap->onPick = [this](int64_t day) { m_timeline->SetView((double)day, 86400); };
+        ViewChanged();
+    }
+
+private:
+    const BucketPyramid& m_pyr;
+    wxStaticText* m_range;
+    TimelineView* m_timeline;
+    HeatmapView*  m_heatmap;
+
+    // Range and total for the view; the heatmap follows its middle.
+    void ViewChanged() {
+        int64_t from = (int64_t)m_timeline->From();
+        int64_t to = (int64_t)(m_timeline->From() + m_timeline->Span());
+        uint64_t secs = 0;
+        m_pyr.ForEach(BucketPyramid::LevelFor((to - from) / 400.0), from, to,
+            [&](int64_t, uint32_t v) { secs += v; });
+        char clock[16];
+        FormatClock((int)std::min<uint64_t>(secs, std::numeric_limits<int>::max()), clock);
+        m_range->SetLabel(FormatLocal(from) + "  \u2013  " + FormatLocal(to) +
+            "      " + clock + " tracked");
+        int y, m, d;
+        CivilFromDays(FloorDiv((from + to) / 2, 86400), y, m, d);
+        m_heatmap->SetYear(y);
+    }
+};
+
+// =========================================
+// Sessions Dialog
+// =========================================
+// "YYYY-MM-DD" and "HH:MM" fields of the session browser.
+bool ParseDay(const wxString& text, int& y, int& m, int& d) {
+    auto parts = wxSplit(text, '-');
+    long v[3];
+    if (parts.size() != 3) return false;
+    for (int i = 0; i < 3; i++)
+        if (!parts[i].ToLong(&v[i])) return false;
+    if (v[0] < 2000 || v[0] > 2100 || v[1] < 1 || v[1] > 12 || v[2] < 1 || v[2] > 31) return false;
+    y = (int)v[0]; m = (int)v[1]; d = (int)v[2];
+    return true;
+}
+
+bool ParseHourMinute(const wxString& text, int& h, int& m) {
+    long hh, mm;
+    if (!text.BeforeFirst(':').ToLong(&hh) || !text.AfterFirst(':').ToLong(&mm)) return false;
+    if (hh < 0 || hh > 23 || mm < 0 || mm > 59) return false;
+    h = (int)hh; m = (int)mm;
+    return true;
+}
+
+// Virtual report over the last SessionIndex::Select(). Rows are fetched
+// as they are painted, so only the visible ones are ever decoded.
+class SessionList : public wxListCtrl {
+public:
+    SessionList(wxWindow* parent, SessionIndex& index)
+        : wxListCtrl(parent, wxID_ANY, wxDefaultPosition, wxDefaultSize,
+            wxLC_REPORT | wxLC_VIRTUAL | wxLC_SINGLE_SEL | wxBORDER_NONE), m_index(index)
+    {
+        SetBackgroundColour(CLR_PANEL);
+        SetForegroundColour(*wxWHITE);
+        SetTextColour(*wxWHITE);
+        InsertColumn(0, "Date", wxLIST_FORMAT_LEFT, 90);
+        InsertColumn(1, "End", wxLIST_FORMAT_LEFT, 50);
+        InsertColumn(2, "Duration", wxLIST_FORMAT_RIGHT, 70);
+        InsertColumn(3, "App", wxLIST_FORMAT_LEFT, 160);
+        InsertColumn(4, "Category", wxLIST_FORMAT_LEFT, 110);
+        InsertColumn(5, "Source", wxLIST_FORMAT_LEFT, 90);
+    }
+
+    void Reset(size_t rows) {
+        m_row = -1;
+        SetItemCount((long)rows);
+        Refresh();
+    }
+
+    long Selected() const { return GetNextItem(-1, wxLIST_NEXT_ALL, wxLIST_STATE_SELECTED); }
+
+    bool Get(long item, HistRecord& out) const {
+        if (!Fetch(item)) return false;
+        out = m_rec;
+        return true;
+    }
+
+protected:
+    wxString OnGetItemText(long item, long col) const override {
+        if (!Fetch(item)) return wxEmptyString;
+        switch (col) {
+        case 0: return m_session.date;
+        case 1: return m_session.endTime;
+        case 2: {
+            char clock[16];
+            FormatClock(m_session.duration, clock);
+            return clock;
+        }
+        case 3: return m_session.appName;
+        case 4: return m_session.category;
+        default: return m_session.source;
+        }
+    }
+
+private:
+    SessionIndex&      m_index;
+    mutable long       m_row = -1;      // cells are asked for a row at a time
+    mutable HistRecord m_rec;
+    mutable Session    m_session;
+
+    bool Fetch(long item) const {
+        if (item == m_row) return true;
+        m_row = -1;
+        if (item < 0 || !m_index.Row((size_t)item, m_rec)) return false;
+        m_session = ToSession(m_rec);
+        m_row = item;
+        return true;
+    }
+};
+
+// One session's fields. Fields left alone keep the stored seconds.
+class SessionEditDialog : public wxDialog {
+public:
+    HistRecord result;
+
+    SessionEditDialog(wxWindow* parent, const HistRecord& rec)
+        : wxDialog(parent, wxID_ANY, "Edit Session",
+            wxDefaultPosition, wxSize(360, 320)), result(rec), m_orig(ToSession(rec))
+    {
+        PERF_SCOPE_NAMED(kPerfDialogBuild, "SessionEditDialog");
+        SetBackgroundColour(CLR_BG);
+        auto* s = new wxBoxSizer(wxVERTICAL);
+        m_app = Field(s, "App:", m_orig.appName);
+        m_date = Field(s, "Date (YYYY-MM-DD):", m_orig.date);
+        m_end = Field(s, "End (HH:MM):", m_orig.endTime);
+        m_mins = Field(s, "Duration (min):", wxString::Format("%d", m_orig.duration / 60));
+        m_cat = Field(s, "Category:", m_orig.category);
+
+        s->AddStretchSpacer();
+        auto* row = new wxBoxSizer(wxHORIZONTAL);
+        row->AddStretchSpacer();
+        auto* cancel = new wxButton(this, wxID_CANCEL, "Cancel");
+        cancel->SetBackgroundColour(CLR_PANEL); cancel->SetForegroundColour(CLR_TEXT);
+        row->Add(cancel, 0, wxRIGHT, 6);
+        auto* ok = new wxButton(this, wxID_OK, "Save");
+        ok->SetBackgroundColour(CLR_RED); ok->SetForegroundColour(*wxWHITE);
+        row->Add(ok, 0);
+        s->Add(row, 0, wxEXPAND | wxALL, 12);
+        SetSizer(s);
+
+        ok->Bind(wxEVT_BUTTON, [this](wxCommandEvent& e) {
+            if (!Collect()) {
+                wxMessageBox("Check the app name, date, end time and duration.",
+                    "Edit Session", wxOK | wxICON_WARNING, this);
+                return;
+            }
+            e.Skip();
+            });
+    }
+
+private:
+    Session     m_orig;
+    wxTextCtrl* m_app;
+    wxTextCtrl* m_date;
+    wxTextCtrl* m_end;
+    wxTextCtrl* m_mins;
+    wxTextCtrl* m_cat;
+
+    wxTextCtrl* Field(wxSizer* s, const wxString& label, const wxString& value) {
+        auto* row = new wxBoxSizer(wxHORIZONTAL);
+        auto* lbl = new wxStaticText(this, wxID_ANY, label);
+        lbl->SetForegroundColour(CLR_TEXT);
+        row->Add(lbl, 1, wxALIGN_CENTER_VERTICAL);
+        auto* t = new wxTextCtrl(this, wxID_ANY, value, wxDefaultPosition, wxSize(170, -1));
+        t->SetBackgroundColour(CLR_PANEL);
+        t->SetForegroundColour(*wxWHITE);
+        row->Add(t, 0);
+        s->Add(row, 0, wxEXPAND | wxLEFT | wxRIGHT | wxTOP, 12);
+        return t;
+    }
+
+    bool Collect() {
+        wxString app = m_app->GetValue();
+        wxString cat = m_cat->GetValue();
+        app.Trim().Trim(false);
+        cat.Trim().Trim(false);
+        long mins = 0;
+        if (app.IsEmpty() || !m_mins->GetValue().ToLong(&mins) || mins <= 0 || mins > 7 * 24 * 60)
+            return false;
+
+        int64_t end = result.End();
+        if (m_date->GetValue() != m_orig.date || m_end->GetValue() != m_orig.endTime) {
+            int y, mo, d, h, mi;
+            if (!ParseDay(m_date->GetValue(), y, mo, d) || !ParseHourMinute(m_end->GetValue(), h, mi))
+                return false;
+            end = LocalTicks(y, mo, d, h, mi, 0);
+            if (end < 0) return false;
+        }
+        if (mins != m_orig.duration / 60) result.dur = (uint32_t)mins * 60;
+        result.start = end - result.dur;
+        result.app = app.ToStdWstring();
+        result.category = cat.ToStdWstring();
+        return true;
+    }
+};
+
+// Every session, this month's and archived, with edit, delete and undo.
+// Changes go through Tracker::EditSession; undo applies the inverse edit
+// and lasts as long as the dialog.
+class SessionsDialog : public wxDialog {
+public:
+    SessionsDialog(wxWindow* parent, Tracker& trk)
+        : wxDialog(parent, wxID_ANY, "Sessions",
+            wxDefaultPosition, wxSize(680, 520),
+            wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER), m_trk(trk)
+    {
+        PERF_SCOPE_NAMED(kPerfDialogBuild, "SessionsDialog");
+        SetBackgroundColour(CLR_BG);
+        {
+            wxBusyCursor busy;
+            m_index.Build(m_trk.sessions);
+        }
+        auto* s = new wxBoxSizer(wxVERTICAL);
+
+        auto* filter = new wxBoxSizer(wxHORIZONTAL);
+        m_app = new wxChoice(this, wxID_ANY);
+        m_app->SetBackgroundColour(CLR_PANEL); m_app->SetForegroundColour(*wxWHITE);
+        filter->Add(m_app, 1, wxALIGN_CENTER_VERTICAL | wxRIGHT, 12);
+        m_from = DateField(filter, "From:");
+        m_to = DateField(filter, "To:");
+        s->Add(filter, 0, wxEXPAND | wxALL, 12);
+
+        m_list = new SessionList(this, m_index);
+        s->Add(m_list, 1, wxEXPAND | wxLEFT | wxRIGHT, 12);
+
+        auto* row = new wxBoxSizer(wxHORIZONTAL);
+        m_count = new wxStaticText(this, wxID_ANY, wxEmptyString);
+        m_count->SetForegroundColour(CLR_DIM);
+        row->Add(m_count, 1, wxALIGN_CENTER_VERTICAL);
+        m_undoBtn = Button(row, "Undo");
+        auto* edit = Button(row, "Edit...");
+        auto* del = Button(row, "Delete");
+        auto* close = new wxButton(this, wxID_OK, "Close");
+        close->SetBackgroundColour(CLR_RED); close->SetForegroundColour(*wxWHITE);
+        row->Add(close, 0);
+        s->Add(row, 0, wxEXPAND | wxALL, 12);
+        SetSizer(s);
+
+        FillApps();
+        Reselect();
+
+        m_app->Bind(wxEVT_CHOICE, [this](wxCommandEvent&) { Reselect(); });
+        m_from->Bind(wxEVT_TEXT_ENTER, [this](wxCommandEvent&) { Reselect(); });
+        m_to->Bind(wxEVT_TEXT_ENTER, [this](wxCommandEvent&) { Reselect(); });
+        // Date and App sort; a second click reverses.
+        m_list->Bind(wxEVT_LIST_COL_CLICK, [this](wxListEvent& e) {
+            if (e.GetColumn() != 0 && e.GetColumn() != 3) return;
+            auto sort = e.GetColumn() == 3 ? SessionIndex::kByApp : SessionIndex::kByDate;
+            m_desc = sort == m_sort ? !m_desc : sort == SessionIndex::kByDate;
+            m_sort = sort;
+            Reselect();
+            });
+        m_list->Bind(wxEVT_LIST_ITEM_ACTIVATED, [this](wxListEvent&) { OnEdit(); });
+        m_list->Bind(wxEVT_LIST_KEY_DOWN, [this](wxListEvent& e) {
+            if (e.GetKeyCode() == WXK_DELETE) OnDelete();
+            else e.Skip();
+            });
+        Bind(wxEVT_CHAR_HOOK, [this](wxKeyEvent& e) {
+            if (e.ControlDown() && e.GetKeyCode() == 'Z') OnUndo();
+            else e.Skip();
+            });
+        m_undoBtn->Bind(wxEVT_BUTTON, [this](wxCommandEvent&) { OnUndo(); });
+        edit->Bind(wxEVT_BUTTON, [this](wxCommandEvent&) { OnEdit(); });
+        del->Bind(wxEVT_BUTTON, [this](wxCommandEvent&) { OnDelete(); });
+    }
+
+private:
+    // An applied edit; a missing side is an add or a delete.
+    struct Change {
+        bool       hadOld;
+        bool       hadNew;
+        HistRecord old;
+        HistRecord now;
+    };
+
+    Tracker&            m_trk;
+    SessionIndex        m_index;
+    SessionIndex::Sort  m_sort = SessionIndex::kByDate;
+    bool                m_desc = true;      // newest first
+    std::vector<Change> m_undo;
+    wxChoice*     m_app;
+    wxTextCtrl*   m_from;
+    wxTextCtrl*   m_to;
+    SessionList*  m_list;
+    wxStaticText* m_count;
+    wxButton*     m_undoBtn;
+
+    wxTextCtrl* DateField(wxSizer* row, const wxString& label) {
+        auto* lbl = new wxStaticText(this, wxID_ANY, label);
+        lbl->SetForegroundColour(CLR_TEXT);
+        row->Add(lbl, 0, wxALIGN_CENTER_VERTICAL | wxRIGHT, 6);
+        auto* t = new wxTextCtrl(this, wxID_ANY, wxEmptyString,
+            wxDefaultPosition, wxSize(90, -1), wxTE_PROCESS_ENTER);
+        t->SetBackgroundColour(CLR_PANEL);
+        t->SetForegroundColour(*wxWHITE);
+        t->SetToolTip("YYYY-MM-DD, Enter to apply");
+        row->Add(t, 0, wxALIGN_CENTER_VERTICAL | wxRIGHT, 12);
+        return t;
+    }
+
+    wxButton* Button(wxSizer* row, const wxString& label) {
+        auto* b = new wxButton(this, wxID_ANY, label);
+        b->SetBackgroundColour(CLR_BLUE); b->SetForegroundColour(CLR_TEXT);
+        row->Add(b, 0, wxRIGHT, 6);
+        return b;
+    }
+
+    // App names from the index, keeping the current pick if it's still there.
+    void FillApps() {
+        wxString cur = m_app->GetSelection() > 0 ? m_app->GetStringSelection() : wxString();
+        m_app->Clear();
+        m_app->Append("All apps");
+        int sel = 0;
+        for (auto& a : m_index.Apps()) {
+            int i = m_app->Append(wxString(a));
+            if (!cur.IsEmpty() && cur == a) sel = i;
+        }
+        m_app->SetSelection(sel);
+    }
+
+    void Reselect() {
+        SessionIndex::Filter f;
+        f.app = m_app->GetSelection() - 1;
+        int y, m, d;
+        if (ParseDay(m_from->GetValue(), y, m, d)) f.from = LocalTicks(y, m, d, 0, 0, 0);
+        if (ParseDay(m_to->GetValue(), y, m, d)) f.to = LocalTicks(y, m, d + 1, 0, 0, 0);
+        size_t n = m_index.Select(f, m_sort, m_desc);
+        m_list->Reset(n);
+        m_count->SetLabel(wxString::Format("%llu sessions", (unsigned long long)n));
+        m_undoBtn->Enable(!m_undo.empty());
+    }
+
+    // Applies old -> repl, refreshes the months it touched and, unless
+    // undoing, records the inverse.
+    bool Apply(const HistRecord* old, const HistRecord* repl, bool record) {
+        HistRecord stored;
+        if (!m_trk.EditSession(old, repl, &stored)) {
+            wxMessageBox("Could not save the change.", "Sessions", wxOK | wxICON_WARNING, this);
+            return false;
+        }
+        if (record)
+            m_undo.push_back({ old != nullptr, repl != nullptr,
+                old ? *old : HistRecord(), repl ? stored : HistRecord() });
+        std::set<wxString> months;
+        if (old) months.insert(HistoryArchive::MonthOf(*old));
+        if (repl) months.insert(HistoryArchive::MonthOf(stored));
+        {
+            wxBusyCursor busy;
+            m_index.Refresh(months, m_trk.sessions);
+        }
+        FillApps();
+        Reselect();
+        return true;
+    }
 
-            int imgIdx = -1;
-            auto it = m_iconIndexCache.find(p.exeName);
-            if (it != m_iconIndexCache.end()) {
-                imgIdx = it->second;
-            }
-            else if (p.hasIcon && p.icon.IsOk()) {
-                wxBitmap bmp(p.icon);
-                if (bmp.IsOk()) {
-                    wxImage img = bmp.ConvertToImage().Rescale(16, 16);
-                    imgIdx = m_imgList->Add(wxBitmap(img));
-                }
-                m_iconIndexCache[p.exeName] = imgIdx;
-            }
+    void OnEdit() {
+        HistRecord old;
+        if (!m_list->Get(m_list->Selected(), old)) return;
+        SessionEditDialog ed(this, old);
+        if (ed.ShowModal() != wxID_OK || ed.result == old) return;
+        Apply(&old, &ed.result, true);
+    }
 
-            long idx = m_list->InsertItem(m_list->GetItemCount(), p.exeName, imgIdx);
-            m_list->SetItem(idx, 1, p.exePath);
-        }
+    void OnDelete() {
+        HistRecord old;
+        if (!m_list->Get(m_list->Selected(), old)) return;
+        Apply(&old, nullptr, true);
     }
 
-    void OnAdd() {
-        wxString exe = m_entry->GetValue().Trim();
-        if (exe.IsEmpty()) return;
-        if (!exe.Lower().EndsWith(".exe")) exe += ".exe";
-        result.exeName = exe;
-        result.label = wxFileName(exe).GetName();
-        EndModal(wxID_OK);
+    void OnUndo() {
+        if (m_undo.empty()) return;
+        Change c = m_undo.back();
+        if (Apply(c.hadNew ? &c.now : nullptr, c.hadOld ? &c.old : nullptr, false))
+            m_undo.pop_back();
+        m_undoBtn->Enable(!m_undo.empty());
     }
 };
 
 // =========================================
-// Onboarding Wizard
+// Timer Display
 // =========================================
-class OnboardWizard : public wxWizard {
+// Custom-drawn "HH:MM:SS". Glyphs for "0-9:" are rendered once per
+// font/colour into bitmaps; a new value invalidates only the cells whose
+// character changed, and painting goes through a back buffer.
+class TimerDisplay : public wxWindow {
 public:
-    std::vector<WorkApp> selectedApps;
-
-    explicit OnboardWizard(wxWindow* parent)
-        : wxWizard(parent, wxID_ANY, "WorkTimer - First Run Setup",
-            wxNullBitmap, wxDefaultPosition, wxDEFAULT_DIALOG_STYLE)
+    TimerDisplay(wxWindow* parent, const wxFont& font,
+        const wxColour& fg, const wxColour& bg)
+        : wxWindow(parent, wxID_ANY)
     {
-        SetBackgroundColour(CLR_BG);
-
-        // Page 1: Welcome
-        m_p1 = new wxWizardPageSimple(this);
-        m_p1->SetBackgroundColour(CLR_BG);
-        {
-            auto* s = new wxBoxSizer(wxVERTICAL);
-            auto* t = new wxStaticText(m_p1, wxID_ANY, "Welcome to WorkTimer");
-            t->SetForegroundColour(CLR_RED);
-            wxFont f = t->GetFont(); f.SetPointSize(15); f.SetWeight(wxFONTWEIGHT_BOLD);
-            t->SetFont(f);
-            s->Add(t, 0, wxALL, 14);
-            auto* d = new wxStaticText(m_p1, wxID_ANY,
-                "WorkTimer tracks how long you work in specific apps.\n\n"
-                "It watches which app is in focus and automatically\n"
-                "starts and stops the timer for you.\n\n"
-                "This setup takes about 30 seconds.\n"
-                "Click Next to choose your work apps.");
-            d->SetForegroundColour(CLR_TEXT);
-            s->Add(d, 0, wxLEFT, 14);
-            m_p1->SetSizer(s);
+        SetBackgroundStyle(wxBG_STYLE_PAINT);
+        SetFont(font);
+        wxWindow::SetForegroundColour(fg);
+        SetBackgroundColour(bg);
+        for (const char* g = kGlyphs; *g; g++) {
+            wxSize ext = GetTextExtent(wxString(*g, 1));
+            m_cellW = std::max(m_cellW, ext.x);
+            m_cellH = std::max(m_cellH, ext.y);
         }
+        Format(0, m_text);
+        m_len = (int)strlen(m_text);
+        SetMinSize(wxSize(m_len * m_cellW, m_cellH));
+        Bind(wxEVT_PAINT, &TimerDisplay::OnPaint, this);
+    }
 
-        // Page 2: Pick apps
-        m_p2 = new wxWizardPageSimple(this, m_p1);
-        m_p2->SetBackgroundColour(CLR_BG);
-        {
-            auto* s = new wxBoxSizer(wxVERTICAL);
-            auto* t = new wxStaticText(m_p2, wxID_ANY, "Choose apps to track");
-            t->SetForegroundColour(CLR_RED);
-            wxFont f = t->GetFont(); f.SetWeight(wxFONTWEIGHT_BOLD); f.SetPointSize(11);
-            t->SetFont(f);
-            s->Add(t, 0, wxALL, 12);
-            auto* h = new wxStaticText(m_p2, wxID_ANY,
-                "Check apps you work in. Timer starts when that app is active.");
-            h->SetForegroundColour(CLR_DIM);
-            s->Add(h, 0, wxLEFT | wxBOTTOM, 8);
-
-            // Search box
-            auto* searchRow = new wxBoxSizer(wxHORIZONTAL);
-            auto* searchLbl = new wxStaticText(m_p2, wxID_ANY, "Search:");
-            searchLbl->SetForegroundColour(CLR_TEXT);
-            searchRow->Add(searchLbl, 0, wxALIGN_CENTER_VERTICAL | wxRIGHT, 6);
-            m_search = new wxTextCtrl(m_p2, wxID_ANY);
-            m_search->SetBackgroundColour(CLR_PANEL);
-            m_search->SetForegroundColour(*wxWHITE);
-            searchRow->Add(m_search, 1);
-            s->Add(searchRow, 0, wxEXPAND | wxLEFT | wxRIGHT | wxBOTTOM, 10);
-
-            m_checkList = new wxCheckListBox(m_p2, wxID_ANY);
-            m_checkList->SetBackgroundColour(CLR_PANEL);
-            m_checkList->SetForegroundColour(*wxWHITE);
-            s->Add(m_checkList, 1, wxEXPAND | wxLEFT | wxRIGHT | wxBOTTOM, 12);
-
-            auto procs = GetRunningProcesses();
-            for (auto& p : procs) {
-                if (p.exeName == "WorkTimer.exe" || p.exeName == "explorer.exe" ||
-                    p.exeName == "svchost.exe" || p.exeName == "System") continue;
-                m_procs.push_back(p);
-                m_checkList->Append(p.exeName);
-            }
-
-            // Live search filter
-            m_search->Bind(wxEVT_TEXT, [this](wxCommandEvent&) {
-                wxString filter = m_search->GetValue().Lower();
-                std::set<wxString> checked;
-                for (unsigned i = 0; i < m_checkList->GetCount(); i++)
-                    if (m_checkList->IsChecked(i))
-                        checked.insert(m_checkList->GetString(i));
-                m_checkList->Clear();
-                for (auto& p : m_procs) {
-                    if (filter.IsEmpty() || p.exeName.Lower().Contains(filter)) {
-                        unsigned idx = m_checkList->GetCount();
-                        m_checkList->Append(p.exeName);
-                        if (checked.count(p.exeName))
-                            m_checkList->Check(idx, true);
-                    }
-                }
-                });
-
-            m_p2->SetSizer(s);
+    void SetSeconds(int secs) {
+        char next[sizeof(m_text)];
+        Format(secs, next);
+        int len = (int)strlen(next);
+        if (len != m_len) {
+            memcpy(m_text, next, sizeof(m_text));
+            m_len = len;
+            SetMinSize(wxSize(m_len * m_cellW, m_cellH));
+            GetParent()->Layout();
+            Refresh(false);
+            return;
         }
+        for (int i = 0; i < len; i++) {
+            if (next[i] == m_text[i]) continue;
+            m_text[i] = next[i];
+            RefreshRect(CellRect(i), false);
+        }
+    }
 
-        // Page 3: Options
-        m_p3 = new wxWizardPageSimple(this, m_p2);
-        m_p3->SetBackgroundColour(CLR_BG);
-        {
-            auto* s = new wxBoxSizer(wxVERTICAL);
-            auto* t = new wxStaticText(m_p3, wxID_ANY, "Preferences");
-            t->SetForegroundColour(CLR_RED);
-            wxFont f = t->GetFont(); f.SetWeight(wxFONTWEIGHT_BOLD); f.SetPointSize(11);
-            t->SetFont(f);
-            s->Add(t, 0, wxALL, 12);
+    bool SetForegroundColour(const wxColour& c) override {
+        if (c == GetForegroundColour()) return false;
+        wxWindow::SetForegroundColour(c);
+        m_glyphsOk = false;
+        Refresh(false);
+        return true;
+    }
 
-            m_cbTop = new wxCheckBox(m_p3, wxID_ANY, "Always on top (recommended)");
-            m_cbTop->SetValue(true);
-            m_cbTop->SetForegroundColour(CLR_TEXT); m_cbTop->SetBackgroundColour(CLR_BG);
-            s->Add(m_cbTop, 0, wxLEFT | wxBOTTOM, 16);
+private:
+    static constexpr const char* kGlyphs = "0123456789:";
+    char     m_text[16] = {};
+    int      m_len = 0;
+    int      m_cellW = 0, m_cellH = 0;
+    bool     m_glyphsOk = false;
+    wxBitmap m_glyph[11];
+    wxBrush  m_bgBrush;
 
-            m_cbTray = new wxCheckBox(m_p3, wxID_ANY, "Start minimized to system tray");
-            m_cbTray->SetValue(false);
-            m_cbTray->SetForegroundColour(CLR_TEXT); m_cbTray->SetBackgroundColour(CLR_BG);
-            s->Add(m_cbTray, 0, wxLEFT | wxBOTTOM, 16);
+    static void Format(int secs, char* out) { FormatClock(secs, out); }
 
-            m_cbAlert = new wxCheckBox(m_p3, wxID_ANY, "Flash color alert every 30 min");
-            m_cbAlert->SetValue(true);
-            m_cbAlert->SetForegroundColour(CLR_TEXT); m_cbAlert->SetBackgroundColour(CLR_BG);
-            s->Add(m_cbAlert, 0, wxLEFT | wxBOTTOM, 16);
+    wxRect CellRect(int i) const {
+        wxSize sz = GetClientSize();
+        int x0 = (sz.x - m_len * m_cellW) / 2;
+        int y0 = (sz.y - m_cellH) / 2;
+        return wxRect(x0 + i * m_cellW, y0, m_cellW, m_cellH);
+    }
 
-            auto* done = new wxStaticText(m_p3, wxID_ANY,
-                "Click Finish to start WorkTimer.");
-            done->SetForegroundColour(CLR_DIM);
-            s->Add(done, 0, wxLEFT | wxTOP, 12);
-            m_p3->SetSizer(s);
+    void BuildGlyphs() {
+        m_bgBrush = wxBrush(GetBackgroundColour());
+        for (int i = 0; kGlyphs[i]; i++) {
+            wxString ch(kGlyphs[i], 1);
+            m_glyph[i] = wxBitmap(m_cellW, m_cellH);
+            wxMemoryDC mdc(m_glyph[i]);
+            mdc.SetBackground(wxBrush(GetBackgroundColour()));
+            mdc.Clear();
+            mdc.SetFont(GetFont());
+            mdc.SetTextForeground(GetForegroundColour());
+            wxSize ext = mdc.GetTextExtent(ch);
+            mdc.DrawText(ch, (m_cellW - ext.x) / 2, 0);
+            mdc.SelectObject(wxNullBitmap);
         }
-
-        wxWizardPageSimple::Chain(m_p1, m_p2);
-        wxWizardPageSimple::Chain(m_p2, m_p3);
-        GetPageAreaSizer()->Add(m_p1);
-        SetSize(wxSize(500, 440));
+        m_glyphsOk = true;
     }
 
-    wxWizardPage* GetFirstPage() const { return m_p1; }
-    bool startInTray() const { return m_cbTray->GetValue(); }
-    bool alwaysOnTop() const { return m_cbTop->GetValue(); }
-    bool colorAlert()  const { return m_cbAlert->GetValue(); }
-
-    void CollectApps() {
-        selectedApps.clear();
-        // Collect checked names from currently visible list
-        std::set<wxString> checkedNames;
-        for (unsigned i = 0; i < m_checkList->GetCount(); i++)
-            if (m_checkList->IsChecked(i))
-                checkedNames.insert(m_checkList->GetString(i));
-        // Map back to full proc info
-        for (auto& p : m_procs) {
-            if (checkedNames.count(p.exeName)) {
-                WorkApp a;
-                a.exeName = p.exeName;
-                a.label = wxFileName(p.exeName).GetName();
-                selectedApps.push_back(a);
+    void OnPaint(wxPaintEvent&) {
+        uint64_t t0 = PerfEnabled() ? PerfNowNs() : 0;
+        {
+            PERF_SCOPE(kPerfPaint);
+            wxAutoBufferedPaintDC dc(this);
+            if (!m_glyphsOk) BuildGlyphs();
+            dc.SetBackground(m_bgBrush);
+            dc.Clear();
+            wxRect dirty = GetUpdateRegion().GetBox();
+            for (int i = 0; i < m_len; i++) {
+                wxRect cell = CellRect(i);
+                if (!cell.Intersects(dirty)) continue;
+                const char* g = strchr(kGlyphs, m_text[i]);
+                if (g) dc.DrawBitmap(m_glyph[g - kGlyphs], cell.x, cell.y);
             }
         }
+        PERF_COUNT(kCtrPaints, 1);
+        if (t0) PERF_COUNT(kCtrPaintNs, PerfNowNs() - t0);
     }
-
-private:
-    wxWizardPageSimple* m_p1, * m_p2, * m_p3;
-    wxCheckListBox* m_checkList;
-    wxTextCtrl* m_search;
-    wxCheckBox* m_cbTray, * m_cbTop, * m_cbAlert;
-    std::vector<ProcessInfo> m_procs;
 };
 
 // =========================================
@@ -545,13 +5496,15 @@ private:
 // =========================================
 class MainFrame : public wxFrame {
 public:
-    MainFrame();
+    // checkDir: a --startup-check run on the ini copied there, which ends
+    // once the deferred work has started.
+    explicit MainFrame(const wxString& checkDir = wxEmptyString);
     ~MainFrame() override;
 
 private:
-    wxStaticText* m_timerLabel;
+    TimerDisplay* m_timerLabel;
     wxStaticText* m_statusLabel;
-    wxStaticText* m_todayLabel;
+    TimerDisplay* m_todayLabel;
     wxButton* m_startBtn;
     wxListCtrl* m_appList;
     wxImageList* m_appImgList;
@@ -560,21 +5513,28 @@ private:
     wxTimer m_ticker;
     wxTimer m_monitor;
 
-    AppConfig            m_cfg;
-    std::vector<Session> m_sessions;
-    int      m_elapsed = 0;
-    bool     m_running = false;
-    wxString m_curApp;
+    std::unique_ptr<HistoryArchive> m_arc;      // startup checks only
+    Tracker  m_trk;
+    ForegroundSampler m_fg;
     std::map<wxString, int> m_iconCache;
+    std::deque<wxString>    m_iconQueue;    // exe names waiting for OnIdle
+    std::map<wxString, wxString> m_iconPaths;  // lower-cased exe -> image path
+    bool m_iconPathsReady = false;
+    bool m_iconsMarked = false;
 
     void BuildUI();
+    bool IsVisible() const;
     void UpdateDisplay();
     void UpdateTodayLabel();
     void StartTimer(const wxString& appName = wxEmptyString);
     void StopTimer();
     void ResetTimer();
+    void ShowRunning();
+    void ShowPaused();
+    void ShowAlert(const AlertScheduler::Alert& a);
     void RefreshAppList();
-    int  GetOrLoadIcon(const wxString& exeName);
+    void StartDeferred();
+    void OnIdle(wxIdleEvent&);
 
     void OnTick(wxTimerEvent&);
     void OnMonitor(wxTimerEvent&);
@@ -584,6 +5544,7 @@ private:
     void OnRemoveApp(wxCommandEvent&);
     void OnSettings(wxCommandEvent&);
     void OnIconize(wxIconizeEvent&);
+    void OnShow(wxShowEvent&);
     void OnClose(wxCloseEvent&);
 
     wxDECLARE_EVENT_TABLE();
@@ -608,6 +5569,7 @@ EVT_BUTTON(ID_RESET, MainFrame::OnReset)
 EVT_BUTTON(ID_ADD_APP, MainFrame::OnAddApp)
 EVT_BUTTON(ID_SETTINGS, MainFrame::OnSettings)
 EVT_ICONIZE(MainFrame::OnIconize)
+EVT_SHOW(MainFrame::OnShow)
 EVT_CLOSE(MainFrame::OnClose)
 wxEND_EVENT_TABLE()
 
@@ -639,37 +5601,40 @@ wxMenu* TrayIcon::CreatePopupMenu() {
 // -----------------------------------------
 // MainFrame
 // -----------------------------------------
-MainFrame::MainFrame()
+MainFrame::MainFrame(const wxString& checkDir)
     : wxFrame(nullptr, wxID_ANY, "Work Timer",
         wxDefaultPosition, wxSize(340, 470),
         wxDEFAULT_FRAME_STYLE & ~(wxRESIZE_BORDER | wxMAXIMIZE_BOX)),
     m_ticker(this, ID_TICK),
     m_monitor(this, ID_MONITOR),
-    m_tray(nullptr)
+    m_tray(nullptr),
+    m_arc(checkDir.IsEmpty() ? nullptr : new HistoryArchive(checkDir)),
+    m_trk(m_arc ? checkDir : DataDir(), m_arc ? *m_arc : HistoryArchive::Get())
 {
-    m_cfg = LoadConfig(m_sessions);
-
-    wxString today = wxDateTime::Now().FormatISODate();
-    if (m_cfg.lastDate != today) {
-        m_cfg.todayTotal = 0;
-        m_cfg.lastDate = today;
-    }
+    // Critical path: config, window, first sample. Icons, the exe catalog
+    // and the history packer follow in StartDeferred().
+    m_trk.Load();
+    StartupPhases::Get().Mark("config loaded");
+    AppConfig& cfg = m_trk.cfg;
+    if (m_arc) cfg.onboardDone = true;  // no modal wizard in a check
 
     // Onboarding
-    if (!m_cfg.onboardDone) {
+    if (!cfg.onboardDone) {
         OnboardWizard wiz(this);
         if (wiz.RunWizard(wiz.GetFirstPage())) {
             wiz.CollectApps();
-            m_cfg.workApps = wiz.selectedApps;
-            m_cfg.startInTray = wiz.startInTray();
-            m_cfg.alwaysOnTop = wiz.alwaysOnTop();
-            m_cfg.colorAlert = wiz.colorAlert();
-            m_cfg.onboardDone = true;
-            SaveConfig(m_cfg, m_sessions);
+            cfg.workApps = wiz.selectedApps;
+            m_trk.ConfigChanged();
+            cfg.startInTray = wiz.startInTray();
+            cfg.alwaysOnTop = wiz.alwaysOnTop();
+            cfg.colorAlert = wiz.colorAlert();
+            cfg.onboardDone = true;
+            m_trk.Save();
         }
+        StartupPhases::Get().Mark("onboarding");
     }
 
-    if (m_cfg.alwaysOnTop)
+    if (cfg.alwaysOnTop)
         SetWindowStyle(GetWindowStyle() | wxSTAY_ON_TOP);
 
     wxDisplay disp;
@@ -678,20 +5643,35 @@ MainFrame::MainFrame()
         area.GetBottom() - GetSize().y - 20));
 
     BuildUI();
+    StartupPhases::Get().Mark("window built");
 
-    // Tray icon
+    // Tray icon, from the exe's own resources (resources/app.rc)
     m_tray = new TrayIcon(this);
-    wxIcon trayIco;
-    if (wxFileExists("app.ico"))
-        trayIco.LoadFile("app.ico", wxBITMAP_TYPE_ICO);
-    if (!trayIco.IsOk())
-        trayIco.LoadFile("app.ico", wxBITMAP_TYPE_ICO);
-    m_tray->SetIcon(trayIco, "WorkTimer");
+    m_tray->SetIcon(wxIcon("IDI_ICON1", wxBITMAP_TYPE_ICO_RESOURCE, 16, 16), "WorkTimer");
 
-    Show(!m_cfg.startInTray);
+    Show(!cfg.startInTray);
 
+    // Sample now rather than a second from now.
+    wxTimerEvent first;
+    OnMonitor(first);
+    StartupPhases::Get().Mark("first sample");
     m_ticker.Start(1000);
     m_monitor.Start(1000);
+    CallAfter([this] { StartDeferred(); });
+}
+
+// Work the first sample doesn't need, once the event loop is running.
+// Icons then load one per idle event.
+void MainFrame::StartDeferred() {
+    wxInitAllImageHandlers();
+    ExeCatalog::Get().Start();
+    (m_arc ? *m_arc : HistoryArchive::Get()).Start();   // packs a journal a crash left behind
+    StartupPhases::Get().Mark("background started");
+    if (m_arc) {
+        wxTheApp->ExitMainLoop();
+        return;
+    }
+    Bind(wxEVT_IDLE, &MainFrame::OnIdle, this);
 }
 
 MainFrame::~MainFrame() {
@@ -725,12 +5705,9 @@ void MainFrame::BuildUI() {
     auto* tp = new wxPanel(this, wxID_ANY);
     tp->SetBackgroundColour(CLR_BG);
     auto* tCol = new wxBoxSizer(wxVERTICAL);
-    m_timerLabel = new wxStaticText(tp, wxID_ANY, "00:00:00",
-        wxDefaultPosition, wxDefaultSize, wxALIGN_CENTER);
-    wxFont tf2 = m_timerLabel->GetFont();
+    wxFont tf2 = tp->GetFont();
     tf2.SetPointSize(34); tf2.SetWeight(wxFONTWEIGHT_BOLD); tf2.SetFaceName("Consolas");
-    m_timerLabel->SetFont(tf2);
-    m_timerLabel->SetForegroundColour(CLR_DIM);
+    m_timerLabel = new TimerDisplay(tp, tf2, CLR_DIM, CLR_BG);
     tCol->Add(m_timerLabel, 0, wxALIGN_CENTER | wxTOP, 10);
     m_statusLabel = new wxStaticText(tp, wxID_ANY, "\u25cf Idle",
         wxDefaultPosition, wxDefaultSize, wxALIGN_CENTER);
@@ -746,11 +5723,9 @@ void MainFrame::BuildUI() {
     auto* tl = new wxStaticText(todayPnl, wxID_ANY, "Today total");
     tl->SetForegroundColour(CLR_DIM);
     todayRow->Add(tl, 1, wxALIGN_CENTER_VERTICAL | wxLEFT, 12);
-    m_todayLabel = new wxStaticText(todayPnl, wxID_ANY, "00:00:00");
-    wxFont tf3 = m_todayLabel->GetFont();
+    wxFont tf3 = todayPnl->GetFont();
     tf3.SetFaceName("Consolas"); tf3.SetWeight(wxFONTWEIGHT_BOLD);
-    m_todayLabel->SetFont(tf3);
-    m_todayLabel->SetForegroundColour(CLR_BLUE);
+    m_todayLabel = new TimerDisplay(todayPnl, tf3, CLR_BLUE, CLR_PANEL);
     todayRow->Add(m_todayLabel, 0, wxALIGN_CENTER_VERTICAL | wxRIGHT, 12);
     todayPnl->SetSizer(todayRow);
     root->Add(todayPnl, 0, wxEXPAND);
@@ -818,55 +5793,73 @@ void MainFrame::BuildUI() {
 // -----------------------------------------
 // Icon helper
 // -----------------------------------------
-int MainFrame::GetOrLoadIcon(const wxString& exeName) {
-    auto it = m_iconCache.find(exeName);
-    if (it != m_iconCache.end()) return it->second;
-
-    wxString path;
-    HANDLE snap = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
-    if (snap != INVALID_HANDLE_VALUE) {
-        PROCESSENTRY32W pe; pe.dwSize = sizeof(pe);
-        if (Process32FirstW(snap, &pe)) {
-            do {
-                if (exeName.CmpNoCase(wxString(pe.szExeFile)) == 0) {
+// One queued app icon per idle event. Image paths come from a single
+// process snapshot per batch; apps that aren't running get no icon.
+void MainFrame::OnIdle(wxIdleEvent& e) {
+    if (m_iconQueue.empty()) return;
+    if (!m_iconPathsReady) {
+        std::set<wxString> wanted;
+        for (auto& exe : m_iconQueue) wanted.insert(exe.Lower());
+        HANDLE snap = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+        if (snap != INVALID_HANDLE_VALUE) {
+            PROCESSENTRY32W pe; pe.dwSize = sizeof(pe);
+            if (Process32FirstW(snap, &pe)) {
+                do {
+                    wxString key = wxString(pe.szExeFile).Lower();
+                    if (!wanted.count(key) || m_iconPaths.count(key)) continue;
                     HANDLE h = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION,
                         FALSE, pe.th32ProcessID);
                     if (h) {
                         wchar_t buf[MAX_PATH]; DWORD sz = MAX_PATH;
                         if (QueryFullProcessImageNameW(h, 0, buf, &sz))
-                            path = wxString(buf);
+                            m_iconPaths[key] = wxString(buf);
                         CloseHandle(h);
                     }
-                    break;
-                }
-            } while (Process32NextW(snap, &pe));
+                } while (Process32NextW(snap, &pe));
+            }
+            CloseHandle(snap);
         }
-        CloseHandle(snap);
+        m_iconPathsReady = true;
     }
 
+    wxString exeName = m_iconQueue.front();
+    m_iconQueue.pop_front();
     int idx = -1;
-    if (!path.IsEmpty()) {
-        HICON hIco = NULL;
-        ExtractIconExW(path.wc_str(), 0, NULL, &hIco, 1);
-        if (!hIco) ExtractIconExW(path.wc_str(), 0, &hIco, NULL, 1);
-        if (hIco) {
-            wxIcon ico; ico.CreateFromHICON(hIco);
-            wxBitmap bmp(ico);
-            if (bmp.IsOk()) {
-                wxImage img = bmp.ConvertToImage().Rescale(16, 16);
-                idx = m_appImgList->Add(wxBitmap(img));
-            }
-            DestroyIcon(hIco);
+    wxIcon ico;
+    auto path = m_iconPaths.find(exeName.Lower());
+    if (path != m_iconPaths.end() && LoadExeIcon(path->second, ico)) {
+        wxBitmap bmp(ico);
+        if (bmp.IsOk()) {
+            wxImage img = bmp.ConvertToImage().Rescale(16, 16);
+            idx = m_appImgList->Add(wxBitmap(img));
         }
     }
     m_iconCache[exeName] = idx;
-    return idx;
+    if (idx >= 0)
+        for (long i = 0; i < m_appList->GetItemCount(); i++)
+            if (m_appList->GetItemText(i, 1) == exeName) m_appList->SetItemImage(i, idx);
+
+    if (!m_iconQueue.empty()) { e.RequestMore(); return; }
+    m_iconPaths.clear();
+    m_iconPathsReady = false;
+    if (!m_iconsMarked) StartupPhases::Get().Mark("app icons");
+    m_iconsMarked = true;
 }
 
 void MainFrame::RefreshAppList() {
+    PERF_SCOPE(kPerfRefreshApps);
     m_appList->DeleteAllItems();
-    for (auto& a : m_cfg.workApps) {
-        int imgIdx = GetOrLoadIcon(a.exeName);
+    for (auto& a : m_trk.cfg.workApps) {
+        int imgIdx = -1;
+        auto it = m_iconCache.find(a.exeName);
+        if (it != m_iconCache.end()) {
+            PERF_COUNT(kCtrIconCacheHits, 1);
+            imgIdx = it->second;
+        }
+        else if (std::find(m_iconQueue.begin(), m_iconQueue.end(), a.exeName) == m_iconQueue.end()) {
+            m_iconQueue.push_back(a.exeName);
+            m_iconPathsReady = false;
+        }
         long idx = m_appList->InsertItem(m_appList->GetItemCount(), a.label, imgIdx);
         m_appList->SetItem(idx, 1, a.exeName);
     }
@@ -876,97 +5869,132 @@ void MainFrame::RefreshAppList() {
 // Timer
 // -----------------------------------------
 void MainFrame::OnTick(wxTimerEvent&) {
-    if (!m_running) return;
-    m_elapsed++;
-    m_cfg.todayTotal++;
-    UpdateDisplay();
-    if (m_cfg.colorAlert && m_elapsed > 0 &&
-        m_elapsed % (m_cfg.alertMinutes * 60) == 0) {
+    PERF_SCOPE(kPerfTick);
+    PERF_HOT_ALLOCS();
+    const std::vector<uint32_t>& due = m_trk.Tick();
+    if (m_trk.running) UpdateDisplay();
+    for (uint32_t id : due) {
+        PERF_HOT_ALLOCS_SKIP();
+        ShowAlert(m_trk.Alerts().Alerts()[id]);
+    }
+}
+
+// Breaks turn the clock orange as before; the rest pop a tray balloon.
+void MainFrame::ShowAlert(const AlertScheduler::Alert& a) {
+    char clock[16];
+    wxString title, text;
+    switch (a.kind) {
+    case AlertScheduler::kBreak:
         m_timerLabel->SetForegroundColour(CLR_ORANGE);
         wxBell();
+        return;
+    case AlertScheduler::kGoal:
+        FormatClock(m_trk.AppToday(m_trk.curApp), clock);
+        title = "Goal reached";
+        text = a.app + ": " + clock + " today";
+        break;
+    case AlertScheduler::kBudget:
+        FormatClock(m_trk.cfg.todayTotal, clock);
+        title = "Daily budget reached";
+        text = wxString("Tracked today: ") + clock;
+        break;
+    case AlertScheduler::kSummary:
+        FormatClock(m_trk.cfg.todayTotal, clock);
+        title = "Daily summary";
+        text = wxString("Tracked today: ") + clock;
+        break;
     }
+    TRACE_INSTANT("alert", (const char*)title.utf8_str());
+    if (m_tray) m_tray->ShowBalloon(title, text);
+    wxBell();
 }
 
 void MainFrame::OnMonitor(wxTimerEvent&) {
-    wxString active = GetForegroundProcessName();
-    if (active.IsEmpty()) return;
-
-    wxString matched;
-    for (auto& a : m_cfg.workApps) {
-        if (active.CmpNoCase(a.exeName) == 0) { matched = a.exeName; break; }
+    PERF_SCOPE(kPerfMonitor);
+    PERF_HOT_ALLOCS();
+    const wchar_t* exe = m_fg.Sample();
+    if (SampleRecorder::Get().Record(exe, m_fg.Pid(), &m_fg, &m_fg)) PERF_HOT_ALLOCS_SKIP();
+    switch (m_trk.Sample(exe, &m_fg, &m_fg)) {
+    case Tracker::kStarted: PERF_HOT_ALLOCS_SKIP(); ShowRunning(); break;
+    case Tracker::kStopped: PERF_HOT_ALLOCS_SKIP(); ShowPaused(); UpdateDisplay(); break;
+    default: break;
     }
-
-    if (!matched.IsEmpty() && !m_running)      StartTimer(matched);
-    else if (matched.IsEmpty() && m_running && !m_curApp.IsEmpty()) StopTimer();
 }
 
 void MainFrame::StartTimer(const wxString& appName) {
-    m_running = true;
-    m_curApp = appName;
+    m_trk.Start(appName);
+    ShowRunning();
+}
+
+void MainFrame::StopTimer() {
+    m_trk.Stop();
+    ShowPaused();
+}
+
+void MainFrame::ShowRunning() {
     m_startBtn->SetLabel("\u23f8 Stop");
     m_timerLabel->SetForegroundColour(CLR_RED);
     m_statusLabel->SetForegroundColour(CLR_GREEN);
-    wxString label = appName.IsEmpty() ? "Manual" : appName;
+    wxString label = m_trk.curApp.IsEmpty() ? "Manual" : m_trk.curApp;
+    if (!m_trk.curCategory.IsEmpty()) label += " \u00b7 " + m_trk.curCategory;
     m_statusLabel->SetLabel("\u25cf Working: " + label);
 }
 
-void MainFrame::StopTimer() {
-    m_running = false;
-    if (m_elapsed > 0) {
-        Session s;
-        s.appName = m_curApp.IsEmpty() ? "Manual" : m_curApp;
-        s.duration = m_elapsed;
-        s.date = wxDateTime::Now().FormatISODate();
-        s.endTime = wxDateTime::Now().Format("%H:%M");
-        m_sessions.push_back(s);
-        SaveConfig(m_cfg, m_sessions);
-    }
+void MainFrame::ShowPaused() {
     m_startBtn->SetLabel("\u25b6 Start");
     m_timerLabel->SetForegroundColour(wxColour(136, 102, 68));
     m_statusLabel->SetForegroundColour(CLR_ORANGE);
-    m_statusLabel->SetLabel("\u25cf Paused");
+    m_statusLabel->SetLabel(m_trk.Idle() ? "\u25cf Away" : "\u25cf Paused");
 }
 
 void MainFrame::ResetTimer() {
-    if (m_running) StopTimer();
-    m_elapsed = 0;
-    m_timerLabel->SetLabel("00:00:00");
+    if (m_trk.running) StopTimer();
+    m_trk.Reset();
+    m_timerLabel->SetSeconds(0);
     m_timerLabel->SetForegroundColour(CLR_DIM);
     m_statusLabel->SetLabel("\u25cf Idle");
     m_statusLabel->SetForegroundColour(CLR_DIM);
     m_startBtn->SetLabel("\u25b6 Start");
 }
 
+// Skipped while hidden in the tray; OnShow catches up.
+bool MainFrame::IsVisible() const {
+    return IsShown() && !IsIconized();
+}
+
 void MainFrame::UpdateDisplay() {
-    m_timerLabel->SetLabel(FormatTime(m_elapsed));
-    if (m_running) m_timerLabel->SetForegroundColour(CLR_RED);
+    if (!IsVisible()) return;
+    m_timerLabel->SetSeconds(m_trk.elapsed);
+    if (m_trk.running) m_timerLabel->SetForegroundColour(CLR_RED);
     UpdateTodayLabel();
 }
 
 void MainFrame::UpdateTodayLabel() {
-    m_todayLabel->SetLabel(FormatTime(m_cfg.todayTotal));
+    if (!IsVisible()) return;
+    m_todayLabel->SetSeconds(m_trk.cfg.todayTotal);
     m_todayLabel->SetForegroundColour(
-        m_cfg.todayTotal > 0 ? wxColour(68, 136, 255) : CLR_BLUE);
+        m_trk.cfg.todayTotal > 0 ? wxColour(68, 136, 255) : CLR_BLUE);
 }
 
 // -----------------------------------------
 // Event handlers
 // -----------------------------------------
 void MainFrame::OnToggle(wxCommandEvent&) {
-    if (m_running) StopTimer(); else StartTimer();
+    if (m_trk.running) StopTimer(); else StartTimer();
 }
 void MainFrame::OnReset(wxCommandEvent&) { ResetTimer(); }
 
 void MainFrame::OnAddApp(wxCommandEvent&) {
     AddAppDialog dlg(this);
     if (dlg.ShowModal() == wxID_OK && !dlg.result.exeName.IsEmpty()) {
-        for (auto& a : m_cfg.workApps) {
+        for (auto& a : m_trk.cfg.workApps) {
             if (a.exeName.CmpNoCase(dlg.result.exeName) == 0) {
                 wxMessageBox("Already registered.", "Info"); return;
             }
         }
-        m_cfg.workApps.push_back(dlg.result);
-        SaveConfig(m_cfg, m_sessions);
+        m_trk.cfg.workApps.push_back(dlg.result);
+        m_trk.ConfigChanged();
+        m_trk.Save();
         RefreshAppList();
     }
 }
@@ -974,17 +6002,21 @@ void MainFrame::OnAddApp(wxCommandEvent&) {
 void MainFrame::OnRemoveApp(wxCommandEvent&) {
     long sel = m_appList->GetNextItem(-1, wxLIST_NEXT_ALL, wxLIST_STATE_SELECTED);
     if (sel == wxNOT_FOUND) return;
-    wxString name = m_cfg.workApps[sel].exeName;
+    auto& apps = m_trk.cfg.workApps;
+    wxString name = apps[sel].exeName;
     if (wxMessageBox("Remove '" + name + "'?", "Confirm",
         wxYES_NO | wxICON_QUESTION) == wxYES) {
-        m_cfg.workApps.erase(m_cfg.workApps.begin() + sel);
-        SaveConfig(m_cfg, m_sessions);
+        apps.erase(apps.begin() + sel);
+        m_trk.ConfigChanged();
+        m_trk.Save();
         RefreshAppList();
     }
 }
 
 void MainFrame::OnSettings(wxCommandEvent&) {
-    wxDialog dlg(this, wxID_ANY, "Settings", wxDefaultPosition, wxSize(300, 380));
+    AppConfig& cfg = m_trk.cfg;
+    wxDialog dlg(this, wxID_ANY, "Settings", wxDefaultPosition, wxSize(340, 430));
+    PerfScope buildScope(kPerfDialogBuild, "SettingsDialog");
     dlg.SetBackgroundColour(CLR_BG);
     auto* s = new wxBoxSizer(wxVERTICAL);
 
@@ -995,7 +6027,7 @@ void MainFrame::OnSettings(wxCommandEvent&) {
     s->Add(t, 0, wxALIGN_CENTER | wxTOP | wxBOTTOM, 10);
 
     auto* cbAlert = new wxCheckBox(&dlg, wxID_ANY, "Color alert");
-    cbAlert->SetValue(m_cfg.colorAlert);
+    cbAlert->SetValue(cfg.colorAlert);
     cbAlert->SetForegroundColour(CLR_TEXT); cbAlert->SetBackgroundColour(CLR_BG);
     s->Add(cbAlert, 0, wxLEFT | wxBOTTOM, 16);
 
@@ -1005,18 +6037,29 @@ void MainFrame::OnSettings(wxCommandEvent&) {
     r2->Add(l2, 1, wxALIGN_CENTER_VERTICAL);
     auto* spin = new wxSpinCtrl(&dlg, wxID_ANY, wxEmptyString,
         wxDefaultPosition, wxSize(60, -1));
-    spin->SetRange(1, 120); spin->SetValue(m_cfg.alertMinutes);
+    spin->SetRange(1, 120); spin->SetValue(cfg.alertMinutes);
     spin->SetBackgroundColour(CLR_PANEL); spin->SetForegroundColour(*wxWHITE);
     r2->Add(spin, 0);
     s->Add(r2, 0, wxLEFT | wxRIGHT | wxBOTTOM, 16);
 
+    auto* r3 = new wxBoxSizer(wxHORIZONTAL);
+    auto* l3 = new wxStaticText(&dlg, wxID_ANY, "Pause when idle (min, 0 = off):");
+    l3->SetForegroundColour(CLR_TEXT);
+    r3->Add(l3, 1, wxALIGN_CENTER_VERTICAL);
+    auto* idleSpin = new wxSpinCtrl(&dlg, wxID_ANY, wxEmptyString,
+        wxDefaultPosition, wxSize(60, -1));
+    idleSpin->SetRange(0, 120); idleSpin->SetValue(cfg.idleMinutes);
+    idleSpin->SetBackgroundColour(CLR_PANEL); idleSpin->SetForegroundColour(*wxWHITE);
+    r3->Add(idleSpin, 0);
+    s->Add(r3, 0, wxLEFT | wxRIGHT | wxBOTTOM, 16);
+
     auto* cbTop = new wxCheckBox(&dlg, wxID_ANY, "Always on top");
-    cbTop->SetValue(m_cfg.alwaysOnTop);
+    cbTop->SetValue(cfg.alwaysOnTop);
     cbTop->SetForegroundColour(CLR_TEXT); cbTop->SetBackgroundColour(CLR_BG);
     s->Add(cbTop, 0, wxLEFT | wxBOTTOM, 16);
 
     auto* cbTray = new wxCheckBox(&dlg, wxID_ANY, "Start minimized to tray");
-    cbTray->SetValue(m_cfg.startInTray);
+    cbTray->SetValue(cfg.startInTray);
     cbTray->SetForegroundColour(CLR_TEXT); cbTray->SetBackgroundColour(CLR_BG);
     s->Add(cbTray, 0, wxLEFT | wxBOTTOM, 16);
 
@@ -1025,56 +6068,402 @@ void MainFrame::OnSettings(wxCommandEvent&) {
     // Today stats
     wxString today = wxDateTime::Now().FormatISODate();
     std::map<wxString, int> appTimes; int cnt = 0;
-    for (auto& ss : m_sessions)
-        if (ss.date == today) { appTimes[ss.appName] += ss.duration; cnt++; }
+    for (auto& ss : m_trk.sessions)
+        if (ss.date == today) {
+            appTimes[ss.category.IsEmpty() ? ss.appName : ss.category] += ss.duration;
+            cnt++;
+        }
     wxString stat = wxString::Format("Today: %d sessions\n", cnt);
     for (auto& p : appTimes)
         stat += wxString::Format("  %s: %s\n", p.first.Left(18), FormatTime(p.second));
+    int64_t now = (int64_t)wxDateTime::Now().GetTicks();
+    int64_t away = IdleLog::Total((int64_t)wxDateTime::Today().GetTicks(), now);
+    if (away > 0) stat += wxString::Format("  Away (not counted): %s\n", FormatTime((int)away));
+    int monthSecs = 0;
+    for (auto& ss : m_trk.History(now - 30 * 86400, now)) monthSecs += ss.duration;
+    stat += wxString::Format("Last 30 days: %s\n", FormatTime(monthSecs));
     auto* statLbl = new wxStaticText(&dlg, wxID_ANY, stat);
     statLbl->SetForegroundColour(CLR_DIM);
     s->Add(statLbl, 0, wxLEFT | wxTOP, 12);
+    auto* histBtn = new wxButton(&dlg, wxID_ANY, "History...");
+    histBtn->SetBackgroundColour(CLR_BLUE); histBtn->SetForegroundColour(CLR_TEXT);
+    histBtn->Bind(wxEVT_BUTTON, [this, &dlg](wxCommandEvent&) {
+        const BucketPyramid* pyr;
+        {
+            wxBusyCursor busy;
+            pyr = &m_trk.Timeline();
+        }
+        HistoryDialog hd(&dlg, *pyr);
+        hd.ShowModal();
+        });
+    auto* sessBtn = new wxButton(&dlg, wxID_ANY, "Sessions...");
+    sessBtn->SetBackgroundColour(CLR_BLUE); sessBtn->SetForegroundColour(CLR_TEXT);
+    sessBtn->Bind(wxEVT_BUTTON, [this, &dlg](wxCommandEvent&) {
+        SessionsDialog sd(&dlg, m_trk);
+        sd.ShowModal();
+        });
+    auto* histRow = new wxBoxSizer(wxHORIZONTAL);
+    histRow->Add(histBtn, 0, wxRIGHT, 6);
+    histRow->Add(sessBtn, 0);
+    s->Add(histRow, 0, wxLEFT | wxTOP, 12);
 
     s->AddStretchSpacer();
+    auto* diag = new wxButton(&dlg, wxID_ANY, "Diagnostics...");
+    diag->SetBackgroundColour(CLR_BLUE); diag->SetForegroundColour(CLR_TEXT);
+    diag->Bind(wxEVT_BUTTON, [this, &dlg](wxCommandEvent&) {
+        DiagnosticsDialog dd(&dlg);
+        dd.ShowModal();
+        m_trk.cfg.perfEnabled = PerfEnabled();
+        });
+    auto* rulesBtn = new wxButton(&dlg, wxID_ANY, "Rules...");
+    rulesBtn->SetBackgroundColour(CLR_BLUE); rulesBtn->SetForegroundColour(CLR_TEXT);
+    rulesBtn->Bind(wxEVT_BUTTON, [this, &dlg](wxCommandEvent&) {
+        RulesDialog rd(&dlg, m_trk.cfg.rules);
+        if (rd.ShowModal() != wxID_OK) return;
+        m_trk.cfg.rules = rd.Rules();
+        m_trk.ConfigChanged();
+        m_trk.Save();
+        });
+    auto* tools = new wxBoxSizer(wxHORIZONTAL);
+    tools->Add(rulesBtn, 0, wxRIGHT, 6);
+    tools->Add(diag, 0, wxRIGHT, 6);
+    auto* importBtn = new wxButton(&dlg, wxID_ANY, "Import logs...");
+    importBtn->SetBackgroundColour(CLR_BLUE); importBtn->SetForegroundColour(CLR_TEXT);
+    importBtn->Bind(wxEVT_BUTTON, [this, &dlg](wxCommandEvent&) {
+        wxString dir = wxDirSelector("Folder with WorkTimer logs from other machines",
+            wxEmptyString, wxDD_DEFAULT_STYLE | wxDD_DIR_MUST_EXIST, wxDefaultPosition, &dlg);
+        if (dir.IsEmpty()) return;
+        LogMerge::Result r;
+        {
+            wxBusyCursor busy;
+            r = LogMerge::Run(dir, [this](const HistRecord& rec) { m_trk.TimelineEdit(nullptr, &rec); });
+        }
+        wxMessageBox(wxString::Format(
+            "%llu files (%llu unreadable), %llu sessions read.\n"
+            "%llu sessions from %llu sources merged into history.",
+            (unsigned long long)r.files, (unsigned long long)r.failed,
+            (unsigned long long)r.read, (unsigned long long)r.merged,
+            (unsigned long long)r.sources), "Import logs", wxOK, &dlg);
+        });
+    tools->Add(importBtn, 0);
+    s->Add(tools, 0, wxALIGN_CENTER | wxBOTTOM, 6);
     auto* ok = new wxButton(&dlg, wxID_OK, "Apply");
     ok->SetBackgroundColour(CLR_RED); ok->SetForegroundColour(*wxWHITE);
     s->Add(ok, 0, wxALIGN_CENTER | wxBOTTOM, 12);
     dlg.SetSizer(s);
+    buildScope.End();
 
     if (dlg.ShowModal() == wxID_OK) {
-        m_cfg.colorAlert = cbAlert->GetValue();
-        m_cfg.alertMinutes = spin->GetValue();
-        m_cfg.alwaysOnTop = cbTop->GetValue();
-        m_cfg.startInTray = cbTray->GetValue();
+        cfg.colorAlert = cbAlert->GetValue();
+        cfg.alertMinutes = spin->GetValue();
+        cfg.idleMinutes = idleSpin->GetValue();
+        cfg.alwaysOnTop = cbTop->GetValue();
+        cfg.startInTray = cbTray->GetValue();
         long style = GetWindowStyle();
-        if (m_cfg.alwaysOnTop) style |= wxSTAY_ON_TOP;
+        if (cfg.alwaysOnTop) style |= wxSTAY_ON_TOP;
         else                    style &= ~wxSTAY_ON_TOP;
         SetWindowStyle(style);
-        SaveConfig(m_cfg, m_sessions);
+        m_trk.ConfigChanged();
+        m_trk.Save();
     }
 }
 
+
 void MainFrame::OnIconize(wxIconizeEvent& e) {
     if (e.IsIconized()) Show(false);
+    else UpdateDisplay();
+}
+
+void MainFrame::OnShow(wxShowEvent& e) {
+    if (e.IsShown()) UpdateDisplay();
+    e.Skip();
 }
 
 void MainFrame::OnClose(wxCloseEvent&) {
-    if (m_running) StopTimer();
-    SaveConfig(m_cfg, m_sessions);
+    if (m_trk.running || m_trk.Idle()) StopTimer();
+    m_trk.Save();
     Destroy();
 }
 
+// =========================================
+// Headless host
+// =========================================
+// --headless: runs the Tracker from a single 1s timer without creating
+// any windows, image lists or tray icon. With --perf-dump the report,
+// working set included, is rewritten once a minute. ticks > 0 is a
+// bounded run for the memory budget test: that many seconds on a scratch
+// copy of the ini, then the app exits.
+class HeadlessHost : public wxEvtHandler {
+public:
+    HeadlessHost(const wxString& perfDump, int ticks = 0)
+        : m_scratch(ticks > 0),
+          m_arc(ticks > 0 ? new HistoryArchive(m_scratch.path) : nullptr),
+          m_trk(m_arc ? m_scratch.path : DataDir(), m_arc ? *m_arc : HistoryArchive::Get()),
+          m_perfDump(perfDump), m_limit(ticks), m_timer(this) {
+        if (m_arc && wxFileExists(GetConfigPath())) wxCopyFile(GetConfigPath(), GetConfigPath(m_scratch.path));
+        m_trk.Load();
+        Bind(wxEVT_TIMER, &HeadlessHost::OnTimer, this);
+        m_timer.Start(1000);
+        // Drop the pages touched during startup; steady state is far smaller.
+        SetProcessWorkingSetSize(GetCurrentProcess(), (SIZE_T)-1, (SIZE_T)-1);
+    }
+
+    ~HeadlessHost() override {
+        m_timer.Stop();
+        if (m_trk.running || m_trk.Idle()) m_trk.Stop();
+        m_trk.Save();
+    }
+
+    // A bounded run ended over kHeadlessBudgetMb.
+    bool OverBudget() const { return m_over; }
+
+private:
+    ScratchDir        m_scratch;
+    std::unique_ptr<HistoryArchive> m_arc;      // bounded runs only
+    Tracker           m_trk;
+    ForegroundSampler m_fg;
+    wxString          m_perfDump;
+    int               m_limit;
+    int               m_ticks = 0;
+    bool              m_over = false;
+    wxTimer           m_timer;
+
+    void OnTimer(wxTimerEvent&) {
+        PERF_SCOPE(kPerfMonitor);
+        PERF_HOT_ALLOCS();
+        ++m_ticks;
+        if (!m_perfDump.IsEmpty() && m_ticks % 60 == 0) {
+            PERF_HOT_ALLOCS_SKIP();
+            PerfDump(m_perfDump, true);
+        }
+        m_trk.Tick();
+        const wchar_t* exe = m_fg.Sample();
+        if (SampleRecorder::Get().Record(exe, m_fg.Pid(), &m_fg, &m_fg)) PERF_HOT_ALLOCS_SKIP();
+        if (m_trk.Sample(exe, &m_fg, &m_fg) != Tracker::kNone) PERF_HOT_ALLOCS_SKIP();
+        if (m_limit > 0 && m_ticks == m_limit) {
+            PERF_HOT_ALLOCS_SKIP();
+            m_over = WorkingSetMb() > kHeadlessBudgetMb;
+            wxTheApp->ExitMainLoop();
+        }
+    }
+};
+
 // =========================================
 // App entry
 // =========================================
 class WorkTimerApp : public wxApp {
 public:
     bool OnInit() override {
+        StartupPhases::Get().Mark("OnInit");
         SetAppName("WorkTimer");
-        wxInitAllImageHandlers();
+        wxString traceFile, importFile, exportFile;
+        wxString recordFile, replayFile, genFile, pattern = "heavy", daysArg;
+        wxString benchArg, ticksArg;
+        for (int i = 1; i < argc; i++) {
+            if (argv[i] == "--headless") m_headless = true;
+            else if (argv[i] == "--perf") PerfEnable(true);
+            else if (argv[i].StartsWith("--perf-dump=", &m_perfDump)) PerfEnable(true);
+            else if (argv[i].StartsWith("--trace=", &traceFile))
+                TraceRecorder::Get().Start(traceFile);
+            else if (argv[i].StartsWith("--import=", &importFile)) m_command = true;
+            else if (argv[i].StartsWith("--export=", &exportFile)) m_command = true;
+            else if (argv[i].StartsWith("--record=", &recordFile)) continue;
+            else if (argv[i].StartsWith("--replay=", &replayFile)) m_command = true;
+            else if (argv[i].StartsWith("--gen-trace=", &genFile)) m_command = true;
+            else if (argv[i].StartsWith("--pattern=", &pattern)) continue;
+            else if (argv[i].StartsWith("--days=", &daysArg)) continue;
+            else if (argv[i] == "--bench-catalog") { benchArg = "50000"; m_command = true; }
+            else if (argv[i].StartsWith("--bench-catalog=", &benchArg)) m_command = true;
+            else if (argv[i].StartsWith("--ticks=", &ticksArg)) continue;
+            else if (argv[i] == "--startup-check") m_startupCheck = true;
+        }
+
+        // The archive is safe to share, so commands run alongside a tracker.
+        // A replay works on its own scratch copy in the temp directory.
+        if (m_command) {
+            long days = 30;
+            if (!daysArg.IsEmpty()) daysArg.ToLong(&days);
+            if (!benchArg.IsEmpty()) m_exitCode = RunBenchCommand(benchArg);
+            else m_exitCode = replayFile.IsEmpty() && genFile.IsEmpty()
+                ? RunHistoryCommand(importFile, exportFile)
+                : RunTraceCommand(genFile, pattern, (int)days, replayFile);
+            return true;
+        }
+
+        // A bounded --headless run tracks into a scratch copy, so it
+        // leaves a running tracker alone.
+        long ticks = 0;
+        if (m_headless && ticksArg.ToLong(&ticks) && ticks > 0) {
+            m_host = new HeadlessHost(m_perfDump, (int)ticks);
+            return true;
+        }
+
+        // Likewise a startup check: the window on a scratch copy of the ini,
+        // up to the deferred work.
+        if (m_startupCheck) {
+            m_scratch.reset(new ScratchDir());
+            if (wxFileExists(GetConfigPath())) wxCopyFile(GetConfigPath(), GetConfigPath(m_scratch->path));
+            new MainFrame(m_scratch->path);
+            return true;
+        }
+
+        // One tracker per user, across logon sessions: two would each
+        // rewrite work_timer.ini and drop the other's sessions.
+        m_instance.Create("Global\\WorkTimer-" + wxGetUserId());
+        if (m_instance.IsAnotherRunning() && !HandOver()) return false;
+        m_pipe.Serve(m_headless ? InstancePipe::kHeadless : InstancePipe::kWindow,
+            [this](InstancePipe::Request req) { CallAfter([this, req] { OnForwarded(req); }); });
+        if (!recordFile.IsEmpty()) SampleRecorder::Get().Start(recordFile);
+
+        if (m_headless) {
+            m_host = new HeadlessHost(m_perfDump);
+            return true;
+        }
+
         auto* frame = new MainFrame();
         frame->Show(true);
         return true;
     }
+
+    int OnRun() override {
+        if (m_command) return m_exitCode;
+        int rc = wxApp::OnRun();
+        if (m_startupCheck) {
+            double ms = StartupPhases::Get().Ms("first sample");
+            return ms < 0 || ms > kFirstSampleBudgetMs ? 1 : rc;
+        }
+        return m_host && m_host->OverBudget() ? 1 : rc;
+    }
+
+    int OnExit() override {
+        m_pipe.Stop();
+        if (!m_perfDump.IsEmpty()) PerfDump(m_perfDump, m_headless);
+        TraceRecorder::Get().Stop();
+        SampleRecorder::Get().Stop();
+        ExeCatalog::Get().Stop();
+        delete m_host;
+        m_host = nullptr;
+        HistoryArchive::Get().Stop();
+        return wxApp::OnExit();
+    }
+
+private:
+    bool          m_headless = false;
+    bool          m_command = false;
+    int           m_exitCode = 0;
+    wxString      m_perfDump;
+    HeadlessHost* m_host = nullptr;
+    bool          m_startupCheck = false;
+    std::unique_ptr<ScratchDir> m_scratch;  // --startup-check
+    wxSingleInstanceChecker m_instance;
+    InstancePipe  m_pipe;
+
+    // Another instance owns tracking. A window in this session is raised;
+    // a headless tracker may be stopped so this launch takes over. True
+    // if this launch should go on starting up.
+    bool HandOver() {
+        InstancePipe::Reply r = InstancePipe::Call(InstancePipe::kActivate);
+        if (r.kind == InstancePipe::kWindow && r.session == InstancePipe::Session()) {
+            AllowSetForegroundWindow(r.pid);
+            return false;
+        }
+        if (m_headless) return false;
+        if (r.kind == InstancePipe::kWindow) {
+            wxMessageBox(wxString::Format("WorkTimer is already open in another Windows session "
+                "(session %u). Close it there to track here.", r.session),
+                "WorkTimer", wxOK | wxICON_INFORMATION);
+            return false;
+        }
+        if (r.kind == InstancePipe::kNobody) {
+            wxMessageBox("Another WorkTimer instance is already tracking for this user.",
+                "WorkTimer", wxOK | wxICON_INFORMATION);
+            return false;
+        }
+        if (wxMessageBox("WorkTimer is already tracking in the background (--headless).\n"
+            "Stop it and open the window here?", "WorkTimer", wxYES_NO | wxICON_QUESTION) != wxYES)
+            return false;
+        // It saves on the way out; ours keeps the instance mutex alive.
+        HANDLE proc = OpenProcess(SYNCHRONIZE, FALSE, r.pid);
+        bool gone = InstancePipe::Call(InstancePipe::kQuit).kind == InstancePipe::kHeadless &&
+            proc && WaitForSingleObject(proc, 10000) == WAIT_OBJECT_0;
+        if (proc) CloseHandle(proc);
+        if (!gone) wxMessageBox("The background tracker did not stop.", "WorkTimer", wxOK | wxICON_ERROR);
+        return gone;
+    }
+
+    void OnForwarded(InstancePipe::Request req) {
+        if (req == InstancePipe::kQuit) {
+            if (m_headless) ExitMainLoop();
+            return;
+        }
+        if (wxWindow* top = GetTopWindow()) {
+            top->Show(true);
+            if (auto* frame = dynamic_cast<wxFrame*>(top)) frame->Restore();
+            top->Raise();
+        }
+    }
+
+    // --import=<file> / --export=<file>: no windows; the summary is shown
+    // unless --headless is also given.
+    int RunHistoryCommand(const wxString& importFile, const wxString& exportFile) {
+        wxString msg;
+        bool ok = true;
+        Tracker trk;
+        trk.Load();
+        if (!importFile.IsEmpty()) {
+            HistoryIO::Result r = HistoryIO::Import(importFile, trk.sessions);
+            ok = ok && r.ok;
+            msg += r.ok ? wxString::Format("Imported %llu sessions from %s (%llu skipped, "
+                "%llu already in this month's sessions).\n",
+                (unsigned long long)r.sessions, importFile, (unsigned long long)r.skipped,
+                (unsigned long long)r.hot)
+                : r.error + "\n";
+        }
+        if (!exportFile.IsEmpty()) {
+            HistoryIO::Result r = HistoryIO::Export(exportFile, trk.sessions);
+            ok = ok && r.ok;
+            msg += r.ok ? wxString::Format("Exported %llu sessions to %s.\n",
+                (unsigned long long)r.sessions, exportFile) : r.error + "\n";
+        }
+        if (!m_headless)
+            wxMessageBox(msg, "WorkTimer", wxOK | (ok ? wxICON_INFORMATION : wxICON_ERROR));
+        return ok ? 0 : 1;
+    }
+
+    // --bench-catalog[=n]: times installed-app search over n synthetic
+    // entries (default 50000). Fails if a query's median is over budget.
+    int RunBenchCommand(const wxString& benchArg) {
+        long n = 50000;
+        if (!benchArg.ToLong(&n) || n <= 0) n = 50000;
+        wxString report;
+        bool ok = ExeCatalog::Bench((size_t)n, report);
+        if (m_headless) fputs(report.utf8_str(), stdout);
+        else wxMessageBox(report, "WorkTimer", wxOK | (ok ? wxICON_INFORMATION : wxICON_ERROR));
+        return ok ? 0 : 1;
+    }
+
+    // --gen-trace=<file> [--pattern=heavy|steady] [--days=n] writes a
+    // synthetic trace; --replay=<file> replays one and saves the report as
+    // <file>.report.txt. Both may be given.
+    int RunTraceCommand(const wxString& genFile, const wxString& pattern, int days,
+        const wxString& replayFile) {
+        wxString msg;
+        bool ok = true;
+        if (!genFile.IsEmpty()) {
+            wxString err;
+            ok = GenerateTrace(genFile, pattern, days, &err);
+            msg += ok ? wxString::Format("Wrote %s (%s, %d days).\n", genFile, pattern, days) : err + "\n";
+        }
+        if (ok && !replayFile.IsEmpty()) {
+            TraceReplay::Result r = TraceReplay::Run(replayFile);
+            ok = r.ok && r.passed;
+            msg += r.ok ? r.report : r.error + "\n";
+            if (r.ok) WriteWholeFile(replayFile + ".report.txt", std::string(r.report.utf8_str()));
+        }
+        if (!m_headless)
+            wxMessageBox(msg, "WorkTimer", wxOK | (ok ? wxICON_INFORMATION : wxICON_ERROR));
+        return ok ? 0 : 1;
+    }
 };
 
 wxIMPLEMENT_APP(WorkTimerApp);
\ No newline at end of file
@@ -0,0 +1,17 @@
+// Replaces the global operator new for core_tests to count every heap
+// allocation; see SteadyStateDoesNotAllocate. A translation unit of its
+// own so the replacements aren't inlined into their callers.
+
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+uint64_t g_allocs = 0;
+
+void* operator new(size_t n) {
+    g_allocs++;
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
@@ -0,0 +1,1230 @@
+// Tests for the wx-free core in src/core. A plain console program: each
+// TEST registers itself, main runs them all and exits non-zero on any
+// failed CHECK.
+
+#include "core/bucket_pyramid.h"
+#include "core/bytes.h"
+#include "core/clock_text.h"
+#include "core/csv.h"
+#include "core/hist_segment.h"
+#include "core/idle_gap.h"
+#include "core/journal.h"
+#include "core/log_merge.h"
+#include "core/proc_snapshot.h"
+#include "core/rule_table.h"
+#include "core/session_edit.h"
+#include "core/timer_wheel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <csignal>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+struct TestCase {
+    const char* name;
+    void (*fn)();
+};
+
+std::vector<TestCase>& Registry() {
+    static std::vector<TestCase> tests;
+    return tests;
+}
+
+int g_failures = 0;
+
+struct Register {
+    Register(const char* name, void (*fn)()) { Registry().push_back({ name, fn }); }
+};
+
+} // namespace
+
+#define TEST(name) \
+    static void name(); \
+    static Register name##_reg(#name, name); \
+    static void name()
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            std::printf("  %s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            g_failures++; \
+        } \
+    } while (0)
+
+// -----------------------------------------
+// Binary IO
+// -----------------------------------------
+TEST(VarintRoundTrip) {
+    const uint64_t values[] = { 0, 1, 127, 128, 300, 16383, 16384, 1u << 31,
+        std::numeric_limits<uint64_t>::max() };
+    ByteWriter w;
+    for (uint64_t v : values) w.Var(v);
+    w.WStr(L"Code.exe");
+    w.U32(0xdeadbeef);
+    ByteReader r(w.buf.data(), w.buf.size());
+    for (uint64_t v : values) CHECK(r.Var() == v);
+    CHECK(r.WStr() == L"Code.exe");
+    CHECK(r.U32() == 0xdeadbeef);
+    CHECK(r.Ok() && r.AtEnd());
+}
+
+TEST(ReaderRejectsTruncation) {
+    ByteWriter w;
+    w.Var(1u << 20);
+    w.WStr(L"chrome.exe");
+    for (size_t n = 0; n < w.buf.size(); n++) {
+        ByteReader r(w.buf.data(), n);
+        r.Var();
+        r.WStr();
+        CHECK(!r.Ok());
+    }
+}
+
+// -----------------------------------------
+// History segment codec
+// -----------------------------------------
+static std::vector<HistRecord> SampleRecords(size_t n) {
+    const wchar_t* apps[] = { L"Code.exe", L"devenv.exe", L"chrome.exe", L"WindowsTerminal.exe" };
+    const wchar_t* sources[] = { L"", L"laptop", L"desktop" };
+    const wchar_t* cats[] = { L"", L"Jira", L"Meetings" };
+    std::mt19937 rng(7);
+    std::vector<HistRecord> recs;
+    int64_t t = 1717200000;
+    for (size_t i = 0; i < n; i++) {
+        HistRecord r;
+        t += rng() % 4000;
+        r.start = t;
+        r.dur = 1 + rng() % 7200;
+        r.app = apps[rng() % 4];
+        r.source = sources[rng() % 3];
+        r.category = cats[rng() % 3];
+        recs.push_back(r);
+    }
+    return recs;
+}
+
+static std::vector<HistRecord> DecodeAll(const HistSegment& seg, int64_t from, int64_t to) {
+    std::vector<HistRecord> out;
+    for (auto& b : seg.blocks) CHECK(seg.Decode(b, out, from, to));
+    return out;
+}
+
+TEST(SegmentRoundTrip) {
+    // Several blocks, out of order, with duplicates.
+    std::vector<HistRecord> recs = SampleRecords(HistSegment::kBlock * 3 + 17);
+    std::vector<HistRecord> input(recs.rbegin(), recs.rend());
+    input.push_back(recs[5]);
+    input.push_back(recs[200]);
+
+    std::string raw = HistSegment::Encode(input);
+    HistSegment seg;
+    CHECK(seg.Parse(raw));
+    CHECK(seg.version == HistSegment::kVersion);
+    CHECK(seg.records == recs.size());
+    CHECK(seg.blocks.size() == 4);
+    std::vector<HistRecord> back = DecodeAll(seg,
+        std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max());
+    std::sort(recs.begin(), recs.end());
+    CHECK(back == recs);
+    for (auto& b : seg.blocks) CHECK(b.minStart <= b.maxEnd);
+}
+
+TEST(SegmentDecodeRange) {
+    std::vector<HistRecord> recs = SampleRecords(500);
+    std::vector<HistRecord> input = recs;
+    HistSegment seg;
+    std::string raw = HistSegment::Encode(input);
+    CHECK(seg.Parse(raw));
+    std::sort(recs.begin(), recs.end());
+    int64_t from = recs[100].start, to = recs[300].start;
+    std::vector<HistRecord> want;
+    for (auto& r : recs)
+        if (r.start < to && r.End() > from) want.push_back(r);
+    CHECK(DecodeAll(seg, from, to) == want);
+}
+
+TEST(SegmentRejectsCorruption) {
+    std::vector<HistRecord> input = SampleRecords(300);
+    std::string raw = HistSegment::Encode(input);
+    HistSegment seg;
+    CHECK(!seg.Parse(raw.substr(0, raw.size() - 1)));
+    CHECK(!seg.Parse(raw.substr(0, 20)));
+    std::string bad = raw;
+    bad[0] = 'X';
+    CHECK(!seg.Parse(bad));
+    std::vector<HistRecord> none;
+    std::string empty = HistSegment::Encode(none);
+    CHECK(seg.Parse(empty) && seg.records == 0 && seg.blocks.empty());
+}
+
+// -----------------------------------------
+// History journal
+// -----------------------------------------
+TEST(JournalSkipsTornRecords) {
+    std::vector<HistRecord> recs = SampleRecords(6);
+    std::string raw, good;
+    for (size_t i = 0; i < recs.size(); i++) {
+        std::string one;
+        HistJournal::Put(one, recs[i], i == 2);
+        if (i == 3) one[one.size() / 2] ^= 1;      // flipped bit
+        if (i == 5) one.resize(one.size() - 3);    // writer died mid-append
+        raw += one;
+    }
+    std::vector<HistRecord> back;
+    std::vector<bool> tombs;
+    size_t bad = HistJournal::Parse(raw, [&](const HistRecord& r, bool tomb) {
+        back.push_back(r);
+        tombs.push_back(tomb);
+        });
+    CHECK(bad == 2);
+    CHECK(back.size() == 4 && back[0] == recs[0] && back[1] == recs[1] &&
+        back[2] == recs[2] && back[3] == recs[4]);
+    CHECK(tombs == std::vector<bool>({ false, false, true, false }));
+    CHECK(HistJournal::Parse(std::string(), [](const HistRecord&, bool) {}) == 0);
+}
+
+#ifdef __linux__
+static std::string ReadFileBytes(const std::string& path) {
+    std::string out;
+    if (FILE* f = std::fopen(path.c_str(), "rb")) {
+        char buf[65536];
+        size_t n;
+        while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0) out.append(buf, n);
+        std::fclose(f);
+    }
+    return out;
+}
+
+TEST(JournalConcurrentAppends) {
+    // The archive's discipline with flock for LockFileEx: appenders hold
+    // the lock shared and write each batch with one O_APPEND write; the
+    // packer holds it exclusive, folds the journal away and removes it.
+    // Every record must come out exactly once, and none torn.
+    const int kWriters = 8, kRecords = 400;
+    char tmpl[] = "/tmp/wtjournalXXXXXX";
+    CHECK(mkdtemp(tmpl) != nullptr);
+    const std::string dir = tmpl, journal = dir + "/journal.wtj",
+        lockPath = dir + "/archive.lock", packed = dir + "/packed";
+
+    auto record = [](int w, int seq) {
+        HistRecord r;
+        r.start = (int64_t)w * 1000000 + seq;
+        r.dur = (uint32_t)seq + 1;
+        r.app = L"writer" + std::to_wstring(w) + L".exe";
+        r.category.assign((size_t)(seq * 37 % 3000), L'x');  // batches up to tens of KB
+        return r;
+    };
+
+    std::vector<pid_t> kids;
+    for (int w = 0; w < kWriters; w++) {
+        pid_t pid = fork();
+        if (pid != 0) { kids.push_back(pid); continue; }
+        int lock = open(lockPath.c_str(), O_RDWR | O_CREAT, 0644);
+        std::string batch;
+        for (int seq = 0; seq < kRecords; ) {
+            batch.clear();
+            for (int n = 1 + seq % 4; n > 0 && seq < kRecords; n--)
+                HistJournal::Put(batch, record(w, seq++), false);
+            if (flock(lock, LOCK_SH) != 0) _exit(1);
+            int fd = open(journal.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+            bool ok = fd >= 0 && write(fd, batch.data(), batch.size()) == (ssize_t)batch.size();
+            if (fd >= 0) close(fd);
+            flock(lock, LOCK_UN);
+            if (!ok) _exit(1);
+        }
+        _exit(0);
+    }
+    pid_t packer = fork();
+    if (packer == 0) {
+        int lock = open(lockPath.c_str(), O_RDWR | O_CREAT, 0644);
+        for (int pass = 0; pass < 200; pass++) {
+            usleep(500);
+            if (flock(lock, LOCK_EX) != 0) _exit(1);
+            std::string raw = ReadFileBytes(journal), keep;
+            size_t bad = HistJournal::Parse(raw, [&](const HistRecord& r, bool tomb) {
+                HistJournal::Put(keep, r, tomb);
+                });
+            int fd = open(packed.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+            bool ok = fd >= 0 && write(fd, keep.data(), keep.size()) == (ssize_t)keep.size();
+            if (fd >= 0) close(fd);
+            unlink(journal.c_str());
+            flock(lock, LOCK_UN);
+            if (bad || !ok) _exit(1);
+        }
+        _exit(0);
+    }
+    kids.push_back(packer);
+    for (pid_t k : kids) {
+        int status = 0;
+        CHECK(waitpid(k, &status, 0) == k && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    }
+
+    std::map<int64_t, int> seen;
+    size_t bad = 0;
+    for (const std::string& path : { packed, journal }) {
+        bad += HistJournal::Parse(ReadFileBytes(path), [&](const HistRecord& r, bool tomb) {
+            int w = (int)(r.start / 1000000), seq = (int)(r.start % 1000000);
+            CHECK(!tomb && w < kWriters && seq < kRecords && r == record(w, seq));
+            seen[r.start]++;
+            });
+    }
+    CHECK(bad == 0);
+    CHECK(seen.size() == (size_t)kWriters * kRecords);
+    CHECK(std::all_of(seen.begin(), seen.end(), [](const auto& kv) { return kv.second == 1; }));
+
+    unlink(journal.c_str());
+    unlink(packed.c_str());
+    unlink(lockPath.c_str());
+    rmdir(dir.c_str());
+}
+#endif
+
+// -----------------------------------------
+// Log merge
+// -----------------------------------------
+static std::vector<MergeRec> Merge(const std::vector<std::vector<MergeRec>>& runs) {
+    std::vector<const std::vector<MergeRec>*> ptrs;
+    for (auto& r : runs) ptrs.push_back(&r);
+    return MergeRuns(ptrs, 0);
+}
+
+TEST(MergeCollapsesOverlaps) {
+    // src 0, app 1: [100,200) and [150,300) become [100,300); [300,310)
+    // only touches, so it stays separate.
+    std::vector<std::vector<MergeRec>> runs = {
+        { { 100, 100, 1, 0, 0 }, { 300, 10, 1, 0, 0 } },
+        { { 150, 150, 1, 0, 0 } },
+    };
+    std::vector<MergeRec> out = Merge(runs);
+    CHECK(out.size() == 2);
+    CHECK(out[0].start == 100 && out[0].dur == 200);
+    CHECK(out[1].start == 300 && out[1].dur == 10);
+}
+
+TEST(MergeDropsCopiedLogs) {
+    // The same interval under a second source is a copy; another app at
+    // the same start is not.
+    std::vector<std::vector<MergeRec>> runs = {
+        { { 100, 60, 1, 0, 0 } },
+        { { 100, 60, 1, 5, 0 } },
+        { { 100, 60, 2, 5, 0 } },
+    };
+    std::vector<MergeRec> out = Merge(runs);
+    CHECK(out.size() == 2);
+    CHECK(out[0].app != out[1].app);
+}
+
+TEST(MergeMatchesBruteForce) {
+    // One source, so nothing is dropped as a copy: per app, the merged
+    // output covers exactly the union of the inputs, sorted and disjoint.
+    std::mt19937 rng(11);
+    std::vector<std::vector<MergeRec>> runs(6);
+    std::set<std::pair<uint32_t, int64_t>> covered;     // app, second
+    for (auto& run : runs) {
+        int64_t t = rng() % 50;
+        for (int i = 0; i < 200; i++) {
+            t += rng() % 40;
+            MergeRec r = { t, 1 + (uint32_t)(rng() % 60), (uint32_t)(rng() % 3), 0, 0 };
+            run.push_back(r);
+            for (int64_t s = r.start; s < r.start + r.dur; s++) covered.insert({ r.app, s });
+        }
+    }
+    std::vector<MergeRec> out = Merge(runs);
+    std::set<std::pair<uint32_t, int64_t>> got;
+    std::vector<int64_t> lastEnd(3, -1);
+    for (size_t i = 0; i < out.size(); i++) {
+        const MergeRec& r = out[i];
+        if (i) CHECK(out[i - 1].start <= r.start);
+        CHECK(r.start >= lastEnd[r.app]);
+        lastEnd[r.app] = r.start + r.dur;
+        for (int64_t s = r.start; s < r.start + r.dur; s++) got.insert({ r.app, s });
+    }
+    CHECK(got == covered);
+}
+
+// -----------------------------------------
+// Rules
+// -----------------------------------------
+struct FakeTitle : TitleSource {
+    const wchar_t* text;
+    int            reads = 0;
+    explicit FakeTitle(const wchar_t* t) : text(t) {}
+    const wchar_t* Title() override { reads++; return text; }
+};
+
+// Category name, "ignore" or "" for no match.
+static std::wstring Classify(const RuleTable& t, const wchar_t* exe, int weekday, int minute,
+    TitleSource* title = nullptr) {
+    int v = t.Eval({ exe, weekday, minute, title });
+    return v == RuleTable::kNoMatch ? L"" : v == RuleTable::kIgnore ? L"ignore" : t.Category(v);
+}
+
+TEST(RulesFirstMatchWins) {
+    RuleTable t;
+    CHECK(t.Compile({
+        L"# comment",
+        L"chrome.exe title~jira -> Jira",
+        L"* days=sat,sun -> ignore",
+        L"chrome.exe -> Browsing",
+        L"",
+        L"* time=22:00-06:00 -> Late",
+        }, nullptr));
+    FakeTitle jira(L"proj-12 - jira"), news(L"news");
+    // Monday noon: the exe's own rows and wildcards interleave in file order.
+    CHECK(Classify(t, L"chrome.exe", 1, 720, &jira) == L"Jira");
+    CHECK(Classify(t, L"chrome.exe", 1, 720, &news) == L"Browsing");
+    // The weekend wildcard sits above the plain chrome row.
+    CHECK(Classify(t, L"chrome.exe", 6, 720, &news) == L"ignore");
+    CHECK(Classify(t, L"chrome.exe", 0, 720, &jira) == L"Jira");
+    // Other exes only see the wildcard rows; the window wraps midnight.
+    CHECK(Classify(t, L"code.exe", 1, 23 * 60) == L"Late");
+    CHECK(Classify(t, L"code.exe", 1, 5 * 60 + 59) == L"Late");
+    CHECK(Classify(t, L"code.exe", 1, 6 * 60) == L"");
+    CHECK(Classify(t, L"code.exe", 0, 720) == L"ignore");
+}
+
+TEST(RulesReadTitleLazily) {
+    RuleTable t;
+    CHECK(t.Compile({ L"slack.exe time=10:00-11:00 -> Meetings",
+        L"slack.exe \"title!~do not disturb\" -> Chat" }, nullptr));
+    FakeTitle title(L"general");
+    CHECK(Classify(t, L"slack.exe", 2, 10 * 60 + 30, &title) == L"Meetings");
+    CHECK(title.reads == 0);
+    CHECK(Classify(t, L"slack.exe", 2, 9 * 60, &title) == L"Chat");
+    CHECK(title.reads == 1);
+    FakeTitle dnd(L"status: do not disturb");
+    CHECK(Classify(t, L"slack.exe", 2, 9 * 60, &dnd) == L"");
+    CHECK(Classify(t, L"slack.exe", 2, 9 * 60) == L"Chat");     // no title source
+}
+
+TEST(RulesCaseAndDayRanges) {
+    RuleTable t;
+    CHECK(t.Compile({ L"Code.EXE days=Fri-Mon -> Weekend", L"* days=weekdays -> Work" }, nullptr));
+    CHECK(Classify(t, L"code.exe", 5, 0) == L"Weekend");
+    CHECK(Classify(t, L"code.exe", 1, 0) == L"Weekend");
+    CHECK(Classify(t, L"code.exe", 3, 0) == L"Work");
+    CHECK(Classify(t, L"code.exe", 6, 0) == L"Weekend");
+    CHECK(Classify(t, L"devenv.exe", 6, 0) == L"");
+}
+
+TEST(RulesRejectBadLines) {
+    RuleTable t;
+    std::wstring err;
+    CHECK(!t.Compile({ L"* -> ok", L"chrome.exe when=now -> X" }, &err));
+    CHECK(err.rfind(L"Line 2: unknown condition", 0) == 0);
+    CHECK(t.Empty());
+    CHECK(!t.Compile({ L"* time=25:00-26:00 -> X" }, &err));
+    CHECK(!t.Compile({ L"* days=someday -> X" }, &err));
+    CHECK(!t.Compile({ L"* title~ -> X" }, &err));
+    CHECK(!t.Compile({ L"chrome.exe X" }, &err));
+    CHECK(t.Compile({ L"* time=09:00-24:00 -> X" }, &err));
+}
+
+// -----------------------------------------
+// Timer wheel
+// -----------------------------------------
+TEST(WheelFiresOnTimeAcrossLevels) {
+    // Deltas either side of each level boundary, and one past the wheel's
+    // range, which cascades back in as the clock catches up.
+    const int64_t deltas[] = { 1, 2, 63, 64, 65, 4095, 4096, 4097, 262143, 262144, 262145,
+        (int64_t)1 << 24, ((int64_t)1 << 24) + 100 };
+    const uint32_t n = sizeof(deltas) / sizeof(deltas[0]);
+    const int64_t t0 = 1000003;     // not slot-aligned
+    TimerWheel w;
+    w.Reset(t0);
+    w.Reserve(n);
+    for (uint32_t i = 0; i < n; i++) w.Add(i, t0 + deltas[i]);
+    std::vector<int64_t> firedAt(n, -1);
+    std::vector<uint32_t> fired;
+    for (int64_t t = t0 + 1; t <= t0 + deltas[n - 1]; t++) {
+        fired.clear();
+        w.Advance(t, fired);
+        for (uint32_t id : fired) {
+            CHECK(firedAt[id] < 0);
+            firedAt[id] = t;
+        }
+    }
+    for (uint32_t i = 0; i < n; i++) CHECK(firedAt[i] == t0 + deltas[i]);
+}
+
+TEST(WheelMatchesBruteForce) {
+    std::mt19937 rng(3);
+    const uint32_t n = 400;
+    TimerWheel w;
+    w.Reset(0);
+    w.Reserve(n);
+    std::vector<int64_t> due(n, -1);   // -1 = not armed
+    for (uint32_t i = 0; i < n; i++) {
+        due[i] = 1 + rng() % 300000;
+        w.Add(i, due[i]);
+    }
+    std::vector<uint32_t> fired;
+    fired.reserve(n);
+    size_t capacity = fired.capacity();
+    int64_t now = 0;
+    while (now < 320000) {
+        // Mostly small strides, now and then more than a day (a resume).
+        int64_t next = now + (rng() % 50 ? 1 + rng() % 700 : 90000);
+        // Move or cancel a few timers between steps.
+        for (int k = 0; k < 3; k++) {
+            uint32_t id = rng() % n;
+            if (rng() % 2) { w.Cancel(id); due[id] = -1; }
+            else { due[id] = now + 1 + rng() % 100000; w.Add(id, due[id]); }
+        }
+        fired.clear();
+        w.Advance(next, fired);
+        std::vector<uint32_t> want;
+        for (uint32_t i = 0; i < n; i++)
+            if (due[i] >= 0 && due[i] <= next) { want.push_back(i); due[i] = -1; }
+        std::sort(fired.begin(), fired.end());
+        CHECK(fired == want);
+        CHECK(w.Now() == next);
+        now = next;
+    }
+    CHECK(fired.capacity() == capacity);
+}
+
+TEST(WheelReAddMovesTimer) {
+    TimerWheel w;
+    w.Reset(100);
+    w.Reserve(2);
+    w.Add(0, 200);
+    w.Add(0, 150);          // moves, doesn't duplicate
+    w.Add(1, 50);           // already past: fires next tick
+    std::vector<uint32_t> fired;
+    w.Advance(101, fired);
+    CHECK(fired == std::vector<uint32_t>{ 1 });
+    fired.clear();
+    w.Advance(300, fired);
+    CHECK(fired == std::vector<uint32_t>{ 0 });
+    w.Reserve(2);           // disarms everything
+    w.Add(1, 310);
+    w.Cancel(1);
+    fired.clear();
+    w.Advance(400, fired);
+    CHECK(fired.empty());
+}
+
+// -----------------------------------------
+// Benchmarks
+// -----------------------------------------
+// Timings are printed; only the stated targets are checked, and only in
+// optimized builds.
+static double Ms(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+#ifdef NDEBUG
+static const bool kTimed = true;
+#else
+static const bool kTimed = false;
+#endif
+
+TEST(BenchSegmentCompression) {
+    // Against the same records written flat: u64 start, u32 duration and
+    // three strings.
+    std::vector<HistRecord> recs = SampleRecords(100000);
+    ByteWriter flat;
+    for (auto& r : recs) {
+        flat.U64((uint64_t)r.start);
+        flat.U32(r.dur);
+        flat.WStr(r.app);
+        flat.WStr(r.source);
+        flat.WStr(r.category);
+    }
+    std::vector<HistRecord> input = recs;
+    auto t0 = std::chrono::steady_clock::now();
+    std::string raw = HistSegment::Encode(input);
+    double encodeMs = Ms(t0);
+    std::printf("  segment: %zu records, %.1f bytes/record, %.1fx smaller than flat, encode %.1f ms\n",
+        recs.size(), (double)raw.size() / recs.size(), (double)flat.buf.size() / raw.size(), encodeMs);
+    CHECK(raw.size() * 4 < flat.buf.size());
+
+    // A month view: parse, then decode only the blocks that overlap 30 days.
+    std::sort(recs.begin(), recs.end());
+    int64_t from = recs[recs.size() / 2].start, to = from + 30 * 86400;
+    size_t want = 0;
+    for (auto& r : recs) want += r.start < to && r.End() > from;
+    t0 = std::chrono::steady_clock::now();
+    HistSegment seg;
+    CHECK(seg.Parse(raw));
+    std::vector<HistRecord> out;
+    for (auto& b : seg.blocks)
+        if (b.minStart < to && b.maxEnd > from) seg.Decode(b, out, from, to);
+    double monthMs = Ms(t0);
+    std::printf("  segment: month view of %zu records in %.2f ms (target 20 ms)\n", out.size(), monthMs);
+    CHECK(out.size() == want);
+    CHECK(!kTimed || monthMs < 20);
+}
+
+TEST(BenchMergeThroughput) {
+    // 200 logs of 5000 sessions each, one app per source, offsets so they
+    // interleave.
+    std::mt19937 rng(5);
+    std::vector<std::vector<MergeRec>> runs(200);
+    size_t total = 0;
+    for (uint32_t i = 0; i < runs.size(); i++) {
+        int64_t t = rng() % 3600;
+        for (int k = 0; k < 5000; k++) {
+            t += 60 + rng() % 3600;
+            runs[i].push_back({ t, 1 + (uint32_t)(rng() % 1800), i % 8, i, 0 });
+        }
+        total += runs[i].size();
+    }
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<MergeRec> out = Merge(runs);
+    double ms = Ms(t0);
+    std::printf("  merge: %zu sessions from %zu logs in %.1f ms, %.2f M sessions/s\n",
+        total, runs.size(), ms, total / std::max(ms, 1e-3) / 1000.0);
+    CHECK(!out.empty() && out.size() <= total);
+}
+
+TEST(BenchRuleEvaluation) {
+    // A realistic table, evaluated for a spread of exes, days and minutes.
+    RuleTable t;
+    CHECK(t.Compile({
+        L"chrome.exe title~jira -> Jira",
+        L"chrome.exe title~confluence -> Jira",
+        L"* days=sat,sun -> ignore",
+        L"slack.exe time=10:00-11:00 -> Meetings",
+        L"Teams.exe -> Meetings",
+        L"Code.exe -> Coding",
+        L"devenv.exe -> Coding",
+        L"* time=22:00-06:00 -> Late",
+        }, nullptr));
+    const wchar_t* exes[] = { L"chrome.exe", L"slack.exe", L"code.exe", L"explorer.exe" };
+    FakeTitle title(L"proj-12 - jira - google chrome");
+    const int n = 2000000;
+    int hits = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) {
+        RuleSample rs = { exes[i & 3], i % 7, (i * 7) % 1440, &title };
+        hits += t.Eval(rs) >= 0;
+    }
+    double ms = Ms(t0);
+    std::printf("  rules: %d evaluations in %.1f ms, %.1f ns each, %d title reads\n",
+        n, ms, ms * 1e6 / n, title.reads);
+    // Only chrome's rows need the title.
+    CHECK(hits > 0 && title.reads == n / 4);
+}
+
+TEST(BenchTimelineMonthView) {
+    // Five years of working days, a session every few minutes from 9 to 18.
+    std::mt19937 rng(11);
+    int64_t day0 = DaysFromCivil(2020, 1, 6);
+    BucketPyramid pyr;
+    size_t sessions = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int64_t day = day0; day < day0 + 5 * 365; day++) {
+        if (FloorDiv(day + 3, 7) * 7 - 3 + 5 <= day) continue;    // weekend
+        for (int64_t t = day * 86400 + 9 * 3600; t < day * 86400 + 18 * 3600; ) {
+            uint32_t dur = 30 + rng() % 900;
+            pyr.Add(t, dur);
+            sessions++;
+            t += dur + rng() % 300;
+        }
+    }
+    double buildMs = Ms(t0);
+
+    // The timeline at 1920 columns: a month, then everything.
+    std::vector<double> cols;
+    double from = (double)(day0 + 2 * 365) * 86400, span = 30 * 86400.0;
+    t0 = std::chrono::steady_clock::now();
+    pyr.Columns(from, span, 1920, cols);
+    double monthMs = Ms(t0);
+    double total = 0;
+    for (double c : cols) total += c;
+    t0 = std::chrono::steady_clock::now();
+    pyr.Columns((double)pyr.First(), (double)(pyr.Last() - pyr.First()), 1920, cols);
+    double allMs = Ms(t0);
+    std::printf("  timeline: %zu sessions built in %.1f ms; month view %.2f ms, all %.2f ms (target 20 ms)\n",
+        sessions, buildMs, monthMs, allMs);
+    CHECK(total > 20 * 6 * 3600.0);
+    CHECK(!kTimed || (monthMs < 20 && allMs < 20));
+}
+
+// -----------------------------------------
+// CSV
+// -----------------------------------------
+static std::vector<std::string> Split(std::string_view line, int max = 5) {
+    std::string_view f[8];
+    std::string scratch[8];
+    int n = CsvSplit(line, f, scratch, max);
+    return std::vector<std::string>(f, f + n);
+}
+
+// Records of text read through a buffer of bufSize, in reads of at most
+// step bytes.
+static bool ReadAll(const std::string& text, size_t bufSize, size_t step,
+    std::vector<std::string>& out) {
+    std::vector<char> buf(bufSize);
+    size_t at = 0;
+    return CsvReadRecords(buf,
+        [&](char* p, size_t n) {
+            n = std::min({ n, step, text.size() - at });
+            std::memcpy(p, text.data() + at, n);
+            at += n;
+            return n;
+        },
+        [&](std::string_view line) { out.emplace_back(line); });
+}
+
+TEST(CsvSplitsQuotedFields) {
+    CHECK(Split("2024-05-01 09:00:00,60,Code.exe,,") ==
+        (std::vector<std::string>{ "2024-05-01 09:00:00", "60", "Code.exe", "", "" }));
+    CHECK(Split("a,\"b,c\",\"say \"\"hi\"\"\",d") ==
+        (std::vector<std::string>{ "a", "b,c", "say \"hi\"", "d" }));
+    CHECK(Split("\"\"\"\",x") == (std::vector<std::string>{ "\"", "x" }));
+    CHECK(Split("\"\",\"\"") == (std::vector<std::string>{ "", "" }));
+    CHECK(Split("a,b,c,d,e,f") == (std::vector<std::string>{ "a", "b", "c", "d", "e" }));
+    CHECK(Split("") == std::vector<std::string>{ "" });
+}
+
+TEST(CsvRecordsKeepQuotedNewlines) {
+    // CRLF inside quotes stays in the field; outside it ends the record.
+    std::string text = "start,duration\r\n"
+        "1,2,\"two\r\nlines\",x\r\n"
+        "3,4,\"a \"\"q\"\"\nb\"\n"
+        "5,6,last";
+    std::vector<std::string> recs;
+    CHECK(ReadAll(text, 64 * 1024, text.size(), recs));
+    CHECK(recs.size() == 4);
+    CHECK(recs[0] == "start,duration");
+    CHECK(Split(recs[1]) == (std::vector<std::string>{ "1", "2", "two\r\nlines", "x" }));
+    CHECK(Split(recs[2]) == (std::vector<std::string>{ "3", "4", "a \"q\"\nb" }));
+    CHECK(recs[3] == "5,6,last");
+}
+
+TEST(CsvRecordsSpanBufferRefills) {
+    // Rows of every length up to a few KB, some quoted with newlines, read
+    // through the import's 64 KB buffer in uneven reads, so records
+    // straddle every refill.
+    std::mt19937 rng(9);
+    std::string text;
+    std::vector<std::string> want;
+    for (int i = 0; i < 4000; i++) {
+        std::string name(rng() % 3000, (char)('a' + i % 26));
+        if (i % 7 == 0) name.insert(name.size() / 2, "\r\n,\"\"");
+        std::string row = std::to_string(i) + ",60,\"" + name + "\"";
+        want.push_back(row);
+        text += row + (i % 2 ? "\r\n" : "\n");
+    }
+    CHECK(text.size() > 20 * 64 * 1024);
+    const size_t steps[] = { 1 << 20, 65536, 4093, 777 };
+    for (size_t step : steps) {
+        std::vector<std::string> got;
+        CHECK(ReadAll(text, 64 * 1024, step, got));
+        CHECK(got == want);
+    }
+
+    // A record longer than the buffer stops the read after the ones before.
+    std::string big = "1,2,x\n3,4," + std::string(70 * 1024, 'y') + "\n5,6,z\n";
+    std::vector<std::string> got;
+    CHECK(!ReadAll(big, 64 * 1024, big.size(), got));
+    CHECK(got == std::vector<std::string>{ "1,2,x" });
+}
+
+// -----------------------------------------
+// Process snapshots
+// -----------------------------------------
+struct FakeSnapshot : SnapshotSource {
+    std::vector<ProcEntry> procs;
+    bool                   ok = true;
+    bool Take(std::vector<ProcEntry>& out) override {
+        out.insert(out.end(), procs.begin(), procs.end());
+        return ok;
+    }
+    void Add(uint32_t pid, const wchar_t* exe, uint32_t parent = 1, uint64_t started = 0) {
+        ProcEntry e;
+        e.pid = pid;
+        e.parent = parent;
+        e.started = started;
+        e.exe = exe;
+        procs.push_back(e);
+    }
+    void Remove(uint32_t pid) {
+        procs.erase(std::remove_if(procs.begin(), procs.end(),
+            [&](const ProcEntry& e) { return e.pid == pid; }), procs.end());
+    }
+};
+
+static std::vector<std::wstring> Names(const std::vector<ProcEntry>& v) {
+    std::vector<std::wstring> out;
+    for (auto& e : v) out.push_back(e.exe);
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+TEST(SnapshotAddedAndExited) {
+    FakeSnapshot src;
+    src.Add(10, L"Code.exe");
+    src.Add(11, L"chrome.exe");
+    src.Add(12, L"Code.exe");
+    ProcSnapshotDiff diff;
+    ProcSnapshotDiff::Delta d;
+    CHECK(diff.Poll(src, d));
+    CHECK(Names(d.added) == (std::vector<std::wstring>{ L"Code.exe", L"chrome.exe" }));
+    CHECK(d.exited.empty());
+
+    // One of two instances gone: the name stays.
+    src.Remove(10);
+    d = ProcSnapshotDiff::Delta();
+    CHECK(diff.Poll(src, d));
+    CHECK(d.added.empty() && d.exited.empty());
+    uint32_t pid = 0;
+    CHECK(diff.AnyInstance(L"Code.exe", pid) && pid == 12);
+
+    src.Remove(12);
+    src.Add(13, L"slack.exe");
+    d = ProcSnapshotDiff::Delta();
+    CHECK(diff.Poll(src, d));
+    CHECK(Names(d.added) == std::vector<std::wstring>{ L"slack.exe" });
+    CHECK(d.exited == std::vector<std::wstring>{ L"Code.exe" });
+    CHECK(!diff.Running(L"Code.exe") && diff.Running(L"slack.exe"));
+
+    // A failed snapshot changes nothing.
+    src.ok = false;
+    src.procs.clear();
+    d = ProcSnapshotDiff::Delta();
+    CHECK(!diff.Poll(src, d));
+    CHECK(d.added.empty() && d.exited.empty() && diff.Running(L"slack.exe"));
+}
+
+TEST(SnapshotPidReuse) {
+    // Without start times, a new exe or parent under a known PID is a new
+    // instance.
+    FakeSnapshot src;
+    src.Add(20, L"Teams.exe", 4);
+    src.Add(21, L"explorer.exe", 4);
+    ProcSnapshotDiff diff;
+    ProcSnapshotDiff::Delta d;
+    diff.Poll(src, d);
+    src.procs[0].exe = L"OUTLOOK.EXE";
+    d = ProcSnapshotDiff::Delta();
+    CHECK(diff.Poll(src, d));
+    CHECK(Names(d.added) == std::vector<std::wstring>{ L"OUTLOOK.EXE" });
+    CHECK(d.exited == std::vector<std::wstring>{ L"Teams.exe" });
+
+    // Same name again under a reused PID: nothing to report, but the PID
+    // is a new instance.
+    src.procs[1].parent = 9;
+    d = ProcSnapshotDiff::Delta();
+    CHECK(diff.Poll(src, d));
+    CHECK(d.added.empty() && d.exited.empty() && diff.Live(21));
+
+    // With start times the parent may change (a reparented orphan); a new
+    // start time is a new instance.
+    FakeSnapshot timed;
+    timed.Add(30, L"cmake.exe", 5, 1000);
+    ProcSnapshotDiff t;
+    t.Poll(timed, d);
+    timed.procs[0].parent = 1;
+    d = ProcSnapshotDiff::Delta();
+    CHECK(t.Poll(timed, d));
+    CHECK(d.added.empty() && d.exited.empty());
+    timed.procs[0].started = 2000;
+    timed.procs[0].exe = L"ninja.exe";
+    d = ProcSnapshotDiff::Delta();
+    CHECK(t.Poll(timed, d));
+    CHECK(Names(d.added) == std::vector<std::wstring>{ L"ninja.exe" });
+    CHECK(d.added[0].pid == 30 && d.added[0].started == 2000);
+    CHECK(d.exited == std::vector<std::wstring>{ L"cmake.exe" });
+}
+
+#ifdef __linux__
+TEST(SnapshotProcFs) {
+    // A child exec'ing sleep shows up with our PID as parent, and is gone
+    // once reaped.
+    pid_t child = fork();
+    if (child == 0) {
+        execlp("sleep", "sleep", "30", (char*)nullptr);
+        _exit(127);
+    }
+    CHECK(child > 0);
+    ProcFsSource src;
+    ProcEntry self, kid;
+    CHECK(ProcFsSource::Read((uint32_t)getpid(), self));
+    CHECK(self.parent == (uint32_t)getppid() && self.started > 0);
+    // Until exec, the child's comm is ours.
+    for (int i = 0; i < 200; i++) {
+        if (ProcFsSource::Read((uint32_t)child, kid) && kid.exe == L"sleep") break;
+        usleep(10000);
+    }
+    CHECK(kid.exe == L"sleep" && kid.parent == (uint32_t)getpid());
+
+    ProcSnapshotDiff diff;
+    ProcSnapshotDiff::Delta d;
+    CHECK(diff.Poll(src, d));
+    CHECK(diff.Live((uint32_t)child) && diff.Running(L"sleep"));
+    CHECK(diff.Live((uint32_t)getpid()));
+    kill(child, SIGKILL);
+    waitpid(child, nullptr, 0);
+    d = ProcSnapshotDiff::Delta();
+    CHECK(diff.Poll(src, d));
+    CHECK(!diff.Live((uint32_t)child));
+}
+#endif
+
+// -----------------------------------------
+// Idle gaps
+// -----------------------------------------
+static bool TakeGap(IdleGap& gap, const std::vector<int>& durs, IdleGap::Cut& c) {
+    return gap.Take(durs.size(), [&](size_t i) { return durs[i]; }, c);
+}
+
+TEST(GapFocusChangeThenLong) {
+    // Last input at 1000. Focus moves at 1100 and 1200 with no input, closing
+    // a session begun at 400 and one begun at 1100; at 1300 the gap reaches
+    // the 5 minute threshold.
+    IdleGap gap;
+    gap.Input(1000, 0);
+    gap.Input(1100, 100);
+    gap.Closed(1100, 700);
+    gap.Input(1200, 201);   // jitter: still the same gap
+    gap.Closed(1200, 100);
+    CHECK(gap.Pending() && gap.LastInput() == 1000);
+    gap.Input(1300, 300);
+    IdleGap::Cut c;
+    CHECK(TakeGap(gap, { 50, 700, 100 }, c));
+    CHECK(c.first == 1 && c.firstCut == 100 && c.total == 200 && c.keepFirst);
+    // Spent: the same gap takes nothing twice.
+    CHECK(!gap.Pending() && !TakeGap(gap, { 50, 600 }, c));
+}
+
+TEST(GapInputResumesBeforeLong) {
+    IdleGap gap;
+    gap.Input(1000, 0);
+    gap.Closed(1100, 700);
+    CHECK(gap.Pending());
+    gap.Input(1150, 0);     // back before the threshold: nothing to take
+    CHECK(!gap.Pending());
+    IdleGap::Cut c;
+    CHECK(!TakeGap(gap, { 700 }, c));
+}
+
+TEST(GapDropsSessionsWhollyInside) {
+    // The first session closed in the gap began inside it too.
+    IdleGap gap;
+    gap.Input(1000, 0);
+    gap.Closed(1050, 30);
+    gap.Closed(1080, 30);
+    IdleGap::Cut c;
+    CHECK(TakeGap(gap, { 30, 30 }, c));
+    CHECK(c.first == 0 && c.firstCut == 30 && c.total == 60 && !c.keepFirst);
+}
+
+TEST(GapSkipsUntrackedAndArchived) {
+    IdleGap gap;
+    gap.Closed(500, 60);    // no input seen yet
+    CHECK(!gap.Pending());
+    gap.Input(1000, 0);
+    gap.Closed(1000, 60);   // closed at the last input: nothing inside the gap
+    CHECK(!gap.Pending());
+    gap.Closed(1100, 200);
+    gap.Closed(1200, 100);
+    IdleGap::Cut c;
+    // Only the second is still in reach, and it lies wholly in the gap.
+    CHECK(TakeGap(gap, { 150 }, c));
+    CHECK(c.first == 0 && c.firstCut == 150 && c.total == 150 && !c.keepFirst);
+    gap.Closed(1300, 10);
+    gap.Forget();
+    CHECK(!gap.Pending());
+}
+
+// -----------------------------------------
+// Session edits
+// -----------------------------------------
+// Tracker::EditSession over plain storage: hot rows kept to the minute as
+// the ini keeps them, the archive as a journal folded on read.
+struct EditStore {
+    static constexpr int64_t kMonth = 1719792000;   // 2024-07-01, "this month"
+    std::vector<HistRecord> hot;
+    std::string journal;
+
+    static HistRecord ToMinute(HistRecord r) {
+        r.start = r.End() / 60 * 60 - r.dur;
+        return r;
+    }
+
+    bool Edit(const HistRecord* old, const HistRecord* repl, HistRecord* stored) {
+        SessionEditPlan p = PlanSessionEdit(hot.size(), [&](size_t i) { return hot[i]; },
+            old, repl, repl && repl->End() >= kMonth);
+        if (p.archiveOld) HistJournal::Put(journal, *p.archiveOld, true);
+        if (p.archiveNew) HistJournal::Put(journal, *p.archiveNew, false);
+        if (p.hotOld >= 0) hot.erase(hot.begin() + p.hotOld);
+        HistRecord saved = repl ? (p.hotNew ? ToMinute(*repl) : *repl) : HistRecord();
+        if (p.hotNew) {
+            auto at = std::upper_bound(hot.begin(), hot.end(), saved,
+                [](const HistRecord& a, const HistRecord& b) { return a.End() < b.End(); });
+            hot.insert(at, saved);
+        }
+        if (repl && stored) *stored = saved;
+        return true;
+    }
+
+    std::multiset<HistRecord> Archive() const {
+        std::multiset<HistRecord> out;
+        CHECK(HistJournal::Parse(journal, [&](const HistRecord& r, bool tomb) {
+            if (!tomb) { out.insert(r); return; }
+            auto it = out.find(r);
+            CHECK(it != out.end());
+            if (it != out.end()) out.erase(it);
+            }) == 0);
+        return out;
+    }
+};
+
+TEST(EditHotAndColdWithUndo) {
+    EditStore st;
+    HistRecord cold1 = { EditStore::kMonth - 86400 * 20, 1800, L"Code.exe", L"", L"" };
+    HistRecord cold2 = { EditStore::kMonth - 86400 * 3, 600, L"chrome.exe", L"", L"Jira" };
+    for (auto* r : { &cold1, &cold2 }) HistJournal::Put(st.journal, *r, false);
+    for (int i = 0; i < 3; i++)
+        st.hot.push_back(EditStore::ToMinute({ EditStore::kMonth + 3600 * (i + 1), 900, L"devenv.exe", L"", L"" }));
+    const std::vector<HistRecord> hot0 = st.hot;
+    const std::multiset<HistRecord> arc0 = st.Archive();
+
+    struct Undo { bool hadOld, hadNew; HistRecord old, now; };
+    std::vector<Undo> undo;
+    auto apply = [&](const HistRecord* old, const HistRecord* repl) {
+        HistRecord stored;
+        CHECK(st.Edit(old, repl, &stored));
+        undo.push_back({ old != nullptr, repl != nullptr,
+            old ? *old : HistRecord(), repl ? stored : HistRecord() });
+    };
+
+    // Hot to hot, with seconds the ini drops: no journal record.
+    size_t journaled = st.journal.size();
+    HistRecord h = st.hot[1], h2 = h;
+    h2.dur += 37;
+    h2.start += 5;
+    apply(&h, &h2);
+    CHECK(st.journal.size() == journaled);
+    CHECK(st.hot.size() == 3 && !(undo.back().now == h2) && undo.back().now == EditStore::ToMinute(h2));
+
+    // Hot to cold, cold to hot, cold to cold.
+    HistRecord h0 = st.hot[0], moved = h0;
+    moved.start = EditStore::kMonth - 86400;
+    apply(&h0, &moved);
+    CHECK(st.hot.size() == 2 && st.Archive().count(moved) == 1);
+    HistRecord back = cold2;
+    back.start = EditStore::kMonth + 86400 * 2;
+    apply(&cold2, &back);
+    CHECK(st.hot.size() == 3 && st.Archive().count(cold2) == 0);
+    HistRecord recat = cold1;
+    recat.category = L"Meetings";
+    apply(&cold1, &recat);
+    CHECK(st.Archive().count(recat) == 1 && st.Archive().count(cold1) == 0);
+
+    // Deletes and an add on either side.
+    HistRecord gone = st.hot.back();
+    apply(&gone, nullptr);
+    apply(&recat, nullptr);
+    HistRecord added = { EditStore::kMonth + 86400 * 5 + 17, 120, L"Code.exe", L"", L"" };
+    apply(nullptr, &added);
+    CHECK(st.hot.size() == 3 && st.Archive().size() == 1);
+
+    // Undo everything, newest first, each with the record as stored.
+    while (!undo.empty()) {
+        Undo u = undo.back();
+        undo.pop_back();
+        CHECK(st.Edit(u.hadNew ? &u.now : nullptr, u.hadOld ? &u.old : nullptr, nullptr));
+    }
+    CHECK(st.hot == hot0);
+    CHECK(st.Archive() == arc0);
+}
+
+TEST(EditPlanMissesUnroundedHotRow) {
+    // Undoing a hot edit with the record as typed rather than as stored
+    // would look for it in the archive; the plan shows where it goes.
+    HistRecord row = EditStore::ToMinute({ EditStore::kMonth + 3600, 900, L"Code.exe", L"", L"" });
+    HistRecord typed = row;
+    typed.start += 5;
+    std::vector<HistRecord> rows = { row };
+    auto at = [&](size_t i) { return rows[i]; };
+    SessionEditPlan p = PlanSessionEdit(rows.size(), at, &typed, nullptr, false);
+    CHECK(p.hotOld == -1 && p.archiveOld == &typed);
+    p = PlanSessionEdit(rows.size(), at, &row, &typed, true);
+    CHECK(p.hotOld == 0 && p.hotNew && !p.archiveOld && !p.archiveNew);
+}
+
+// -----------------------------------------
+// Timeline pyramid
+// -----------------------------------------
+struct Span { int64_t start; uint32_t dur; };
+
+// Per bucket of lvl, the seconds of spans that overlap it, by rescanning.
+static std::map<int64_t, uint32_t> RescanLevel(const std::vector<Span>& spans, int lvl) {
+    const int64_t lo = DaysFromCivil(2000, 1, 1) * 86400, hi = DaysFromCivil(2100, 1, 1) * 86400;
+    std::map<int64_t, uint32_t> out;
+    for (const Span& sp : spans) {
+        if (!sp.dur || sp.start < lo || sp.start >= hi) continue;
+        int64_t end = sp.start + sp.dur;
+        for (int64_t b = BucketPyramid::Bucket(lvl, sp.start); BucketPyramid::BucketStart(lvl, b) < end; b++) {
+            int64_t s = BucketPyramid::BucketStart(lvl, b);
+            out[s] += (uint32_t)(std::min(end, s + BucketPyramid::Width(lvl)) - std::max(sp.start, s));
+        }
+    }
+    return out;
+}
+
+static std::map<int64_t, uint32_t> ReadLevel(const BucketPyramid& pyr, int lvl, int64_t from, int64_t to) {
+    std::map<int64_t, uint32_t> out;
+    pyr.ForEach(lvl, from, to, [&](int64_t start, uint32_t secs) { out[start] += secs; });
+    return out;
+}
+
+TEST(PyramidMatchesRescan) {
+    std::mt19937 rng(5);
+    const int64_t base = DaysFromCivil(2024, 2, 26) * 86400;     // spans a leap day
+    const int64_t from = base - 8 * 86400, to = base + 60 * 86400;
+    BucketPyramid pyr;
+    std::vector<Span> live;
+    for (int round = 0; round < 6; round++) {
+        for (int op = 0; op < 1500; op++) {
+            if (!live.empty() && rng() % 3 == 0) {
+                size_t i = rng() % live.size();
+                pyr.Remove(live[i].start, live[i].dur);
+                live.erase(live.begin() + i);
+                continue;
+            }
+            Span sp;
+            sp.start = base + (int64_t)(rng() % (40 * 86400));
+            switch (rng() % 8) {
+            case 0: sp.dur = 0; break;
+            case 1: sp.dur = 86400 + rng() % (2 * 86400); break;           // over midnights
+            case 2: sp.start = DaysFromCivil(1990, 1, 1) * 86400; sp.dur = 600; break; // dropped
+            default: sp.dur = 1 + rng() % 5400; break;
+            }
+            pyr.Add(sp.start, sp.dur);
+            live.push_back(sp);
+        }
+        for (int lvl = 0; lvl < BucketPyramid::kLevels; lvl++)
+            CHECK(ReadLevel(pyr, lvl, from, to) == RescanLevel(live, lvl));
+        std::map<int64_t, uint32_t> minutes = RescanLevel(live, BucketPyramid::kMinute);
+        CHECK(!minutes.empty() && pyr.First() == minutes.begin()->first &&
+            pyr.Last() == minutes.rbegin()->first + 60);
+    }
+    // A window inside the range reads only its own buckets.
+    int64_t w0 = base + 5 * 86400 + 1234, w1 = w0 + 3 * 86400;
+    for (int lvl = 0; lvl < BucketPyramid::kLevels; lvl++) {
+        std::map<int64_t, uint32_t> want;
+        for (auto& kv : RescanLevel(live, lvl))
+            if (kv.first < w1 && kv.first + BucketPyramid::Width(lvl) > w0) want.insert(kv);
+        CHECK(ReadLevel(pyr, lvl, w0, w1) == want);
+    }
+    for (const Span& sp : live) pyr.Remove(sp.start, sp.dur);
+    CHECK(pyr.Empty());
+    for (int lvl = 0; lvl < BucketPyramid::kLevels; lvl++)
+        CHECK(ReadLevel(pyr, lvl, from, to).empty());
+}
+
+TEST(PyramidColumnsKeepTotals) {
+    // Columns hold every second of a bucket-aligned view, whichever level
+    // the zoom picks.
+    std::mt19937 rng(9);
+    const int64_t base = DaysFromCivil(2023, 10, 2) * 86400;
+    BucketPyramid pyr;
+    std::vector<Span> spans;
+    for (int i = 0; i < 3000; i++) {
+        Span sp = { base + (int64_t)(rng() % (200 * 86400)), 1 + (uint32_t)(rng() % 7200) };
+        pyr.Add(sp.start, sp.dur);
+        spans.push_back(sp);
+    }
+    std::vector<double> cols;
+    for (int64_t span : { (int64_t)3600, (int64_t)86400, 30 * (int64_t)86400, 182 * (int64_t)86400 }) {
+        int64_t from = base + 14 * 86400;
+        double want = 0;
+        for (const Span& sp : spans)
+            want += (double)std::max<int64_t>(0,
+                std::min(sp.start + sp.dur, from + span) - std::max(sp.start, from));
+        pyr.Columns((double)from, (double)span, 1000, cols);
+        double got = 0;
+        for (double c : cols) got += c;
+        int lvl = BucketPyramid::LevelFor((double)span / 1000);
+        // Buckets of lvl straddling the view's end spill past it.
+        CHECK(cols.size() == 1000 && std::abs(got - want) <= (double)BucketPyramid::Width(lvl) * 2);
+    }
+}
+
+// -----------------------------------------
+// Steady state
+// -----------------------------------------
+// Every allocation in this program (alloc_count.cpp), counted as
+// WT_ALLOC_CHECK builds of the app count the tick and sample paths.
+extern uint64_t g_allocs;
+
+TEST(ClockText) {
+    char b[16];
+    CHECK(FormatClock(0, b) == 8 && std::strcmp(b, "00:00:00") == 0);
+    CHECK(FormatClock(45296, b) == 8 && std::strcmp(b, "12:34:56") == 0);
+    CHECK(FormatClock(359999, b) == 8 && std::strcmp(b, "99:59:59") == 0);
+    CHECK(FormatClock(360000, b) == 9 && std::strcmp(b, "100:00:00") == 0);
+}
+
+TEST(SteadyStateDoesNotAllocate) {
+    // The core's share of a tick and a sample, a second at a time for a
+    // week once warm: the clock text, the alert wheel with timers re-armed
+    // as they fire, a rule lookup that reads the title, and the idle-gap
+    // bookkeeping through gaps that turn long.
+    RuleTable rules;
+    CHECK(rules.Compile({ L"chrome.exe title~jira -> Jira", L"* days=sat,sun -> ignore",
+        L"Code.exe -> Coding" }, nullptr));
+    FakeTitle title(L"proj-12 - jira - google chrome");
+    TimerWheel wheel;
+    wheel.Reset(0);
+    wheel.Reserve(8);
+    for (uint32_t id = 0; id < 8; id++) wheel.Add(id, 3600 * (id + 1));
+    std::vector<uint32_t> fired;
+    fired.reserve(8);
+    IdleGap gap;
+    const int durs[] = { 600, 120 };
+    char clock[16];
+    int hits = 0, cuts = 0;
+    auto step = [&](int64_t sec) {
+        FormatClock((int)sec, clock);
+        fired.clear();
+        wheel.Advance(sec, fired);
+        for (uint32_t id : fired) wheel.Add(id, sec + 3600 * (id + 1));
+        RuleSample rs = { sec % 2 ? L"chrome.exe" : L"code.exe", (int)(sec / 86400 % 7),
+            (int)(sec % 86400 / 60), &title };
+        hits += rules.Eval(rs) >= 0;
+        int64_t t = sec % 900;
+        gap.Input(sec, t < 400 ? 0 : (int)(t - 400));
+        if (t == 500) gap.Closed(sec, 300);
+        IdleGap::Cut cut;
+        if (t == 800 && gap.Pending()) cuts += gap.Take(2, [&](size_t i) { return durs[i]; }, cut);
+    };
+    for (int64_t sec = 1; sec <= 900; sec++) step(sec);
+    uint64_t a0 = g_allocs;
+    for (int64_t sec = 901; sec <= 7 * 86400; sec++) step(sec);
+    CHECK(g_allocs == a0);
+    CHECK(hits > 0 && cuts > 600 && title.reads > 0);
+}
+
+int main() {
+    for (auto& t : Registry()) {
+        int before = g_failures;
+        t.fn();
+        std::printf("%-32s %s\n", t.name, g_failures == before ? "ok" : "FAILED");
+    }
+    std::printf("%d failure(s)\n", g_failures);
+    return g_failures ? 1 : 0;
+}